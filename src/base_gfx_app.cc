@@ -17,6 +17,12 @@
 #include <assert.h>
 #include <iostream>
 #include <string>
+#if defined(__has_include)
+#if __has_include(<GL/freeglut_ext.h>)
+#include <GL/freeglut_ext.h>
+#endif
+#endif
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
@@ -70,6 +76,11 @@ void BaseGfxApp::Init(int argc,
   }
 
   glut_window_handle_ = glutCreateWindow("Graphics Window");
+#ifdef GLUT_ACTION_ON_WINDOW_CLOSE
+  // Return from RunMainLoop() when the window is closed rather than exiting
+  // inside freeglut, so that main() can tear the app down.
+  glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
+#endif
 
   glutReshapeFunc(s_reshape);
   glutKeyboardFunc(s_keyboard);
@@ -111,6 +122,7 @@ void BaseGfxApp::Reshape(int width, int height) {
 }
 
 void BaseGfxApp::RenderOneFrame(void) {
+  TRACE_SCOPE("BaseGfxApp::RenderOneFrame", "render");
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   Display();
   glutSwapBuffers();
@@ -118,6 +130,7 @@ void BaseGfxApp::RenderOneFrame(void) {
 
 void BaseGfxApp::DrawPixels(int start_x, int start_y, int width,
                             int height, void const * const pixels) {
+  TRACE_SCOPE("glDrawPixels", "render");
   glRasterPos2i(start_x, start_y);
   glDrawPixels(width, height, GL_RGBA, GL_FLOAT, pixels);
 
@@ -129,6 +142,34 @@ void BaseGfxApp::DrawPixels(int start_x, int start_y, int width,
   }
 }
 
+void BaseGfxApp::DrawPixelRegion(double window_x, double window_y,
+                                 double zoom, int row_length, int skip_x,
+                                 int skip_rows, int width, int height,
+                                 void const * const pixels) {
+  TRACE_SCOPE("glDrawPixels", "render");
+  // The raster position must be inside the window or nothing is drawn, so
+  // start at the origin and move it with an empty bitmap instead.
+  glRasterPos2i(0, 0);
+  glBitmap(0, 0, 0, 0, static_cast<GLfloat>(window_x),
+           static_cast<GLfloat>(window_y), nullptr);
+  glPixelZoom(static_cast<GLfloat>(zoom), static_cast<GLfloat>(zoom));
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, skip_x);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, skip_rows);
+  glDrawPixels(width, height, GL_RGBA, GL_FLOAT, pixels);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+  glPixelZoom(1.0f, 1.0f);
+
+  unsigned err = glGetError();
+  if (err != GL_NO_ERROR) {
+    std::cerr << "GL is in an error state after call to glDrawPixels()\n";
+    std::cerr << "(GL error code " << err << ")\n";
+    assert(0);
+  }
+}
+
 void BaseGfxApp::s_reshape(int width, int height) {
   s_current_app_->Reshape(width, height);
 }
@@ -198,6 +239,21 @@ void BaseGfxApp::s_idle(void) {
   }
 }
 
+void BaseGfxApp::s_timer(int value) {
+  // Timer callbacks are not tied to a window; make sure anything Update()
+  // does to the window (e.g. resizing it) targets the graphics window.
+  glutSetWindow(s_current_app_->glut_window_handle_);
+
+  int time_since_start = glutGet(GLUT_ELAPSED_TIME);
+  int delta = time_since_start - s_current_app_->milliseconds_;
+  s_current_app_->milliseconds_ = time_since_start;
+  s_current_app_->Update(delta > 0 ? delta : 0);
+}
+
+void BaseGfxApp::ScheduleUpdate(int delay_ms) {
+  glutTimerFunc(delay_ms, s_timer, 0);
+}
+
 void BaseGfxApp::SetWindowDimensions(int width, int height) {
   height_ = height;
   width_ = width;
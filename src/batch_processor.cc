@@ -0,0 +1,564 @@
+/*******************************************************************************
+ * Name            : batch_processor.cc
+ * Project         : FlashPhoto
+ * Module          : batch_processor
+ * Description     : Implementation of the BatchProcessor class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/batch_processor.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "include/bilateral_grid.h"
+#include "include/image_codec.h"
+#include "include/filter_kernel.h"
+#include "include/image_filters.h"
+#include "include/pixel_pool.h"
+#include "include/rank_filter.h"
+#include "include/recursive_gaussian.h"
+#include "include/task_scheduler.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static bool ParseFloat(const std::string& text, float* value) {
+  char* end = nullptr;
+  *value = std::strtof(text.c_str(), &end);
+  return !text.empty() && *end == '\0';
+}
+
+static bool ParseInt(const std::string& text, int* value) {
+  char* end = nullptr;
+  *value = static_cast<int>(std::strtol(text.c_str(), &end, 10));
+  return !text.empty() && *end == '\0';
+}
+
+static std::vector<std::string> Split(const std::string& text, char delimiter) {
+  std::vector<std::string> fields;
+  std::stringstream stream(text);
+  std::string field;
+  while (std::getline(stream, field, delimiter)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+bool FilterOperation::Parse(const std::string& spec,
+                            FilterOperation* operation) {
+  std::vector<std::string> fields = Split(spec, ':');
+  if (fields.empty()) {
+    return false;
+  }
+  const std::string& name = fields[0];
+  size_t params = fields.size() - 1;
+
+  if (name == "blur" || name == "gaussian" || name == "sharpen" ||
+      name == "threshold" || name == "saturate") {
+    if (params != 1 || !ParseFloat(fields[1], &operation->amount)) {
+      return false;
+    }
+    if (name == "blur") {
+      operation->type = BLUR;
+    } else if (name == "gaussian") {
+      operation->type = GAUSSIAN_BLUR;
+    } else if (name == "sharpen") {
+      operation->type = SHARPEN;
+    } else if (name == "threshold") {
+      operation->type = THRESHOLD;
+    } else {
+      operation->type = SATURATE;
+    }
+    return true;
+  } else if (name == "motionblur") {
+    if (params < 1 || params > 2 ||
+        !ParseFloat(fields[1], &operation->amount)) {
+      return false;
+    }
+    operation->type = MOTION_BLUR;
+    operation->direction = ImageFilters::MOTION_BLUR_E_W;
+    if (params == 2) {
+      if (fields[2] == "ns") {
+        operation->direction = ImageFilters::MOTION_BLUR_N_S;
+      } else if (fields[2] == "ew") {
+        operation->direction = ImageFilters::MOTION_BLUR_E_W;
+      } else if (fields[2] == "nesw") {
+        operation->direction = ImageFilters::MOTION_BLUR_NE_SW;
+      } else if (fields[2] == "nwse") {
+        operation->direction = ImageFilters::MOTION_BLUR_NW_SE;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  } else if (name == "channel") {
+    std::vector<std::string> colors;
+    if (params == 1) {
+      colors = Split(fields[1], ',');
+    }
+    operation->type = CHANNEL;
+    return (colors.size() == 3 && ParseFloat(colors[0], &operation->red) &&
+            ParseFloat(colors[1], &operation->green) &&
+            ParseFloat(colors[2], &operation->blue));
+  } else if (name == "quantize") {
+    operation->type = QUANTIZE;
+    return (params == 1 && ParseInt(fields[1], &operation->bins) &&
+            operation->bins >= 2);
+  } else if (name == "dither") {
+    if (params < 1 || params > 2 || !ParseInt(fields[1], &operation->bins) ||
+        operation->bins < 2) {
+      return false;
+    }
+    operation->type = DITHER;
+    operation->dither = ImageFilters::DITHER_FLOYD_STEINBERG;
+    if (params == 2) {
+      if (fields[2] == "bayer") {
+        operation->dither = ImageFilters::DITHER_BAYER;
+      } else if (fields[2] == "bluenoise") {
+        operation->dither = ImageFilters::DITHER_BLUE_NOISE;
+      } else if (fields[2] == "floyd") {
+        operation->dither = ImageFilters::DITHER_FLOYD_STEINBERG;
+      } else if (fields[2] == "atkinson") {
+        operation->dither = ImageFilters::DITHER_ATKINSON;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  } else if (name == "median") {
+    if (params < 1 || params > 2 ||
+        !ParseFloat(fields[1], &operation->amount) || operation->amount < 0) {
+      return false;
+    }
+    operation->type = MEDIAN;
+    operation->percentile = 0.5;
+    return (params == 1 || (ParseFloat(fields[2], &operation->percentile) &&
+                            operation->percentile >= 0 &&
+                            operation->percentile <= 1));
+  } else if (name == "erode" || name == "dilate" || name == "open" ||
+             name == "close") {
+    std::vector<std::string> radii;
+    if (params == 1 || params == 2) {
+      radii = Split(fields[1], ',');
+    }
+    if (radii.empty() || radii.size() > 2 ||
+        !ParseInt(radii[0], &operation->radius_x) ||
+        operation->radius_x < 0) {
+      return false;
+    }
+    operation->radius_y = operation->radius_x;
+    if (radii.size() == 2 && (!ParseInt(radii[1], &operation->radius_y) ||
+                              operation->radius_y < 0)) {
+      return false;
+    }
+    operation->type = MORPHOLOGY;
+    if (name == "erode") {
+      operation->morphology = ImageFilters::MORPHOLOGY_ERODE;
+    } else if (name == "dilate") {
+      operation->morphology = ImageFilters::MORPHOLOGY_DILATE;
+    } else if (name == "open") {
+      operation->morphology = ImageFilters::MORPHOLOGY_OPEN;
+    } else {
+      operation->morphology = ImageFilters::MORPHOLOGY_CLOSE;
+    }
+    operation->grayscale = (params == 2);
+    return (params == 1 || fields[2] == "gray");
+  } else if (name == "unsharp") {
+    if (params < 1 || params > 3 ||
+        !ParseFloat(fields[1], &operation->amount) || operation->amount < 0) {
+      return false;
+    }
+    operation->type = UNSHARP_MASK;
+    operation->unsharp_amount = 1.0;
+    operation->unsharp_threshold = 0.0;
+    return ((params < 2 || ParseFloat(fields[2], &operation->unsharp_amount)) &&
+            (params < 3 ||
+             ParseFloat(fields[3], &operation->unsharp_threshold)));
+  } else if (name == "bilateral") {
+    if (params < 1 || params > 2 ||
+        !ParseFloat(fields[1], &operation->amount) || operation->amount < 0) {
+      return false;
+    }
+    operation->type = BILATERAL;
+    operation->range_sigma = 0.1;
+    return (params == 1 || (ParseFloat(fields[2], &operation->range_sigma) &&
+                            operation->range_sigma > 0));
+  } else if (name == "edgedetect" || name == "special") {
+    operation->type = (name == "special") ? SPECIAL : EDGE_DETECT;
+    return params == 0;
+  }
+  return false;
+}
+
+void FilterOperation::Apply(PixelBuffer* image) const {
+  Apply(image, 0, 0);
+}
+
+void FilterOperation::Apply(PixelBuffer* image, int x, int y) const {
+  switch (type) {
+    case BLUR:
+      ImageFilters::Blur(image, amount);
+      break;
+    case GAUSSIAN_BLUR:
+      ImageFilters::GaussianBlur(image, amount);
+      break;
+    case SHARPEN:
+      ImageFilters::Sharpen(image, amount);
+      break;
+    case UNSHARP_MASK:
+      ImageFilters::UnsharpMask(image, amount, unsharp_amount,
+                                unsharp_threshold);
+      break;
+    case MOTION_BLUR:
+      ImageFilters::MotionBlur(image, amount, direction);
+      break;
+    case EDGE_DETECT:
+      ImageFilters::EdgeDetect(image);
+      break;
+    case THRESHOLD:
+      ImageFilters::Threshold(image, amount);
+      break;
+    case SATURATE:
+      ImageFilters::Saturate(image, amount);
+      break;
+    case CHANNEL:
+      ImageFilters::Channel(image, red, green, blue);
+      break;
+    case QUANTIZE:
+      ImageFilters::Quantize(image, bins);
+      break;
+    case DITHER:
+      ImageFilters::Dither(image, bins, dither);
+      break;
+    case MEDIAN:
+      ImageFilters::Median(image, static_cast<int>(amount), percentile);
+      break;
+    case MORPHOLOGY:
+      ImageFilters::Morphology(image, morphology, radius_x, radius_y,
+                               grayscale);
+      break;
+    case BILATERAL:
+      ImageFilters::Bilateral(image, amount, range_sigma, x, y);
+      break;
+    case SPECIAL:
+    default:
+      ImageFilters::Special(image);
+      break;
+  }
+}
+
+int FilterOperation::halo(void) const {
+  switch (type) {
+    case BLUR:
+    case SHARPEN:
+    case MOTION_BLUR:
+      return FilterKernel::KernelSize(amount) / 2;
+    case GAUSSIAN_BLUR:
+    case UNSHARP_MASK:
+      return RecursiveGaussian::halo(amount);
+    case MEDIAN:
+      return std::min(RankFilter::kMaxRadius, static_cast<int>(amount));
+    case MORPHOLOGY:
+      // Opening and closing reach twice as far
+      return std::max(radius_x, radius_y) *
+             ((morphology == ImageFilters::MORPHOLOGY_OPEN ||
+               morphology == ImageFilters::MORPHOLOGY_CLOSE) ? 2 : 1);
+    case BILATERAL:
+      return BilateralGrid::halo(amount);
+    case EDGE_DETECT:
+    case SPECIAL:
+      // Both use a 3x3 kernel
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+FilterOperation FilterOperation::Scaled(int scale) const {
+  FilterOperation scaled = *this;
+  switch (type) {
+    case BLUR:
+    case GAUSSIAN_BLUR:
+    case SHARPEN:
+    case UNSHARP_MASK:
+    case MOTION_BLUR:
+    case MEDIAN:
+    case BILATERAL:
+      scaled.amount = amount / scale;
+      break;
+    case MORPHOLOGY:
+      scaled.radius_x = radius_x / scale;
+      scaled.radius_y = radius_y / scale;
+      break;
+    default:
+      break;
+  }
+  return scaled;
+}
+
+bool FilterOperation::ApplyTiled(TiledImage* image) const {
+  TRACE_SCOPE("FilterOperation::ApplyTiled", "filter");
+  const int tile_size = TiledImage::kTileSize;
+  int width = image->width();
+  int height = image->height();
+  int border = halo();
+
+  // Error diffusion reaches every pixel after it, so dithering goes a
+  // full-width band at a time, carrying the errors down
+  if (type == DITHER) {
+    std::vector<float> carried_errors;
+    for (int tile_y = 0; tile_y < image->tiles_y(); tile_y++) {
+      int y = tile_y * tile_size;
+      int band_height = std::min(tile_size, height - y);
+      PixelBuffer band(width, band_height, image->background_color());
+      image->ReadRegion(0, y, &band);
+      ImageFilters::DitherBand(&band, bins, dither, &carried_errors);
+      image->WriteRegion(0, y, band, 0, 0, width, band_height);
+      image->ReleaseTileRows(tile_y, tile_y + 1);
+    }
+    return true;
+  }
+
+  // Per-pixel filters can write each tile back in place
+  TiledImage* output = image;
+  if (border > 0) {
+    output = TiledImage::Create(width, height, image->background_color(),
+                                false, image->directory());
+    if (!output) {
+      return false;
+    }
+  }
+
+  for (int tile_y = 0; tile_y < image->tiles_y(); tile_y++) {
+    int y = tile_y * tile_size;
+    int tile_height = std::min(tile_size, height - y);
+    int region_y = std::max(0, y - border);
+    int region_height = std::min(height, y + tile_height + border) - region_y;
+    for (int tile_x = 0; tile_x < image->tiles_x(); tile_x++) {
+      int x = tile_x * tile_size;
+      int tile_width = std::min(tile_size, width - x);
+      int region_x = std::max(0, x - border);
+      int region_width = std::min(width, x + tile_width + border) - region_x;
+
+      // Scratch regions come from the pixel pool, so this does not allocate
+      PixelBuffer region(region_width, region_height,
+                         image->background_color());
+      image->ReadRegion(region_x, region_y, &region);
+      Apply(&region, region_x, region_y);
+      output->WriteRegion(x, y, region, x - region_x, y - region_y,
+                          tile_width, tile_height);
+    }
+
+    // Keep only the rows of tiles the next row's borders reach into
+    output->ReleaseTileRows(tile_y, tile_y + 1);
+    if (output != image) {
+      image->ReleaseTileRows(0, (y + tile_size - border) / tile_size);
+    }
+  }
+
+  if (output != image) {
+    image->Swap(output);
+    delete output;
+  }
+  return true;
+}
+
+BatchProcessor::BatchProcessor(const std::vector<FilterOperation>& operations)
+    : operations_(operations),
+      max_threads_(std::max(1u, std::thread::hardware_concurrency())),
+      encode_profile_(ENCODE_PROFILE_BALANCED),
+      jpeg_quality_(75),
+      out_of_core_pixels_(kDefaultOutOfCorePixels),
+      tile_directory_() {}
+
+bool BatchProcessor::ProcessImage(const std::string& input,
+                                  const std::string& output,
+                                  BatchTiming* timing) const {
+  TRACE_SCOPE("BatchProcessor::ProcessImage", "batch");
+  timing->input = input;
+  timing->output = output;
+  timing->succeeded = false;
+
+  int width, height;
+  if (ImageCodec::ReadDimensions(input, &width, &height) &&
+      static_cast<int64_t>(width) * height > out_of_core_pixels_) {
+    return ProcessImageOutOfCore(input, output, timing);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  PixelBuffer* image = ImageCodec::Load(input, true, nullptr);
+  timing->load_ms = MillisecondsSince(start);
+  if (!image) {
+    return false;
+  }
+
+  start = std::chrono::steady_clock::now();
+  for (const FilterOperation& operation : operations_) {
+    operation.Apply(image);
+  }
+  timing->filter_ms = MillisecondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  timing->succeeded = ImageCodec::Save(
+    *image, output, PngEncodeSettings::ForProfile(encode_profile_),
+    JpegEncodeSettings::ForProfile(encode_profile_, jpeg_quality_), nullptr);
+  timing->save_ms = MillisecondsSince(start);
+
+  delete image;
+  return timing->succeeded;
+}
+
+bool BatchProcessor::ProcessImageOutOfCore(const std::string& input,
+                                           const std::string& output,
+                                           BatchTiming* timing) const {
+  auto start = std::chrono::steady_clock::now();
+  TiledImage* image = ImageCodec::LoadTiled(input, true, tile_directory_,
+                                            nullptr);
+  timing->load_ms = MillisecondsSince(start);
+  if (!image) {
+    return false;
+  }
+
+  start = std::chrono::steady_clock::now();
+  bool filtered = true;
+  for (const FilterOperation& operation : operations_) {
+    if (!operation.ApplyTiled(image)) {
+      filtered = false;
+      break;
+    }
+  }
+  timing->filter_ms = MillisecondsSince(start);
+
+  if (filtered) {
+    start = std::chrono::steady_clock::now();
+    timing->succeeded = ImageCodec::SaveTiled(
+      image, output, PngEncodeSettings::ForProfile(encode_profile_),
+      JpegEncodeSettings::ForProfile(encode_profile_, jpeg_quality_), nullptr);
+    timing->save_ms = MillisecondsSince(start);
+  }
+
+  delete image;
+  return timing->succeeded;
+}
+
+bool BatchProcessor::ProcessDirectory(const std::string& input_dir,
+                                      const std::string& output_dir,
+                                      const std::string& output_suffix) const {
+  DIR* dir = opendir(input_dir.c_str());
+  if (!dir) {
+    std::cerr << "ERROR: Could not open directory " << input_dir << std::endl;
+    return false;
+  }
+  std::vector<std::string> names;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (ImageCodec::is_valid_image_file_name(name)) {
+      names.push_back(name);
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  // With a format change, e.g. a.jpg and a.png would both become a.png; keep
+  // the original extension in the name of any later one (a_jpg.png).
+  std::vector<std::string> output_names;
+  for (const std::string& name : names) {
+    std::string output_name = name;
+    if (!output_suffix.empty()) {
+      size_t dot = name.rfind('.');
+      output_name = name.substr(0, dot) + output_suffix;
+      if (std::find(output_names.begin(), output_names.end(), output_name) !=
+          output_names.end()) {
+        output_name = name.substr(0, dot) + "_" + name.substr(dot + 1) +
+                      output_suffix;
+      }
+    }
+    output_names.push_back(output_name);
+  }
+
+  mkdir(output_dir.c_str(), 0755);
+
+  int worker_count = std::max(1, std::min(max_threads_,
+                                          static_cast<int>(names.size())));
+  std::atomic<size_t> next_image(0);
+  std::atomic<int> failures(0);
+  std::mutex print_mutex;
+
+  // The filters and codecs of the images being processed at once share the
+  // scheduler's workers, stealing each other's rows and strips when idle.
+  auto worker = [&]() {
+    for (size_t i = next_image++; i < names.size(); i = next_image++) {
+      BatchTiming timing;
+      if (!ProcessImage(input_dir + "/" + names[i],
+                        output_dir + "/" + output_names[i], &timing)) {
+        failures++;
+      }
+      // The next image is likely another size; keep no slabs for this one
+      PixelPool::Trim();
+      std::lock_guard<std::mutex> lock(print_mutex);
+      PrintTiming(timing);
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  TaskGroup workers;
+  for (int i = 0; i < worker_count; i++) {
+    workers.Run(worker, TASK_PRIORITY_BACKGROUND);
+  }
+  workers.Wait();
+  double elapsed_ms = MillisecondsSince(start);
+
+  std::cout << "Processed " << names.size() - failures << "/" << names.size()
+            << " images with " << worker_count << " threads in "
+            << elapsed_ms << " ms";
+  if (elapsed_ms > 0.0) {
+    std::cout << " (" << names.size() * 1000. / elapsed_ms << " images/s)";
+  }
+  std::cout << "." << std::endl;
+
+  return failures == 0;
+}
+
+void BatchProcessor::PrintTiming(const BatchTiming& timing) {
+  if (!timing.succeeded) {
+    std::cout << timing.input << ": FAILED" << std::endl;
+    return;
+  }
+  std::cout << timing.input << " -> " << timing.output
+            << ": load " << timing.load_ms << " ms, filters "
+            << timing.filter_ms << " ms, save " << timing.save_ms
+            << " ms, total "
+            << timing.load_ms + timing.filter_ms + timing.save_ms << " ms"
+            << std::endl;
+}
+
+}  /* namespace image_tools */
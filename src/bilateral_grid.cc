@@ -0,0 +1,216 @@
+/*******************************************************************************
+ * Name            : bilateral_grid.cc
+ * Project         : FlashPhoto
+ * Module          : bilateral_grid
+ * Description     : Implementation of the BilateralGrid class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/bilateral_grid.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const float BilateralGrid::kMinSpatialSigma = 4.f;
+const float BilateralGrid::kMinRangeSigma = 0.05f;
+const int BilateralGrid::kPadding;
+const int BilateralGrid::kCellFloats;
+
+/** Cells the splat, blur and slice together spread a pixel over */
+const float kReachCells = 3.5f;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/**
+ * @brief Blur a line of length cells of cell_floats floats each, stride
+ * floats apart, by 1-4-6-4-1, taking cells beyond its ends as empty.
+ * scratch has room for length + 4 cells.
+ */
+static void BlurLine(float* data, int length, int stride, int cell_floats,
+                     float* scratch) {
+  std::fill(scratch, scratch + 2 * cell_floats, 0.f);
+  std::fill(scratch + (length + 2) * cell_floats,
+            scratch + (length + 4) * cell_floats, 0.f);
+  for (int i = 0; i < length; i++) {
+    std::copy(data + i * stride, data + i * stride + cell_floats,
+              scratch + (i + 2) * cell_floats);
+  }
+  for (int i = 0; i < length; i++) {
+    const float* window = scratch + i * cell_floats;
+    float* to = data + i * stride;
+    for (int f = 0; f < cell_floats; f++) {
+      to[f] = (window[f] + window[4 * cell_floats + f] +
+               4.f * (window[cell_floats + f] + window[3 * cell_floats + f]) +
+               6.f * window[2 * cell_floats + f]) * (1.f / 16.f);
+    }
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+BilateralGrid::BilateralGrid(int width, int height, float sigma_spatial,
+                             float sigma_range, int origin_x, int origin_y)
+    : identity_(sigma_spatial < 1.f || sigma_range <= 0.f || width < 1 ||
+                height < 1),
+      spatial_scale_(1.f / std::max(kMinSpatialSigma, sigma_spatial)),
+      range_scale_(1.f / std::max(kMinRangeSigma, sigma_range)),
+      origin_x_(origin_x), origin_y_(origin_y), first_column_(0),
+      first_row_(0), columns_(0), rows_(0), levels_(0), cells_(),
+      blurred_() {
+  if (identity_) {
+    return;
+  }
+  first_column_ = nearest(origin_x) - kPadding;
+  first_row_ = nearest(origin_y) - kPadding;
+  columns_ = nearest(origin_x + width - 1) - first_column_ + 1 + kPadding;
+  rows_ = nearest(origin_y + height - 1) - first_row_ + 1 + kPadding;
+  levels_ = static_cast<int>(range_scale_ + 0.5f) + 1 + 2 * kPadding;
+  cells_.resize(static_cast<size_t>(columns_) * rows_ * levels_ *
+                kCellFloats);
+  blurred_.resize(cells_.size());
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int BilateralGrid::halo(float sigma_spatial) {
+  if (sigma_spatial < 1.f) {
+    return 0;
+  }
+  return static_cast<int>(std::ceil(
+    kReachCells * std::max(kMinSpatialSigma, sigma_spatial)));
+}
+
+void BilateralGrid::SplatRows(const PixelBuffer& image, int row_begin,
+                              int row_end) {
+  const int width = image.width();
+  const int height = image.height();
+  std::fill(cells_.begin() + cell(0, row_begin, 0),
+            cells_.begin() + cell(0, row_end, 0), 0.f);
+
+  // Each pixel row goes to the cell row nearest it, so rows of cells can be
+  // filled independently; start a little before the first that could
+  int y = std::max(0, static_cast<int>(
+    (first_row_ + row_begin - 0.5f) / spatial_scale_) - origin_y_ - 1);
+  for (; y < height; y++) {
+    int row = nearest(origin_y_ + y) - first_row_;
+    if (row < row_begin) {
+      continue;
+    } else if (row >= row_end) {
+      break;
+    }
+    const ColorData* pixels = image.row(y);
+    for (int x = 0; x < width; x++) {
+      const ColorData& color = pixels[x];
+      float luminance = std::min(1.f, std::max(0.f, color.luminance()));
+      int column = nearest(origin_x_ + x) - first_column_;
+      int level = static_cast<int>(luminance * range_scale_ + 0.5f) +
+                  kPadding;
+      float* to = &cells_[cell(column, row, level)];
+      to[0] += color.red();
+      to[1] += color.green();
+      to[2] += color.blue();
+      to[3] += 1.f;
+    }
+  }
+}
+
+void BilateralGrid::BlurRows(int row_begin, int row_end) {
+  std::vector<float> scratch((std::max(columns_, levels_) + 4) *
+                             kCellFloats);
+  for (int row = row_begin; row < row_end; row++) {
+    for (int column = 0; column < columns_; column++) {
+      BlurLine(&cells_[cell(column, row, 0)], levels_, kCellFloats,
+               kCellFloats, scratch.data());
+    }
+    for (int level = 0; level < levels_; level++) {
+      BlurLine(&cells_[cell(0, row, level)], columns_,
+               levels_ * kCellFloats, kCellFloats, scratch.data());
+    }
+  }
+}
+
+void BilateralGrid::BlurColumns(int row_begin, int row_end) {
+  static const float kWeights[5] = {1.f / 16, 4.f / 16, 6.f / 16, 4.f / 16,
+                                    1.f / 16};
+  const int row_floats = cell(0, 1, 0);
+  for (int row = row_begin; row < row_end; row++) {
+    float* to = &blurred_[cell(0, row, 0)];
+    std::fill(to, to + row_floats, 0.f);
+    for (int tap = 0; tap < 5; tap++) {
+      int from_row = row + tap - 2;
+      if (from_row < 0 || from_row >= rows_) {
+        continue;
+      }
+      const float* from = &cells_[cell(0, from_row, 0)];
+      const float weight = kWeights[tap];
+      for (int i = 0; i < row_floats; i++) {
+        to[i] += weight * from[i];
+      }
+    }
+  }
+}
+
+void BilateralGrid::SliceRows(PixelBuffer* image, int y_begin,
+                              int y_end) const {
+  const int width = image->width();
+  const int column_floats = levels_ * kCellFloats;
+  const int row_floats = columns_ * column_floats;
+  for (int y = y_begin; y < y_end; y++) {
+    // Weights come from positions in the whole picture, so tiles match it
+    float row_position = (origin_y_ + y) * spatial_scale_;
+    int row = static_cast<int>(row_position);
+    float row_weight = row_position - row;
+    row -= first_row_;
+    ColorData* pixels = image->row(y);
+    for (int x = 0; x < width; x++) {
+      ColorData& color = pixels[x];
+      float column_position = (origin_x_ + x) * spatial_scale_;
+      int column = static_cast<int>(column_position);
+      float column_weight = column_position - column;
+      column -= first_column_;
+      float level_position = std::min(1.f, std::max(0.f, color.luminance())) *
+                             range_scale_ + kPadding;
+      int level = static_cast<int>(level_position);
+      float level_weight = level_position - level;
+
+      // Trilinear interpolation over the eight cells around the pixel
+      float sum[kCellFloats] = {0.f, 0.f, 0.f, 0.f};
+      const float* corner = &blurred_[cell(column, row, level)];
+      for (int dy = 0; dy < 2; dy++) {
+        float wy = dy ? row_weight : 1.f - row_weight;
+        for (int dx = 0; dx < 2; dx++) {
+          float wxy = wy * (dx ? column_weight : 1.f - column_weight);
+          const float* from = corner + dy * row_floats + dx * column_floats;
+          float w0 = wxy * (1.f - level_weight);
+          float w1 = wxy * level_weight;
+          for (int f = 0; f < kCellFloats; f++) {
+            sum[f] += w0 * from[f] + w1 * from[kCellFloats + f];
+          }
+        }
+      }
+      if (sum[3] > 0.f) {
+        float scale = 1.f / sum[3];
+        color = ColorData(sum[0] * scale, sum[1] * scale, sum[2] * scale,
+                          color.alpha()).clamped_color();
+      }
+    }
+  }
+}
+
+}  /* namespace image_tools */
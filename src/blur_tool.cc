@@ -16,16 +16,37 @@
 #include "include/blur_tool.h"
 #include <math.h>
 #include "include/filter_kernel.h"
+#include "include/memory_accounting.h"
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+BlurTool::~BlurTool(void) {
+  if (blur_mask_) {
+    for (int mask_row = 0; mask_row < mask_size_; mask_row++) {
+      delete [] blur_mask_[mask_row];
+    }
+    delete [] blur_mask_;
+    MemoryAccounting::RecordFree(MEMORY_TOOL_MASK,
+                                 mask_size_ * mask_size_ * sizeof(int));
+  }
+  for (int kernel = 0; kernel < kernel_count_; kernel++) {
+    delete filter_kernel_array_[kernel];
+  }
+  delete [] filter_kernel_array_;
+}
+
 /*******************************************************************************
  * Member Functions
  ******************************************************************************/
 void BlurTool::ApplyClick(int mouse_x, int mouse_y) {
+  TRACE_SCOPE("BlurTool::ApplyClick", "tool");
   PixelBuffer* display_buffer = my_toolbelt_->get_pixel_buffer();
   PixelBuffer* buffer_copy = display_buffer->Copy();
 
@@ -68,6 +89,8 @@ void BlurTool::ApplyClick(int mouse_x, int mouse_y) {
       }
     }
   }
+
+  delete buffer_copy;
 }
 
 void BlurTool::set_blur_mask() {
@@ -119,6 +142,8 @@ void BlurTool::set_blur_mask() {
   }
 
   blur_mask_ = new_blur_mask_;
+  MemoryAccounting::RecordAllocation(MEMORY_TOOL_MASK,
+                                     mask_size_ * mask_size_ * sizeof(int));
 }
 
 }  /* namespace image_tools */
@@ -17,8 +17,10 @@
 #include <cmath>
 #include <iostream>
 #include "include/color_data.h"
+#include "include/memory_accounting.h"
 #include "include/pixel_buffer.h"
 #include "include/toolbelt.h"
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
@@ -29,6 +31,7 @@ namespace image_tools {
  * Member Functions
  ******************************************************************************/
 void Brush::ApplyClick(int mouse_x, int mouse_y) {
+  TRACE_SCOPE("Brush::ApplyClick", "tool");
   PixelBuffer* display_buffer = my_toolbelt_->get_pixel_buffer();
 
   ColorData active_color = my_toolbelt_->get_active_color();
@@ -89,6 +92,7 @@ void Brush::ApplyClick(int mouse_x, int mouse_y) {
 }
 
 void Brush::ApplyDragged(int x1, int y1, int x2, int y2) {
+  TRACE_SCOPE("Brush::ApplyDragged", "tool");
   int x_change = x2 - x1;
   int y_change = y2 - y1;
 
@@ -145,6 +149,8 @@ void Brush::set_mask_rectangle(int width,
   int col_start = pad_width;
   int col_end = new_mask_size - 1 - pad_width;
 
+  clear_mask();
+
   // Create the new mask.
   double** new_mask = nullptr;
   // Create a dynamic array of pointers to double.
@@ -176,6 +182,8 @@ void Brush::set_mask_rectangle(int width,
 
   mask_ = new_mask;
   mask_size_ = new_mask_size;
+  MemoryAccounting::RecordAllocation(
+    MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(double));
 }
 
 void Brush::set_mask_circle(int diameter,
@@ -201,6 +209,8 @@ void Brush::set_mask_circle(int diameter,
     falloff_rate = (outer_intensity - center_intensity) / center_index;
   }
 
+  clear_mask();
+
   // Create the new mask.
   double** new_mask = nullptr;
   // Create a dynamic array of pointers to double.
@@ -241,6 +251,20 @@ void Brush::set_mask_circle(int diameter,
 
   mask_ = new_mask;
   mask_size_ = new_mask_diameter;
+  MemoryAccounting::RecordAllocation(
+    MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(double));
+}
+
+void Brush::clear_mask(void) {
+  if (mask_) {
+    for (int mask_row = 0; mask_row < mask_size_; mask_row++) {
+      delete [] mask_[mask_row];
+    }
+    delete [] mask_;
+    mask_ = nullptr;
+    MemoryAccounting::RecordFree(
+      MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(double));
+  }
 }
 
 }  /* namespace image_tools */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * Name            : canvas_history.cc
+ * Project         : FlashPhoto
+ * Module          : state_manager
+ * Description     : Implementation of the CanvasHistory class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/canvas_history.h"
+#include "include/memory_accounting.h"
+#include "include/pixel_pool.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void CanvasHistory::RegisterNewState(ColorData* pixels) {
+  TRACE_SCOPE("CanvasHistory::RegisterNewState", "undo");
+  PixelPool::Reassign(pixels, MEMORY_UNDO);
+  undo_stack_.push_back(pixels);
+  ClearRedoStack();
+  TrimUndoStack();
+}
+
+ColorData* CanvasHistory::Undo(void) {
+  TRACE_SCOPE("CanvasHistory::Undo", "undo");
+  redo_stack_.push(undo_stack_.back());
+  undo_stack_.pop_back();
+  return undo_stack_.back();
+}
+
+ColorData* CanvasHistory::Redo(void) {
+  TRACE_SCOPE("CanvasHistory::Redo", "undo");
+  undo_stack_.push_back(redo_stack_.top());
+  redo_stack_.pop();
+  return undo_stack_.back();
+}
+
+void CanvasHistory::Clear(void) {
+  TRACE_SCOPE("CanvasHistory::Clear", "undo");
+  ClearRedoStack();
+  ClearUndoStack();
+}
+
+void CanvasHistory::ClearRedoStack(void) {
+  while (!redo_stack_.empty()) {
+    PixelPool::Return(redo_stack_.top());
+    redo_stack_.pop();
+  }
+}
+
+void CanvasHistory::ClearUndoStack(void) {
+  while (!undo_stack_.empty()) {
+    PixelPool::Return(undo_stack_.back());
+    undo_stack_.pop_back();
+  }
+}
+
+int64_t CanvasHistory::max_bytes(void) {
+  return MemoryAccounting::budget(MEMORY_UNDO);
+}
+
+void CanvasHistory::set_max_bytes(int64_t max_bytes) {
+  MemoryAccounting::set_budget(MEMORY_UNDO, max_bytes);
+  TrimUndoStack();
+}
+
+void CanvasHistory::TrimUndoStack(void) {
+  size_t evicted = 0;
+  while (undo_stack_.size() > 2 &&
+         MemoryAccounting::over_budget(MEMORY_UNDO)) {
+    PixelPool::Return(undo_stack_.front());
+    undo_stack_.pop_front();
+    evicted++;
+  }
+  if (evicted > 0) {
+    // Evicted states would otherwise stay resident as idle pool memory
+    PixelPool::Trim();
+    evicted_states_ += evicted;
+  }
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Name            : canvas_viewport.cc
+ * Project         : FlashPhoto
+ * Module          : canvas_viewport
+ * Description     : Implementation of the CanvasViewport class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/canvas_viewport.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const double CanvasViewport::kMaxZoom = 32.0;
+const double CanvasViewport::kMinZoom = 1.0 / 256;
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+CanvasViewport::CanvasViewport(void) : canvas_width_(1), canvas_height_(1),
+                                       window_width_(1), window_height_(1),
+                                       zoom_(1.0), origin_x_(0.0),
+                                       origin_y_(0.0) {}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void CanvasViewport::set_canvas_size(int width, int height) {
+  canvas_width_ = std::max(1, width);
+  canvas_height_ = std::max(1, height);
+  ClampOrigin();
+}
+
+void CanvasViewport::set_window_size(int width, int height) {
+  window_width_ = std::max(1, width);
+  window_height_ = std::max(1, height);
+  ClampOrigin();
+}
+
+void CanvasViewport::FitToWindow(void) {
+  zoom_ = std::min(1.0, std::min(
+    static_cast<double>(window_width_) / canvas_width_,
+    static_cast<double>(window_height_) / canvas_height_));
+  origin_x_ = 0.0;
+  origin_y_ = 0.0;
+  ClampOrigin();
+}
+
+void CanvasViewport::ZoomAt(double zoom, int window_x, int window_y) {
+  zoom = std::max(kMinZoom, std::min(kMaxZoom, zoom));
+  double canvas_x = origin_x_ + window_x / zoom_;
+  double canvas_y = origin_y_ + window_y / zoom_;
+  zoom_ = zoom;
+  origin_x_ = canvas_x - window_x / zoom_;
+  origin_y_ = canvas_y - window_y / zoom_;
+  ClampOrigin();
+}
+
+void CanvasViewport::Pan(int window_dx, int window_dy) {
+  origin_x_ += window_dx / zoom_;
+  origin_y_ += window_dy / zoom_;
+  ClampOrigin();
+}
+
+void CanvasViewport::WindowToCanvas(int window_x, int window_y,
+                                    int* canvas_x, int* canvas_y) const {
+  *canvas_x = static_cast<int>(std::floor(origin_x_ + window_x / zoom_));
+  *canvas_y = static_cast<int>(std::floor(origin_y_ + window_y / zoom_));
+}
+
+double CanvasViewport::CanvasToWindowX(double canvas_x) const {
+  return (canvas_x - origin_x_) * zoom_;
+}
+
+double CanvasViewport::CanvasToWindowY(double canvas_y) const {
+  return (canvas_y - origin_y_) * zoom_;
+}
+
+void CanvasViewport::VisibleRegion(int* x_begin, int* y_begin, int* x_end,
+                                   int* y_end) const {
+  *x_begin = std::max(0, static_cast<int>(std::floor(origin_x_)));
+  *y_begin = std::max(0, static_cast<int>(std::floor(origin_y_)));
+  *x_end = std::min(canvas_width_, static_cast<int>(
+    std::ceil(origin_x_ + window_width_ / zoom_)));
+  *y_end = std::min(canvas_height_, static_cast<int>(
+    std::ceil(origin_y_ + window_height_ / zoom_)));
+}
+
+void CanvasViewport::ClampOrigin(void) {
+  double view_width = window_width_ / zoom_;
+  double view_height = window_height_ / zoom_;
+  if (view_width >= canvas_width_) {
+    origin_x_ = (canvas_width_ - view_width) / 2;
+  } else {
+    origin_x_ = std::max(0.0, std::min(origin_x_,
+                                       canvas_width_ - view_width));
+  }
+  if (view_height >= canvas_height_) {
+    origin_y_ = (canvas_height_ - view_height) / 2;
+  } else {
+    origin_y_ = std::max(0.0, std::min(origin_y_,
+                                       canvas_height_ - view_height));
+  }
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * Name            : ditherer.cc
+ * Project         : FlashPhoto
+ * Module          : ditherer
+ * Description     : Implementation of the Ditherer class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/ditherer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int Ditherer::kBlockRows;
+const int Ditherer::kBlockColumns;
+const int Ditherer::kSkew;
+const int Ditherer::kErrorChannels;
+const int Ditherer::kHistoryRows;
+
+/** Sides of the threshold matrices; powers of two */
+const int kBayerBits = 3;
+const int kBayerSize = 1 << kBayerBits;
+const int kBlueNoiseSize = 64;
+
+/** Radius, in pixels, of the Gaussian that void-and-cluster measures with */
+const float kBlueNoiseSigma = 1.5f;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/**
+ * @brief The rank of each cell of a blue noise threshold matrix, made with
+ * Ulichney's void-and-cluster method. Points are added to the largest gaps
+ * (lowest energy) and removed from the tightest clusters (highest), so
+ * every prefix of the ranks is evenly spread.
+ */
+static std::vector<int> MakeBlueNoiseRanks(void) {
+  const int size = kBlueNoiseSize;
+  const int mask = size - 1;
+  const int cells = size * size;
+
+  // Energy a point adds at each offset from it, wrapping around the edges
+  std::vector<float> gaussian(cells);
+  for (int dy = 0; dy < size; dy++) {
+    for (int dx = 0; dx < size; dx++) {
+      int wrapped_x = std::min(dx, size - dx);
+      int wrapped_y = std::min(dy, size - dy);
+      gaussian[dy * size + dx] = std::exp(
+        -(wrapped_x * wrapped_x + wrapped_y * wrapped_y) /
+        (2.f * kBlueNoiseSigma * kBlueNoiseSigma));
+    }
+  }
+
+  std::vector<char> points(cells, 0);
+  std::vector<float> energy(cells, 0.f);
+  auto toggle = [&](int cell, bool set) {
+    points[cell] = set;
+    float sign = set ? 1.f : -1.f;
+    int cell_x = cell & mask;
+    int cell_y = cell / size;
+    for (int y = 0; y < size; y++) {
+      const float* from = &gaussian[((y - cell_y) & mask) * size];
+      float* to = &energy[y * size];
+      for (int x = 0; x < size; x++) {
+        to[x] += sign * from[(x - cell_x) & mask];
+      }
+    }
+  };
+  auto tightest_cluster = [&]() {
+    int best = -1;
+    for (int cell = 0; cell < cells; cell++) {
+      if (points[cell] && (best < 0 || energy[cell] > energy[best])) {
+        best = cell;
+      }
+    }
+    return best;
+  };
+  auto largest_void = [&]() {
+    int best = -1;
+    for (int cell = 0; cell < cells; cell++) {
+      if (!points[cell] && (best < 0 || energy[cell] < energy[best])) {
+        best = cell;
+      }
+    }
+    return best;
+  };
+
+  // A tenth of the cells, picked by a fixed generator so the matrix is
+  // always the same, then spread out until moving the most crowded point
+  // to the largest gap puts it back where it was
+  const int initial = cells / 10;
+  uint32_t state = 1;
+  for (int placed = 0; placed < initial;) {
+    state = state * 1664525u + 1013904223u;
+    int cell = (state >> 8) % cells;
+    if (!points[cell]) {
+      toggle(cell, true);
+      placed++;
+    }
+  }
+  for (int moves = 0; moves < cells; moves++) {
+    int cluster = tightest_cluster();
+    toggle(cluster, false);
+    int gap = largest_void();
+    toggle(gap, true);
+    if (gap == cluster) {
+      break;
+    }
+  }
+
+  std::vector<int> ranks(cells);
+  std::vector<char> prototype = points;
+  std::vector<float> prototype_energy = energy;
+  for (int rank = initial - 1; rank >= 0; rank--) {
+    int cluster = tightest_cluster();
+    toggle(cluster, false);
+    ranks[cluster] = rank;
+  }
+  // The largest gap among the cells left empty is also the tightest
+  // cluster of them, so one rule ranks all the rest
+  points = prototype;
+  energy = prototype_energy;
+  for (int rank = initial; rank < cells; rank++) {
+    int gap = largest_void();
+    toggle(gap, true);
+    ranks[gap] = rank;
+  }
+  return ranks;
+}
+
+/**
+ * @brief The level, 0 to levels, nearest a value from 0 to 1
+ */
+static inline float NearestLevel(float value, float levels) {
+  return std::min(levels, std::max(0.f, rintf(value * levels)));
+}
+
+/**
+ * @brief The level, 0 to levels, below a value from 0 to 1, or the one
+ * above if the value is more than 1 - threshold of the way to it
+ */
+static inline float OrderedLevel(float value, float threshold, float levels) {
+  return std::min(levels, std::max(0.f, floorf(value * levels + threshold)));
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+Ditherer::Ditherer(Method method, int bins) : method_(method),
+                                              levels_(bins - 1),
+                                              matrix_size_(0),
+                                              thresholds_(), taps_() {
+  switch (method) {
+    case BAYER:
+      // The lowest bits of x ^ y and y pick the most significant bits of
+      // the index, so consecutive thresholds land far apart
+      matrix_size_ = kBayerSize;
+      thresholds_.resize(kBayerSize * kBayerSize);
+      for (int y = 0; y < kBayerSize; y++) {
+        for (int x = 0; x < kBayerSize; x++) {
+          int index = 0;
+          for (int bit = 0; bit < kBayerBits; bit++) {
+            int x_bit = (x >> bit) & 1;
+            int y_bit = (y >> bit) & 1;
+            index |= (((x_bit ^ y_bit) << 1) | y_bit) <<
+                     (2 * (kBayerBits - 1 - bit));
+          }
+          thresholds_[y * kBayerSize + x] =
+              (index + 0.5f) / (kBayerSize * kBayerSize);
+        }
+      }
+      break;
+    case BLUE_NOISE: {
+      // Thread-safe, and only paid for the first time
+      static const std::vector<int> ranks = MakeBlueNoiseRanks();
+      matrix_size_ = kBlueNoiseSize;
+      thresholds_.resize(ranks.size());
+      for (size_t cell = 0; cell < ranks.size(); cell++) {
+        thresholds_[cell] = (ranks[cell] + 0.5f) / ranks.size();
+      }
+      break;
+    }
+    case FLOYD_STEINBERG:
+      taps_ = {{-1, 0, 7 / 16.f}, {1, -1, 3 / 16.f}, {0, -1, 5 / 16.f},
+               {-1, -1, 1 / 16.f}};
+      break;
+    case ATKINSON:
+    default:
+      taps_ = {{-1, 0, 1 / 8.f}, {-2, 0, 1 / 8.f}, {1, -1, 1 / 8.f},
+               {0, -1, 1 / 8.f}, {-1, -1, 1 / 8.f}, {0, -2, 1 / 8.f}};
+      break;
+  }
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int Ditherer::block_columns(int width, int height) {
+  int skewed_width = width + kSkew * (height - 1);
+  return (skewed_width + kBlockColumns - 1) / kBlockColumns;
+}
+
+void Ditherer::OrderRows(PixelBuffer* image, int y_begin, int y_end) const {
+  const int width = image->width();
+  const int mask = matrix_size_ - 1;
+  const float levels = levels_;
+  const float scale = 1.f / levels_;
+
+  for (int y = y_begin; y < y_end; y++) {
+    ColorData* row = image->row(y);
+    const float* matrix_row = &thresholds_[(y & mask) * matrix_size_];
+    // Branch-free, so the compiler can vectorize it
+    for (int x = 0; x < width; x++) {
+      float threshold = matrix_row[x & mask];
+      row[x] = ColorData(
+        OrderedLevel(row[x].red(), threshold, levels) * scale,
+        OrderedLevel(row[x].green(), threshold, levels) * scale,
+        OrderedLevel(row[x].blue(), threshold, levels) * scale,
+        row[x].alpha());
+    }
+  }
+}
+
+void Ditherer::DiffuseBlock(PixelBuffer* image, float* errors, int block_y,
+                            int block_x) const {
+  const int width = image->width();
+  const int y_begin = block_y * kBlockRows;
+  const int y_end = std::min(image->height(), y_begin + kBlockRows);
+  const float scale = 1.f / levels_;
+
+  for (int y = y_begin; y < y_end; y++) {
+    int x_begin = std::max(0, block_x * kBlockColumns - kSkew * y);
+    int x_end = std::min(width, (block_x + 1) * kBlockColumns - kSkew * y);
+    ColorData* row = image->row(y);
+    for (int x = x_begin; x < x_end; x++) {
+      float value[kErrorChannels] = {row[x].red(), row[x].green(),
+                                     row[x].blue()};
+      for (const Tap& tap : taps_) {
+        int from_x = x + tap.dx;
+        int from_y = y + tap.dy;
+        if (from_x < 0 || from_x >= width) {
+          continue;
+        }
+        const float* error = errors + (from_y * width + from_x) *
+                             kErrorChannels;
+        for (int c = 0; c < kErrorChannels; c++) {
+          value[c] += tap.weight * error[c];
+        }
+      }
+
+      float* error = errors + (y * width + x) * kErrorChannels;
+      float level[kErrorChannels];
+      for (int c = 0; c < kErrorChannels; c++) {
+        level[c] = NearestLevel(value[c], levels_) * scale;
+        error[c] = value[c] - level[c];
+      }
+      row[x] = ColorData(level[0], level[1], level[2], row[x].alpha());
+    }
+  }
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * Name            : encode_settings.cc
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Implementation of the encoder profiles
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/encode_settings.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+PngEncodeSettings PngEncodeSettings::ForProfile(EncodeProfile profile) {
+  PngEncodeSettings settings;
+  switch (profile) {
+    case ENCODE_PROFILE_STORE:
+      // Stored deflate blocks; filtering would only cost time.
+      settings.compression_level = 0;
+      settings.filter = PNG_FILTER_HEURISTIC_NONE;
+      break;
+    case ENCODE_PROFILE_FASTEST:
+      // Sub is the cheapest filter that still helps, and RLE matching is
+      // much faster than a full search at level 1.
+      settings.compression_level = 1;
+      settings.filter = PNG_FILTER_HEURISTIC_SUB;
+      settings.strategy = PNG_STRATEGY_RLE;
+      break;
+    case ENCODE_PROFILE_SMALLEST:
+      settings.compression_level = 9;
+      settings.filter = PNG_FILTER_HEURISTIC_ADAPTIVE;
+      break;
+    case ENCODE_PROFILE_BALANCED:
+    default:
+      break;
+  }
+  return settings;
+}
+
+JpegEncodeSettings JpegEncodeSettings::ForProfile(EncodeProfile profile,
+                                                  int quality) {
+  JpegEncodeSettings settings;
+  settings.quality = quality;
+  switch (profile) {
+    case ENCODE_PROFILE_STORE:  // JPEG has no uncompressed mode
+    case ENCODE_PROFILE_FASTEST:
+      settings.fast_dct = true;
+      break;
+    case ENCODE_PROFILE_SMALLEST:
+      settings.progressive = true;
+      settings.optimize_coding = true;
+      break;
+    case ENCODE_PROFILE_BALANCED:
+    default:
+      break;
+  }
+  return settings;
+}
+
+const char* EncodeProfileName(EncodeProfile profile) {
+  switch (profile) {
+    case ENCODE_PROFILE_STORE:
+      return "store";
+    case ENCODE_PROFILE_FASTEST:
+      return "fastest";
+    case ENCODE_PROFILE_BALANCED:
+      return "balanced";
+    case ENCODE_PROFILE_SMALLEST:
+      return "smallest";
+    default:
+      return "unknown";
+  }
+}
+
+}  /* namespace image_tools */
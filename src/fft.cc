@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Name            : fft.cc
+ * Project         : FlashPhoto
+ * Module          : fft
+ * Description     : Implementation of the Fft class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/fft.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** Side of the blocks a square is transposed in, to stay in cache */
+const int kTransposeBlock = 16;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static void Transpose(Fft::Complex* data, int size) {
+  for (int block_y = 0; block_y < size; block_y += kTransposeBlock) {
+    int block_y_end = std::min(size, block_y + kTransposeBlock);
+    for (int block_x = block_y; block_x < size; block_x += kTransposeBlock) {
+      int block_x_end = std::min(size, block_x + kTransposeBlock);
+      for (int y = block_y; y < block_y_end; y++) {
+        int x = (block_x == block_y) ? y + 1 : block_x;
+        for (; x < block_x_end; x++) {
+          std::swap(data[y * size + x], data[x * size + y]);
+        }
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+Fft::Fft(int size) : size_(size), bit_reverse_(size), twiddles_(size / 2) {
+  int bits = 0;
+  while ((1 << bits) < size) {
+    bits++;
+  }
+  for (int i = 0; i < size; i++) {
+    int reversed = 0;
+    for (int bit = 0; bit < bits; bit++) {
+      reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+    }
+    bit_reverse_[i] = reversed;
+  }
+  for (int k = 0; k < size / 2; k++) {
+    double angle = -2.0 * M_PI * k / size;
+    twiddles_[k] = Complex(std::cos(angle), std::sin(angle));
+  }
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void Fft::Transform(Complex* data, bool inverse) const {
+  for (int i = 0; i < size_; i++) {
+    int j = bit_reverse_[i];
+    if (i < j) {
+      std::swap(data[i], data[j]);
+    }
+  }
+
+  // Butterflies written out, since std::complex's operator* checks for
+  // infinities and NaNs on every multiply
+  double sign = inverse ? -1.0 : 1.0;
+  for (int half = 1; half < size_; half *= 2) {
+    int step = size_ / (2 * half);
+    for (int start = 0; start < size_; start += 2 * half) {
+      Complex* a = data + start;
+      Complex* b = a + half;
+      for (int k = 0; k < half; k++) {
+        double w_real = twiddles_[k * step].real();
+        double w_imag = sign * twiddles_[k * step].imag();
+        double t_real = b[k].real() * w_real - b[k].imag() * w_imag;
+        double t_imag = b[k].real() * w_imag + b[k].imag() * w_real;
+        b[k] = Complex(a[k].real() - t_real, a[k].imag() - t_imag);
+        a[k] = Complex(a[k].real() + t_real, a[k].imag() + t_imag);
+      }
+    }
+  }
+}
+
+void Fft::Transform2D(Complex* data, int rows, bool inverse) const {
+  // Transforms of the rows that are all zero would be all zero
+  for (int row = 0; row < rows; row++) {
+    Transform(data + row * size_, inverse);
+  }
+  Transpose(data, size_);
+  for (int row = 0; row < size_; row++) {
+    Transform(data + row * size_, inverse);
+  }
+}
+
+}  /* namespace image_tools */
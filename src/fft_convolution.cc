@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * Name            : fft_convolution.cc
+ * Project         : FlashPhoto
+ * Module          : fft_convolution
+ * Description     : Implementation of the FftConvolution class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/fft_convolution.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int FftConvolution::kMinFftSize;
+const int FftConvolution::kMaxFftSize;
+
+/*
+ * Nanoseconds, measured with -O2, that FilterKernel::ApplyRows() spends per
+ * pixel on each tap and each run of taps, and that a tile spends per
+ * butterfly of its four N x N transforms of N * log2(N) butterflies each,
+ * including filling, multiplying and adding up the tile
+ */
+const double kTapCost = 0.4;
+const double kRunCost = 2.4;
+const double kButterflyCost = 1.8;
+
+/*
+ * How many times cheaper the transforms must be. Their sums are rounded
+ * differently, so where the two paths are close the exact one is kept.
+ */
+const double kFftAdvantage = 1.5;
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+FftConvolution::FftConvolution(const FilterKernel& kernel, int fft_size)
+    : kernel_(kernel), radius_(kernel.kernel_size() / 2),
+      tile_size_(fft_size - kernel.kernel_size() + 1), total_weight_(0),
+      fft_(fft_size), kernel_spectrum_(fft_size * fft_size) {
+  // The kernel is reflected about its center, since Apply() correlates,
+  // and wrapped so its center is at the origin.
+  int size = kernel.kernel_size();
+  std::vector<int> weights = kernel.Weights();
+  for (int kernel_y = 0; kernel_y < size; kernel_y++) {
+    for (int kernel_x = 0; kernel_x < size; kernel_x++) {
+      int weight = weights[kernel_y * size + kernel_x];
+      int u = (radius_ - kernel_x + fft_size) % fft_size;
+      int v = (radius_ - kernel_y + fft_size) % fft_size;
+      kernel_spectrum_[v * fft_size + u] = Fft::Complex(weight, 0.0);
+      total_weight_ += weight;
+    }
+  }
+  fft_.Transform2D(kernel_spectrum_.data(), fft_size, false);
+  double scale = 1.0 / (static_cast<double>(fft_size) * fft_size);
+  for (Fft::Complex& value : kernel_spectrum_) {
+    value *= scale;
+  }
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int FftConvolution::ChooseFftSize(const FilterKernel& kernel, int width,
+                                  int height) {
+  int size = kernel.kernel_size();
+  double best_cost = (kTapCost * kernel.tap_count() +
+                      kRunCost * kernel.run_count()) * width * height;
+  int best_size = 0;
+  for (int fft_size = kMinFftSize; fft_size <= kMaxFftSize; fft_size *= 2) {
+    // Tiles two apart must not reach the same pixels
+    int tile = fft_size - size + 1;
+    if (tile < size - 1) {
+      continue;
+    }
+    double tiles = static_cast<double>((width + tile - 1) / tile) *
+                   ((height + tile - 1) / tile);
+    double cost = kFftAdvantage * kButterflyCost * tiles * 4.0 * fft_size *
+                  fft_size * std::log2(fft_size);
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_size = fft_size;
+    }
+  }
+  return best_size;
+}
+
+void FftConvolution::AddTile(const PixelBuffer& source, int x, int y,
+                             PixelBuffer* target) const {
+  const int size = fft_.size();
+  const int width = source.width();
+  const int height = source.height();
+  const int tile_width = std::min(tile_size_, width - x);
+  const int tile_height = std::min(tile_size_, height - y);
+
+  // Red and green, and blue and alpha, as the real and imaginary parts
+  std::vector<Fft::Complex> red_green(size * size);
+  std::vector<Fft::Complex> blue_alpha(size * size);
+  for (int row = 0; row < tile_height; row++) {
+    const ColorData* from = source.row(y + row) + x;
+    Fft::Complex* to_red_green = &red_green[row * size];
+    Fft::Complex* to_blue_alpha = &blue_alpha[row * size];
+    for (int column = 0; column < tile_width; column++) {
+      to_red_green[column] = Fft::Complex(from[column].red(),
+                                          from[column].green());
+      to_blue_alpha[column] = Fft::Complex(from[column].blue(),
+                                           from[column].alpha());
+    }
+  }
+
+  fft_.Transform2D(red_green.data(), tile_height, false);
+  fft_.Transform2D(blue_alpha.data(), tile_height, false);
+  for (int i = 0; i < size * size; i++) {
+    const Fft::Complex& k = kernel_spectrum_[i];
+    const Fft::Complex& a = red_green[i];
+    const Fft::Complex& b = blue_alpha[i];
+    red_green[i] = Fft::Complex(a.real() * k.real() - a.imag() * k.imag(),
+                                a.real() * k.imag() + a.imag() * k.real());
+    blue_alpha[i] = Fft::Complex(b.real() * k.real() - b.imag() * k.imag(),
+                                 b.real() * k.imag() + b.imag() * k.real());
+  }
+  fft_.Transform2D(red_green.data(), size, true);
+  fft_.Transform2D(blue_alpha.data(), size, true);
+
+  // The tile spreads radius_ pixels each way; what would wrap around to
+  // the other side of the transform lands at negative offsets.
+  int y_begin = std::max(0, y - radius_);
+  int y_end = std::min(height, y + tile_height + radius_);
+  int x_begin = std::max(0, x - radius_);
+  int x_end = std::min(width, x + tile_width + radius_);
+  for (int target_y = y_begin; target_y < y_end; target_y++) {
+    int row = (target_y - y + size) % size;
+    ColorData* to = target->row(target_y);
+    for (int target_x = x_begin; target_x < x_end; target_x++) {
+      int index = row * size + (target_x - x + size) % size;
+      const ColorData& sum = to[target_x];
+      to[target_x] = ColorData(
+        sum.red() + static_cast<float>(red_green[index].real()),
+        sum.green() + static_cast<float>(red_green[index].imag()),
+        sum.blue() + static_cast<float>(blue_alpha[index].real()),
+        sum.alpha() + static_cast<float>(blue_alpha[index].imag()));
+    }
+  }
+}
+
+void FftConvolution::Finish(PixelBuffer* target, int y_begin, int y_end,
+                            float bias) const {
+  const int width = target->width();
+  const int height = target->height();
+  const ColorData bias_color = ColorData(bias, bias, bias, 0);
+  for (int y = y_begin; y < y_end; y++) {
+    ColorData* row = target->row(y);
+    bool edge_row = (y < radius_ || y >= height - radius_);
+    for (int x = 0; x < width; x++) {
+      int weight = total_weight_;
+      if (edge_row || x < radius_ || x >= width - radius_) {
+        weight = kernel_.ValidWeight(x, y, width, height);
+      }
+      double factor = (weight <= 0) ? 1. : 1. / weight;
+      // Apply()'s sums start from an alpha of 1
+      ColorData sum = row[x] + ColorData(0., 0., 0., 1.);
+      row[x] = (sum * factor + bias_color).clamped_color();
+    }
+  }
+}
+
+}  /* namespace image_tools */
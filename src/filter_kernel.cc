@@ -13,18 +13,203 @@
  * Includes
  ******************************************************************************/
 #include "include/filter_kernel.h"
+#include <algorithm>
 #include <iostream>
 #include "include/pixel_buffer.h"
-#include "include/ui_ctrl.h"
-#include "include/state_manager.h"
-#include "include/io_manager.h"
 #include "include/color_data.h"
+#include "include/memory_accounting.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/*
+ * The weights of the 3x3 and 5x5 kernels, row by row from the top, as the
+ * kernel functions below define them.
+ */
+constexpr int kBlur3[] = {
+  0, 1, 0,
+  1, 1, 1,
+  0, 1, 0};
+constexpr int kBlur5[] = {
+  0, 0, 1, 0, 0,
+  0, 1, 1, 1, 0,
+  1, 1, 1, 1, 1,
+  0, 1, 1, 1, 0,
+  0, 0, 1, 0, 0};
+constexpr int kBlurNS3[] = {
+  0, 1, 0,
+  0, 1, 0,
+  0, 1, 0};
+constexpr int kBlurNS5[] = {
+  0, 0, 1, 0, 0,
+  0, 0, 1, 0, 0,
+  0, 0, 1, 0, 0,
+  0, 0, 1, 0, 0,
+  0, 0, 1, 0, 0};
+constexpr int kBlurEW3[] = {
+  0, 0, 0,
+  1, 1, 1,
+  0, 0, 0};
+constexpr int kBlurEW5[] = {
+  0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0,
+  1, 1, 1, 1, 1,
+  0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0};
+constexpr int kBlurNESW3[] = {
+  0, 0, 1,
+  0, 1, 0,
+  1, 0, 0};
+constexpr int kBlurNESW5[] = {
+  0, 0, 0, 0, 1,
+  0, 0, 0, 1, 0,
+  0, 0, 1, 0, 0,
+  0, 1, 0, 0, 0,
+  1, 0, 0, 0, 0};
+constexpr int kBlurNWSE3[] = {
+  1, 0, 0,
+  0, 1, 0,
+  0, 0, 1};
+constexpr int kBlurNWSE5[] = {
+  1, 0, 0, 0, 0,
+  0, 1, 0, 0, 0,
+  0, 0, 1, 0, 0,
+  0, 0, 0, 1, 0,
+  0, 0, 0, 0, 1};
+constexpr int kSharpen3[] = {
+   0, -1,  0,
+  -1,  5, -1,
+   0, -1,  0};
+constexpr int kSharpen5[] = {
+   0,  0, -1,  0,  0,
+   0,  0, -1,  0,  0,
+  -1, -1,  9, -1, -1,
+   0,  0, -1,  0,  0,
+   0,  0, -1,  0,  0};
+constexpr int kEdgeDetect3[] = {
+  -1, -1, -1,
+  -1,  8, -1,
+  -1, -1, -1};
+constexpr int kEdgeDetect5[] = {
+  -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1,
+  -1, -1, 24, -1, -1,
+  -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1};
+constexpr int kEmboss3[] = {
+  -1, -1,  0,
+  -1,  0,  1,
+   0,  1,  1};
+constexpr int kEmboss5[] = {
+  -1, -1, -1, -1,  0,
+  -1, -1, -1,  0,  1,
+  -1, -1,  0,  1,  1,
+  -1,  0,  1,  1,  1,
+   0,  1,  1,  1,  1};
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/**
+ * @brief Whether the weight of tap also belongs to an earlier tap
+ */
+constexpr bool WeightSeenBefore(const int* weights, int tap, int earlier) {
+  return earlier < tap && (weights[earlier] == weights[tap] ||
+                           WeightSeenBefore(weights, tap, earlier + 1));
+}
+
+constexpr int WeightSum(const int* weights, int taps) {
+  return (taps == 0) ? 0 : weights[taps - 1] + WeightSum(weights, taps - 1);
+}
+
+static inline float ClampValue(float input) {
+  return input < 0.f ? 0.f : (input > 1.f ? 1.f : input);
+}
+
+/**
+ * @brief Adds up the pixels under the taps of one weight, from tap
+ * kSize * kSize - kRemaining to the last, unrolled at compile time
+ */
+template <int kSize, const int* kWeights, int kRemaining>
+struct StencilSum {
+  static inline void Add(const ColorData* const* rows, int x, int weight,
+                         float* sum) {
+    constexpr int tap = kSize * kSize - kRemaining;
+    if (kWeights[tap] == weight) {
+      const ColorData& pixel = rows[tap / kSize][x + tap % kSize];
+      sum[0] += pixel.red();
+      sum[1] += pixel.green();
+      sum[2] += pixel.blue();
+      sum[3] += pixel.alpha();
+    }
+    StencilSum<kSize, kWeights, kRemaining - 1>::Add(rows, x, weight, sum);
+  }
+};
+
+template <int kSize, const int* kWeights>
+struct StencilSum<kSize, kWeights, 0> {
+  static inline void Add(const ColorData* const*, int, int, float*) {}
+};
+
+/**
+ * @brief Adds each weight's sum into the accumulator, weights in the order
+ * they first appear, as FilterKernel::Apply() does; unrolled at compile time
+ */
+template <int kSize, const int* kWeights, int kRemaining>
+struct StencilGroups {
+  static inline void Add(const ColorData* const* rows, int x,
+                         float* accumulator) {
+    constexpr int tap = kSize * kSize - kRemaining;
+    constexpr bool first_of_weight = kWeights[tap] != 0 &&
+                                     !WeightSeenBefore(kWeights, tap, 0);
+    if (first_of_weight) {
+      float sum[4] = {0.f, 0.f, 0.f, 0.f};
+      StencilSum<kSize, kWeights, kSize * kSize>::Add(rows, x, kWeights[tap],
+                                                      sum);
+      const float weight = static_cast<float>(kWeights[tap]);
+      for (int channel = 0; channel < 4; channel++) {
+        accumulator[channel] = accumulator[channel] + sum[channel] * weight;
+      }
+    }
+    StencilGroups<kSize, kWeights, kRemaining - 1>::Add(rows, x, accumulator);
+  }
+};
+
+template <int kSize, const int* kWeights>
+struct StencilGroups<kSize, kWeights, 0> {
+  static inline void Add(const ColorData* const*, int, float*) {}
+};
+
+/**
+ * @brief A FilterKernel::StencilFunction for one fixed kernel; gives the same
+ * results as FilterKernel::Apply() where every tap is on the image
+ */
+template <int kSize, const int* kWeights>
+static void ApplyStencil(const PixelBuffer& source, int y, int x_begin,
+                         int x_end, float bias, ColorData* out) {
+  const int radius = kSize / 2;
+  constexpr int total = WeightSum(kWeights, kSize * kSize);
+  const float factor = static_cast<float>((total <= 0) ? 1. : 1. / total);
+
+  const ColorData* rows[kSize];
+  for (int row = 0; row < kSize; row++) {
+    rows[row] = source.row(y + row - radius) - radius;
+  }
+  for (int x = x_begin; x < x_end; x++) {
+    float accumulator[4] = {0.f, 0.f, 0.f, 1.f};
+    StencilGroups<kSize, kWeights, kSize * kSize>::Add(rows, x, accumulator);
+    out[x] = ColorData(ClampValue(accumulator[0] * factor + bias),
+                       ClampValue(accumulator[1] * factor + bias),
+                       ClampValue(accumulator[2] * factor + bias),
+                       ClampValue(accumulator[3] * factor + 0.f));
+  }
+}
+
 /*******************************************************************************
  * Constructors/Destructor
  ******************************************************************************/
@@ -33,27 +218,45 @@ namespace image_tools {
 /*******************************************************************************
  * Member Functions
  ******************************************************************************/
-ColorData FilterKernel::Apply(PixelBuffer *buffer_copy,
-                              int buffer_x, int buffer_y, float bias) {
+ColorData FilterKernel::Apply(const PixelBuffer *buffer_copy,
+                              int buffer_x, int buffer_y, float bias) const {
   ColorData color_accumulator = ColorData(0., 0., 0., 1.);
+  const int width = buffer_copy->width();
+  const int height = buffer_copy->height();
 
   /*
-   * To prevent darkening around the edges, we need to verify the value of
-   * the kernel's factor.
+   * To prevent darkening around the edges, the factor only counts the taps
+   * that fall on the image. Each group of equal weight is summed first and
+   * then weighted once.
    */
   int factor_accumulator = 0;
-  int offset = kernel_size_ / 2;
-  int set_x, set_y;
   double factor;
-
-  for (int kernel_y = 0; kernel_y < kernel_size_; kernel_y++) {
-    for (int kernel_x = 0; kernel_x < kernel_size_; kernel_x++) {
-      set_x = buffer_x + kernel_x - offset;
-      set_y = buffer_y + kernel_y - offset;
-      if (buffer_copy->is_valid_pixel(set_x, set_y)) {
-        factor_accumulator += kernel_[kernel_y * kernel_size_ + kernel_x];
+  size_t run = 0;
+  while (run < runs_.size()) {
+    const int weight = runs_[run].weight;
+    float red = 0.f, green = 0.f, blue = 0.f, alpha = 0.f;
+    int group_taps = 0;
+    for (; run < runs_.size() && runs_[run].weight == weight; run++) {
+      const TapRun& tap_run = runs_[run];
+      int set_y = buffer_y + tap_run.dy;
+      if (set_y < 0 || set_y >= height) {
+        continue;
       }
+      int x_begin = std::max(0, buffer_x + tap_run.dx_begin);
+      int x_end = std::min(width, buffer_x + tap_run.dx_begin +
+                           tap_run.length);
+      const ColorData* row = buffer_copy->row(set_y);
+      for (int set_x = x_begin; set_x < x_end; set_x++) {
+        red += row[set_x].red();
+        green += row[set_x].green();
+        blue += row[set_x].blue();
+        alpha += row[set_x].alpha();
+      }
+      group_taps += std::max(0, x_end - x_begin);
     }
+    factor_accumulator += weight * group_taps;
+    color_accumulator = color_accumulator +
+                        ColorData(red, green, blue, alpha) * weight;
   }
 
   if (factor_accumulator <= 0)
@@ -61,32 +264,39 @@ ColorData FilterKernel::Apply(PixelBuffer *buffer_copy,
   else
     factor = 1. / factor_accumulator;
 
-  /*
-   * Now that we have the correct value for the factor
-   * by which to scale our colors, we can apply the kernel.
-   */
-  for (int kernel_y = 0; kernel_y < kernel_size_; kernel_y++) {
-    for (int kernel_x = 0; kernel_x < kernel_size_; kernel_x++) {
-      set_x = buffer_x + kernel_x - offset;
-      set_y = buffer_y + kernel_y - offset;
-      if (buffer_copy->is_valid_pixel(set_x, set_y)) {
-        color_accumulator = color_accumulator
-                            + buffer_copy->get_valid_pixel(set_x, set_y)
-                            * kernel_[kernel_y * kernel_size_ + kernel_x];
-      }
-    }
-  }
-
   ColorData bias_color = ColorData(bias, bias, bias, 0);
   return (color_accumulator * factor + bias_color).clamped_color();
 }
 
+void FilterKernel::ApplyRows(const PixelBuffer& source, PixelBuffer* target,
+                             int y_begin, int y_end, float bias) const {
+  const int width = source.width();
+  const int height = source.height();
+  const int radius = kernel_size_ / 2;
+  for (int y = y_begin; y < y_end; y++) {
+    ColorData* out = target->row(y);
+    int x_begin = width;
+    int x_end = width;
+    if (stencil_ && y >= radius && y < height - radius &&
+        width > 2 * radius) {
+      x_begin = radius;
+      x_end = width - radius;
+      stencil_(source, y, x_begin, x_end, bias, out);
+    }
+    // The edges, where some taps fall off the image
+    for (int x = 0; x < x_begin; x++) {
+      out[x] = Apply(&source, x, y, bias);
+    }
+    for (int x = x_end; x < width; x++) {
+      out[x] = Apply(&source, x, y, bias);
+    }
+  }
+}
+
 void FilterKernel::Init(const double filter_amount,
                         ConvolutionFilter filter_type) {
-  int filter_width = static_cast<int>(rint(filter_amount * 2.));
-  kernel_size_ = (!(filter_width % 2)) ? filter_width + 1 : filter_width;
-
-  kernel_ = new float[kernel_size_ * kernel_size_];
+  FreeKernel();
+  kernel_size_ = KernelSize(filter_amount);
 
   switch (filter_type) {
     case BLUR:
@@ -115,12 +325,123 @@ void FilterKernel::Init(const double filter_amount,
       break;
   }
 
+  std::vector<int> weights(kernel_size_ * kernel_size_);
+  std::vector<int> distinct_weights;  // In order of first appearance
   for (int kernel_y = 0; kernel_y < kernel_size_; kernel_y++) {
     for (int kernel_x = 0; kernel_x < kernel_size_; kernel_x++) {
-      kernel_[kernel_y * kernel_size_ + kernel_x] = (*kernel_function_)(
-        kernel_x, kernel_y, kernel_size_);
+      int weight = (*kernel_function_)(kernel_x, kernel_y, kernel_size_);
+      weights[kernel_y * kernel_size_ + kernel_x] = weight;
+      if (weight != 0 &&
+          std::find(distinct_weights.begin(), distinct_weights.end(),
+                    weight) == distinct_weights.end()) {
+        distinct_weights.push_back(weight);
+      }
+    }
+  }
+
+  int offset = kernel_size_ / 2;
+  for (int weight : distinct_weights) {
+    for (int kernel_y = 0; kernel_y < kernel_size_; kernel_y++) {
+      const int* row = &weights[kernel_y * kernel_size_];
+      for (int kernel_x = 0; kernel_x < kernel_size_; kernel_x++) {
+        if (row[kernel_x] != weight) {
+          continue;
+        }
+        int run_end = kernel_x + 1;
+        while (run_end < kernel_size_ && row[run_end] == weight) {
+          run_end++;
+        }
+        TapRun run = {kernel_y - offset, kernel_x - offset,
+                      run_end - kernel_x, weight};
+        runs_.push_back(run);
+        kernel_x = run_end;
+      }
     }
   }
+  runs_.shrink_to_fit();
+  MemoryAccounting::RecordAllocation(MEMORY_FILTER,
+                                     runs_.capacity() * sizeof(TapRun));
+  stencil_ = FindStencil(filter_type, kernel_size_);
+}
+
+FilterKernel::StencilFunction FilterKernel::FindStencil(
+    ConvolutionFilter filter_type, int kernel_size) {
+  if (kernel_size != 3 && kernel_size != 5) {
+    return nullptr;
+  }
+  bool small = (kernel_size == 3);
+  switch (filter_type) {
+    case BLUR:
+      return small ? &ApplyStencil<3, kBlur3> : &ApplyStencil<5, kBlur5>;
+    case BLUR_N_S:
+      return small ? &ApplyStencil<3, kBlurNS3> : &ApplyStencil<5, kBlurNS5>;
+    case BLUR_E_W:
+      return small ? &ApplyStencil<3, kBlurEW3> : &ApplyStencil<5, kBlurEW5>;
+    case BLUR_NE_SW:
+      return small ? &ApplyStencil<3, kBlurNESW3> :
+                     &ApplyStencil<5, kBlurNESW5>;
+    case BLUR_NW_SE:
+      return small ? &ApplyStencil<3, kBlurNWSE3> :
+                     &ApplyStencil<5, kBlurNWSE5>;
+    case SHARPEN:
+      return small ? &ApplyStencil<3, kSharpen3> :
+                     &ApplyStencil<5, kSharpen5>;
+    case EDGE_DETECT:
+      return small ? &ApplyStencil<3, kEdgeDetect3> :
+                     &ApplyStencil<5, kEdgeDetect5>;
+    default:
+      return small ? &ApplyStencil<3, kEmboss3> : &ApplyStencil<5, kEmboss5>;
+  }
+}
+
+int FilterKernel::KernelSize(double filter_amount) {
+  int filter_width = static_cast<int>(rint(filter_amount * 2.));
+  return (!(filter_width % 2)) ? filter_width + 1 : filter_width;
+}
+
+int FilterKernel::tap_count(void) const {
+  int taps = 0;
+  for (const TapRun& run : runs_) {
+    taps += run.length;
+  }
+  return taps;
+}
+
+std::vector<int> FilterKernel::Weights(void) const {
+  std::vector<int> weights(kernel_size_ * kernel_size_, 0);
+  int offset = kernel_size_ / 2;
+  for (const TapRun& run : runs_) {
+    int* row = &weights[(run.dy + offset) * kernel_size_];
+    std::fill(row + run.dx_begin + offset,
+              row + run.dx_begin + offset + run.length, run.weight);
+  }
+  return weights;
+}
+
+int FilterKernel::ValidWeight(int buffer_x, int buffer_y, int width,
+                              int height) const {
+  int weight = 0;
+  for (const TapRun& run : runs_) {
+    int set_y = buffer_y + run.dy;
+    if (set_y < 0 || set_y >= height) {
+      continue;
+    }
+    int x_begin = std::max(0, buffer_x + run.dx_begin);
+    int x_end = std::min(width, buffer_x + run.dx_begin + run.length);
+    weight += run.weight * std::max(0, x_end - x_begin);
+  }
+  return weight;
+}
+
+void FilterKernel::FreeKernel(void) {
+  if (kernel_size_ != 0) {
+    MemoryAccounting::RecordFree(MEMORY_FILTER,
+                                 runs_.capacity() * sizeof(TapRun));
+    runs_.clear();
+    runs_.shrink_to_fit();
+    stencil_ = nullptr;
+    kernel_size_ = 0;
+  }
 }
 
 int FilterKernel::Blur(int x, int y, int kernel_size) {
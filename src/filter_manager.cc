@@ -14,17 +14,54 @@
  ******************************************************************************/
 #include "include/filter_manager.h"
 #include <iostream>
-#include "include/filter_kernel.h"
+#include "include/image_filters.h"
 #include "include/ui_ctrl.h"
-#include "include/state_manager.h"
-#include "include/io_manager.h"
-#include "include/color_data.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static ImageFilters::DitherMethod DitherMethodFor(
+    enum UICtrl::DitherMethod method) {
+  switch (method) {
+    case UICtrl::UI_DITHER_BAYER:
+      return ImageFilters::DITHER_BAYER;
+    case UICtrl::UI_DITHER_BLUE_NOISE:
+      return ImageFilters::DITHER_BLUE_NOISE;
+    case UICtrl::UI_DITHER_FLOYD_STEINBERG:
+      return ImageFilters::DITHER_FLOYD_STEINBERG;
+    default:
+      return ImageFilters::DITHER_ATKINSON;
+  }
+}
+
+static ImageFilters::MorphologyOperation MorphologyOperationFor(
+    enum UICtrl::MorphologyOperation operation) {
+  switch (operation) {
+    case UICtrl::UI_MORPHOLOGY_ERODE:
+      return ImageFilters::MORPHOLOGY_ERODE;
+    case UICtrl::UI_MORPHOLOGY_DILATE:
+      return ImageFilters::MORPHOLOGY_DILATE;
+    case UICtrl::UI_MORPHOLOGY_OPEN:
+      return ImageFilters::MORPHOLOGY_OPEN;
+    default:
+      return ImageFilters::MORPHOLOGY_CLOSE;
+  }
+}
+
+/**
+ * @brief The blur sigma of the unsharp mask for a Sharpen amount: sigma =
+ * amount / 2, so the Gaussian's visible reach of about two sigmas matches the
+ * amount pixels the cross-shaped kernel reaches each way
+ */
+static float UnsharpSigmaFor(float amount) {
+  return amount / 2;
+}
+
 /*******************************************************************************
  * Constructors/Destructor
  ******************************************************************************/
@@ -35,10 +72,25 @@ FilterManager::FilterManager(void) :
     saturation_amount_(0.0),
     threshold_amount_(0.0),
     blur_amount_(0.0),
+    gaussian_sigma_(0.0),
     sharpen_amount_(0.0),
+    sharpen_unsharp_(0),
+    unsharp_amount_(0.0),
+    unsharp_threshold_(0.0),
     motion_blur_amount_(0.0),
     motion_blur_direction_(UICtrl::UI_DIR_E_W),
-    quantize_bins_(0) {}
+    quantize_bins_(0),
+    dither_method_(UICtrl::UI_DITHER_FLOYD_STEINBERG),
+    median_radius_(0),
+    median_percentile_(0.5),
+    morphology_operation_(UICtrl::UI_MORPHOLOGY_ERODE),
+    morphology_radius_x_(0),
+    morphology_radius_y_(0),
+    morphology_grayscale_(0),
+    bilateral_sigma_spatial_(0.0),
+    bilateral_sigma_range_(0.0),
+    preview_enabled_(1),
+    pixel_buffer_(nullptr) {}
 
 /*******************************************************************************
  * Member Functions
@@ -48,27 +100,37 @@ void FilterManager::ApplyChannel(void) {
             << channel_color_red_
             << ", green = " << channel_color_green_
             << ", blue = " << channel_color_blue_ << std::endl;
-  ApplyNonConvolutionFilter(&FilterManager::Channel);
+  ImageFilters::Channel(pixel_buffer_, channel_color_red_,
+                        channel_color_green_, channel_color_blue_);
 }
 
 void FilterManager::ApplySaturate(void) {
   std::cout << "Apply has been clicked for Saturate with amount = "
             << saturation_amount_ << std::endl;
-  ApplyNonConvolutionFilter(&FilterManager::Saturate);
+  ImageFilters::Saturate(pixel_buffer_, saturation_amount_);
 }
 
 void FilterManager::ApplyBlur(void) {
   std::cout << "Apply has been clicked for Blur with amount = "
             << blur_amount_ << std::endl;
-  kernel_.Init(blur_amount_, FilterKernel::BLUR);
-  ApplyConvolutionFilter(0.);
+  ImageFilters::Blur(pixel_buffer_, blur_amount_);
+}
+
+void FilterManager::ApplyGaussianBlur(void) {
+  std::cout << "Apply has been clicked for Gaussian Blur with sigma = "
+            << gaussian_sigma_ << std::endl;
+  ImageFilters::GaussianBlur(pixel_buffer_, gaussian_sigma_);
 }
 
 void FilterManager::ApplySharpen(void) {
   std::cout << "Apply has been clicked for Sharpen with amount = "
             << sharpen_amount_ << std::endl;
-  kernel_.Init(sharpen_amount_, FilterKernel::SHARPEN);
-  ApplyConvolutionFilter(0.);
+  if (sharpen_unsharp_) {
+    ImageFilters::UnsharpMask(pixel_buffer_, UnsharpSigmaFor(sharpen_amount_),
+                              unsharp_amount_, unsharp_threshold_);
+  } else {
+    ImageFilters::Sharpen(pixel_buffer_, sharpen_amount_);
+  }
 }
 
 void FilterManager::ApplyMotionBlur(void) {
@@ -76,48 +138,183 @@ void FilterManager::ApplyMotionBlur(void) {
             << motion_blur_amount_
             << " and direction " << motion_blur_direction_ << std::endl;
 
+  ImageFilters::MotionBlurDirection direction;
   switch (motion_blur_direction_) {
     case UICtrl::UI_DIR_N_S:
-      kernel_.Init(motion_blur_amount_, FilterKernel::BLUR_N_S);
+      direction = ImageFilters::MOTION_BLUR_N_S;
       break;
     case UICtrl::UI_DIR_E_W:
-      kernel_.Init(motion_blur_amount_, FilterKernel::BLUR_E_W);
+      direction = ImageFilters::MOTION_BLUR_E_W;
       break;
     case UICtrl::UI_DIR_NE_SW:
-      kernel_.Init(motion_blur_amount_, FilterKernel::BLUR_NE_SW);
+      direction = ImageFilters::MOTION_BLUR_NE_SW;
       break;
     default:
-      kernel_.Init(motion_blur_amount_, FilterKernel::BLUR_NW_SE);
+      direction = ImageFilters::MOTION_BLUR_NW_SE;
       break;
   }
 
-  ApplyConvolutionFilter(0.);
+  ImageFilters::MotionBlur(pixel_buffer_, motion_blur_amount_, direction);
 }
 
 void FilterManager::ApplyEdgeDetect(void) {
   std::cout << "Apply has been clicked for Edge Detect" << std::endl;
-  kernel_.Init(1.5, FilterKernel::EDGE_DETECT);
-  ApplyConvolutionFilter(0.);
+  ImageFilters::EdgeDetect(pixel_buffer_);
 }
 
 void FilterManager::ApplyQuantize(void) {
   std::cout << "Apply has been clicked for Quantize with bins = "
             << quantize_bins_ << std::endl;
-  if (quantize_bins_ > 1) {
-    ApplyNonConvolutionFilter(&FilterManager::Quantize);
-  }
+  ImageFilters::Quantize(pixel_buffer_, quantize_bins_);
+}
+
+void FilterManager::ApplyDither(void) {
+  std::cout << "Apply has been clicked for Dither with bins = "
+            << quantize_bins_ << " and method " << dither_method_
+            << std::endl;
+  ImageFilters::Dither(pixel_buffer_, quantize_bins_,
+                       DitherMethodFor(dither_method_));
 }
 
 void FilterManager::ApplyThreshold(void) {
   std::cout << "Apply Threshold has been clicked with amount ="
             << threshold_amount_ << std::endl;
-  ApplyNonConvolutionFilter(&FilterManager::Threshold);
+  ImageFilters::Threshold(pixel_buffer_, threshold_amount_);
+}
+
+void FilterManager::ApplyMedian(void) {
+  std::cout << "Apply has been clicked for Median with radius = "
+            << median_radius_ << " and percentile = " << median_percentile_
+            << std::endl;
+  ImageFilters::Median(pixel_buffer_, median_radius_, median_percentile_);
+}
+
+void FilterManager::ApplyMorphology(void) {
+  std::cout << "Apply has been clicked for Morphology with operation "
+            << morphology_operation_ << ", radius = " << morphology_radius_x_
+            << "x" << morphology_radius_y_ << " and grayscale = "
+            << morphology_grayscale_ << std::endl;
+  ImageFilters::Morphology(pixel_buffer_,
+                           MorphologyOperationFor(morphology_operation_),
+                           morphology_radius_x_, morphology_radius_y_,
+                           morphology_grayscale_ != 0);
+}
+
+void FilterManager::ApplyBilateral(void) {
+  std::cout << "Apply has been clicked for Bilateral with sigma = "
+            << bilateral_sigma_spatial_ << " and range sigma = "
+            << bilateral_sigma_range_ << std::endl;
+  ImageFilters::Bilateral(pixel_buffer_, bilateral_sigma_spatial_,
+                          bilateral_sigma_range_, 0, 0);
 }
 
 void FilterManager::ApplySpecial(void) {
   std::cout << "Apply has been clicked for Special" << std::endl;
-  kernel_.Init(1.5, FilterKernel::EMBOSS);
-  ApplyConvolutionFilter(.5);
+  ImageFilters::Special(pixel_buffer_);
+}
+
+bool FilterManager::OperationFor(int control_id,
+                                 FilterOperation* operation) const {
+  switch (control_id) {
+    case UICtrl::UI_APPLY_BLUR:
+    case UICtrl::UI_PREVIEW_BLUR:
+      operation->type = FilterOperation::BLUR;
+      operation->amount = blur_amount_;
+      break;
+    case UICtrl::UI_APPLY_GAUSSIAN_BLUR:
+    case UICtrl::UI_PREVIEW_GAUSSIAN_BLUR:
+      operation->type = FilterOperation::GAUSSIAN_BLUR;
+      operation->amount = gaussian_sigma_;
+      break;
+    case UICtrl::UI_APPLY_MOTION_BLUR:
+    case UICtrl::UI_PREVIEW_MOTION_BLUR:
+      operation->type = FilterOperation::MOTION_BLUR;
+      operation->amount = motion_blur_amount_;
+      switch (motion_blur_direction_) {
+        case UICtrl::UI_DIR_N_S:
+          operation->direction = ImageFilters::MOTION_BLUR_N_S;
+          break;
+        case UICtrl::UI_DIR_E_W:
+          operation->direction = ImageFilters::MOTION_BLUR_E_W;
+          break;
+        case UICtrl::UI_DIR_NE_SW:
+          operation->direction = ImageFilters::MOTION_BLUR_NE_SW;
+          break;
+        default:
+          operation->direction = ImageFilters::MOTION_BLUR_NW_SE;
+          break;
+      }
+      break;
+    case UICtrl::UI_APPLY_SHARP:
+    case UICtrl::UI_PREVIEW_SHARP:
+      if (sharpen_unsharp_) {
+        operation->type = FilterOperation::UNSHARP_MASK;
+        operation->amount = UnsharpSigmaFor(sharpen_amount_);
+        operation->unsharp_amount = unsharp_amount_;
+        operation->unsharp_threshold = unsharp_threshold_;
+      } else {
+        operation->type = FilterOperation::SHARPEN;
+        operation->amount = sharpen_amount_;
+      }
+      break;
+    case UICtrl::UI_APPLY_THRESHOLD:
+    case UICtrl::UI_PREVIEW_THRESHOLD:
+      operation->type = FilterOperation::THRESHOLD;
+      operation->amount = threshold_amount_;
+      break;
+    case UICtrl::UI_APPLY_SATURATE:
+    case UICtrl::UI_PREVIEW_SATURATE:
+      operation->type = FilterOperation::SATURATE;
+      operation->amount = saturation_amount_;
+      break;
+    case UICtrl::UI_APPLY_CHANNEL:
+    case UICtrl::UI_PREVIEW_CHANNEL:
+      operation->type = FilterOperation::CHANNEL;
+      operation->red = channel_color_red_;
+      operation->green = channel_color_green_;
+      operation->blue = channel_color_blue_;
+      break;
+    case UICtrl::UI_APPLY_QUANTIZE:
+    case UICtrl::UI_PREVIEW_QUANTIZE:
+      operation->type = FilterOperation::QUANTIZE;
+      operation->bins = quantize_bins_;
+      break;
+    case UICtrl::UI_APPLY_DITHER:
+    case UICtrl::UI_PREVIEW_DITHER:
+      operation->type = FilterOperation::DITHER;
+      operation->bins = quantize_bins_;
+      operation->dither = DitherMethodFor(dither_method_);
+      break;
+    case UICtrl::UI_APPLY_MEDIAN:
+    case UICtrl::UI_PREVIEW_MEDIAN:
+      operation->type = FilterOperation::MEDIAN;
+      operation->amount = median_radius_;
+      operation->percentile = median_percentile_;
+      break;
+    case UICtrl::UI_APPLY_MORPHOLOGY:
+    case UICtrl::UI_PREVIEW_MORPHOLOGY:
+      operation->type = FilterOperation::MORPHOLOGY;
+      operation->morphology = MorphologyOperationFor(morphology_operation_);
+      operation->radius_x = morphology_radius_x_;
+      operation->radius_y = morphology_radius_y_;
+      operation->grayscale = (morphology_grayscale_ != 0);
+      break;
+    case UICtrl::UI_APPLY_BILATERAL:
+    case UICtrl::UI_PREVIEW_BILATERAL:
+      operation->type = FilterOperation::BILATERAL;
+      operation->amount = bilateral_sigma_spatial_;
+      operation->range_sigma = bilateral_sigma_range_;
+      break;
+    case UICtrl::UI_APPLY_EDGE:
+      operation->type = FilterOperation::EDGE_DETECT;
+      break;
+    case UICtrl::UI_APPLY_SPECIAL_FILTER:
+      operation->type = FilterOperation::SPECIAL;
+      break;
+    default:
+      return false;
+  }
+  return true;
 }
 
 void FilterManager::InitGlui(const GLUI *const glui,
@@ -125,10 +322,15 @@ void FilterManager::InitGlui(const GLUI *const glui,
   new GLUI_Column(const_cast<GLUI*>(glui), true);
   GLUI_Panel *filter_panel = new GLUI_Panel(const_cast<GLUI*>(glui), "Filters");
   {
+    new GLUI_Checkbox(filter_panel, "Live preview", &preview_enabled_,
+                      UICtrl::UI_PREVIEW_TOGGLE, s_gluicallback);
+
     GLUI_Panel *blur_panel = new GLUI_Panel(filter_panel, "Blur");
     {
       GLUI_Spinner * blur_amount = new GLUI_Spinner(blur_panel, "Amount:",
-                                                    &blur_amount_);
+                                                    &blur_amount_,
+                                                    UICtrl::UI_PREVIEW_BLUR,
+                                                    s_gluicallback);
       blur_amount->set_int_limits(0, 20);
       blur_amount->set_int_val(5);
 
@@ -136,18 +338,32 @@ void FilterManager::InitGlui(const GLUI *const glui,
                       UICtrl::UI_APPLY_BLUR, s_gluicallback);
     }
 
+    GLUI_Panel *gaussian_panel = new GLUI_Panel(filter_panel,
+                                                "Gaussian Blur");
+    {
+      GLUI_Spinner *gaussian_sigma = new GLUI_Spinner(
+          gaussian_panel, "Sigma:", &gaussian_sigma_,
+          UICtrl::UI_PREVIEW_GAUSSIAN_BLUR, s_gluicallback);
+      gaussian_sigma->set_float_limits(0, 100);
+      gaussian_sigma->set_float_val(5);
+
+      new GLUI_Button(gaussian_panel, "Apply",
+                      UICtrl::UI_APPLY_GAUSSIAN_BLUR, s_gluicallback);
+    }
+
     GLUI_Panel *motion_blur_panel = new GLUI_Panel(filter_panel, "MotionBlur");
     {
-      GLUI_Spinner*motion_blur_amount = new GLUI_Spinner(motion_blur_panel,
-                                                         "Amount:",
-                                                         &motion_blur_amount_);
+      GLUI_Spinner*motion_blur_amount = new GLUI_Spinner(
+          motion_blur_panel, "Amount:", &motion_blur_amount_,
+          UICtrl::UI_PREVIEW_MOTION_BLUR, s_gluicallback);
       motion_blur_amount->set_int_limits(0, 100);
       motion_blur_amount->set_int_val(5);
 
       motion_blur_direction_ = UICtrl::UI_DIR_E_W;
       GLUI_RadioGroup *dir_blur = new GLUI_RadioGroup(
           motion_blur_panel,
-          reinterpret_cast<int*>(&motion_blur_direction_));
+          reinterpret_cast<int*>(&motion_blur_direction_),
+          UICtrl::UI_PREVIEW_MOTION_BLUR, s_gluicallback);
       new GLUI_RadioButton(dir_blur, "North/South");
       new GLUI_RadioButton(dir_blur, "East/West");
       new GLUI_RadioButton(dir_blur, "NorthEast/SouthWest");
@@ -160,10 +376,28 @@ void FilterManager::InitGlui(const GLUI *const glui,
     {
       GLUI_Spinner * sharp_amount = new GLUI_Spinner(sharpen_panel,
                                                      "Amount:",
-                                                     &sharpen_amount_);
+                                                     &sharpen_amount_,
+                                                     UICtrl::UI_PREVIEW_SHARP,
+                                                     s_gluicallback);
       sharp_amount->set_int_limits(0, 100);
       sharp_amount->set_int_val(5);
 
+      // An unsharp mask takes its radius from the amount
+      new GLUI_Checkbox(sharpen_panel, "Unsharp mask", &sharpen_unsharp_,
+                        UICtrl::UI_PREVIEW_SHARP, s_gluicallback);
+
+      GLUI_Spinner *unsharp_amount = new GLUI_Spinner(
+          sharpen_panel, "Strength:", &unsharp_amount_,
+          UICtrl::UI_PREVIEW_SHARP, s_gluicallback);
+      unsharp_amount->set_float_limits(0, 5);
+      unsharp_amount->set_float_val(1);
+
+      GLUI_Spinner *unsharp_threshold = new GLUI_Spinner(
+          sharpen_panel, "Threshold:", &unsharp_threshold_,
+          UICtrl::UI_PREVIEW_SHARP, s_gluicallback);
+      unsharp_threshold->set_float_limits(0, 1);
+      unsharp_threshold->set_float_val(0);
+
       new GLUI_Button(sharpen_panel, "Apply",
                       UICtrl::UI_APPLY_SHARP, s_gluicallback);
     }
@@ -175,23 +409,57 @@ void FilterManager::InitGlui(const GLUI *const glui,
     }
     GLUI_Panel *thres_panel = new GLUI_Panel(filter_panel, "Threshold");
     {
-      GLUI_Spinner *threshold_amount = new GLUI_Spinner(thres_panel,
-                                                        "Level:",
-                                                        &threshold_amount_);
+      GLUI_Spinner *threshold_amount = new GLUI_Spinner(
+          thres_panel, "Level:", &threshold_amount_,
+          UICtrl::UI_PREVIEW_THRESHOLD, s_gluicallback);
       threshold_amount->set_float_limits(0, 1);
       threshold_amount->set_float_val(0.5);
 
       new GLUI_Button(thres_panel, "Apply",
                       UICtrl::UI_APPLY_THRESHOLD, s_gluicallback);
     }
+    GLUI_Panel *median_panel = new GLUI_Panel(filter_panel, "Median");
+    {
+      GLUI_Spinner *median_radius = new GLUI_Spinner(
+          median_panel, "Radius:", &median_radius_,
+          UICtrl::UI_PREVIEW_MEDIAN, s_gluicallback);
+      median_radius->set_int_limits(0, 127);
+      median_radius->set_int_val(2);
+
+      GLUI_Spinner *median_percentile = new GLUI_Spinner(
+          median_panel, "Percentile:", &median_percentile_,
+          UICtrl::UI_PREVIEW_MEDIAN, s_gluicallback);
+      median_percentile->set_float_limits(0, 1);
+      median_percentile->set_float_val(0.5);
+
+      new GLUI_Button(median_panel, "Apply",
+                      UICtrl::UI_APPLY_MEDIAN, s_gluicallback);
+    }
+    GLUI_Panel *bilateral_panel = new GLUI_Panel(filter_panel, "Bilateral");
+    {
+      GLUI_Spinner *bilateral_sigma = new GLUI_Spinner(
+          bilateral_panel, "Sigma:", &bilateral_sigma_spatial_,
+          UICtrl::UI_PREVIEW_BILATERAL, s_gluicallback);
+      bilateral_sigma->set_float_limits(0, 200);
+      bilateral_sigma->set_float_val(8);
+
+      GLUI_Spinner *bilateral_range = new GLUI_Spinner(
+          bilateral_panel, "Range:", &bilateral_sigma_range_,
+          UICtrl::UI_PREVIEW_BILATERAL, s_gluicallback);
+      bilateral_range->set_float_limits(0.05, 1);
+      bilateral_range->set_float_val(0.1);
+
+      new GLUI_Button(bilateral_panel, "Apply",
+                      UICtrl::UI_APPLY_BILATERAL, s_gluicallback);
+    }
 
     new GLUI_Column(filter_panel, true);
 
     GLUI_Panel *satur_panel = new GLUI_Panel(filter_panel, "Saturation");
     {
-      GLUI_Spinner * saturation_amount = new GLUI_Spinner(satur_panel,
-                                                          "Amount:",
-                                                          &saturation_amount_);
+      GLUI_Spinner * saturation_amount = new GLUI_Spinner(
+          satur_panel, "Amount:", &saturation_amount_,
+          UICtrl::UI_PREVIEW_SATURATE, s_gluicallback);
       saturation_amount->set_float_limits(-10, 10);
       saturation_amount->set_float_val(1);
 
@@ -203,13 +471,17 @@ void FilterManager::InitGlui(const GLUI *const glui,
     GLUI_Panel *channel_panel = new GLUI_Panel(filter_panel, "Channels");
     {
       GLUI_Spinner *channel_red = new GLUI_Spinner(channel_panel, "Red:",
-                                                   &channel_color_red_);
-      GLUI_Spinner *channel_green = new GLUI_Spinner(channel_panel,
-                                                     "Green:",
-                                                     &channel_color_green_);
+                                                   &channel_color_red_,
+                                                   UICtrl::UI_PREVIEW_CHANNEL,
+                                                   s_gluicallback);
+      GLUI_Spinner *channel_green = new GLUI_Spinner(
+          channel_panel, "Green:", &channel_color_green_,
+          UICtrl::UI_PREVIEW_CHANNEL, s_gluicallback);
       GLUI_Spinner *channel_blue = new GLUI_Spinner(channel_panel,
                                                     "Blue:",
-                                                    &channel_color_blue_);
+                                                    &channel_color_blue_,
+                                                    UICtrl::UI_PREVIEW_CHANNEL,
+                                                    s_gluicallback);
 
       channel_red->set_float_limits(0, 10);
       channel_red->set_float_val(1);
@@ -225,8 +497,9 @@ void FilterManager::InitGlui(const GLUI *const glui,
 
     GLUI_Panel *quant_panel = new GLUI_Panel(filter_panel, "Quantize");
     {
-      GLUI_Spinner * quantize_bins = new GLUI_Spinner(quant_panel, "Bins:",
-                                                      &quantize_bins_);
+      GLUI_Spinner * quantize_bins = new GLUI_Spinner(
+          quant_panel, "Bins:", &quantize_bins_,
+          UICtrl::UI_PREVIEW_QUANTIZE, s_gluicallback);
       quantize_bins->set_int_limits(2, 256);
       quantize_bins->set_int_val(8);
       quantize_bins->set_speed(0.1);
@@ -236,6 +509,55 @@ void FilterManager::InitGlui(const GLUI *const glui,
                       s_gluicallback);
     }
 
+    // Dithers to the Quantize panel's number of bins
+    GLUI_Panel *dither_panel = new GLUI_Panel(filter_panel, "Dither");
+    {
+      dither_method_ = UICtrl::UI_DITHER_FLOYD_STEINBERG;
+      GLUI_RadioGroup *dither_method = new GLUI_RadioGroup(
+          dither_panel, reinterpret_cast<int*>(&dither_method_),
+          UICtrl::UI_PREVIEW_DITHER, s_gluicallback);
+      new GLUI_RadioButton(dither_method, "Ordered (Bayer)");
+      new GLUI_RadioButton(dither_method, "Ordered (Blue Noise)");
+      new GLUI_RadioButton(dither_method, "Floyd-Steinberg");
+      new GLUI_RadioButton(dither_method, "Atkinson");
+
+      new GLUI_Button(dither_panel, "Apply",
+                      UICtrl::UI_APPLY_DITHER,
+                      s_gluicallback);
+    }
+
+    GLUI_Panel *morphology_panel = new GLUI_Panel(filter_panel,
+                                                  "Morphology");
+    {
+      morphology_operation_ = UICtrl::UI_MORPHOLOGY_ERODE;
+      GLUI_RadioGroup *morphology_operation = new GLUI_RadioGroup(
+          morphology_panel, reinterpret_cast<int*>(&morphology_operation_),
+          UICtrl::UI_PREVIEW_MORPHOLOGY, s_gluicallback);
+      new GLUI_RadioButton(morphology_operation, "Erode");
+      new GLUI_RadioButton(morphology_operation, "Dilate");
+      new GLUI_RadioButton(morphology_operation, "Open");
+      new GLUI_RadioButton(morphology_operation, "Close");
+
+      GLUI_Spinner *radius_x = new GLUI_Spinner(
+          morphology_panel, "Radius X:", &morphology_radius_x_,
+          UICtrl::UI_PREVIEW_MORPHOLOGY, s_gluicallback);
+      radius_x->set_int_limits(0, 500);
+      radius_x->set_int_val(2);
+      GLUI_Spinner *radius_y = new GLUI_Spinner(
+          morphology_panel, "Radius Y:", &morphology_radius_y_,
+          UICtrl::UI_PREVIEW_MORPHOLOGY, s_gluicallback);
+      radius_y->set_int_limits(0, 500);
+      radius_y->set_int_val(2);
+
+      new GLUI_Checkbox(morphology_panel, "Grayscale",
+                        &morphology_grayscale_,
+                        UICtrl::UI_PREVIEW_MORPHOLOGY, s_gluicallback);
+
+      new GLUI_Button(morphology_panel, "Apply",
+                      UICtrl::UI_APPLY_MORPHOLOGY,
+                      s_gluicallback);
+    }
+
     // YOUR SPECIAL FILTER PANEL
     GLUI_Panel *specialFilterPanel = new GLUI_Panel(filter_panel,
                                                     "Special Filter");
@@ -248,111 +570,4 @@ void FilterManager::InitGlui(const GLUI *const glui,
   }
 } /* FilterManager::InitGlui() */
 
-void FilterManager::ApplyConvolutionFilter(float bias) {
-  int image_width = pixel_buffer_->width();
-  int image_height = pixel_buffer_->height();
-
-  PixelBuffer* buffer_copy = pixel_buffer_->Copy();
-
-  for (int buffer_y = 0; buffer_y < image_height; buffer_y++) {
-      for (int buffer_x = 0; buffer_x < image_width; buffer_x++) {
-          pixel_buffer_->set_valid_pixel(
-            buffer_x, buffer_y, kernel_.Apply(
-              buffer_copy, buffer_x, buffer_y, bias));
-    }
-  }
-
-  delete buffer_copy;
-}
-
-void FilterManager::ApplyNonConvolutionFilter(
-        ColorData (FilterManager::* non_convolution_function)(int x, int y)
-) {
-  int image_width = pixel_buffer_->width();
-  int image_height = pixel_buffer_->height();
-
-  for (int buffer_y = 0; buffer_y < image_height; buffer_y++) {
-    for (int buffer_x = 0; buffer_x < image_width; buffer_x++) {
-      pixel_buffer_->set_valid_pixel(
-        buffer_x, buffer_y, (this->*non_convolution_function)(
-          buffer_x, buffer_y));
-    }
-  }
-}
-
-ColorData FilterManager::Threshold(int x, int y) {
-  ColorData current_color = pixel_buffer_->get_pixel(x, y);
-  float r, g, b, a;
-  r = (current_color.red() >= threshold_amount_) ? 1. : 0.;
-  g = (current_color.green() >= threshold_amount_) ? 1. : 0.;
-  b = (current_color.blue() >= threshold_amount_) ? 1. : 0.;
-  a = current_color.alpha();
-
-  return ColorData(r, g, b, a);
-}
-
-ColorData FilterManager::Saturate(int x, int y) {
-  ColorData current_color = pixel_buffer_->get_pixel(x, y);
-  float r, g, b, a;
-  if (saturation_amount_ < 0.) {
-    r = 1 - current_color.red();
-    g = 1 - current_color.green();
-    b = 1 - current_color.blue();
-    a = current_color.alpha();
-  } else {
-    r = current_color.red();
-    g = current_color.green();
-    b = current_color.blue();
-    a = current_color.alpha();
-  }
-
-  float saturation_mag = fabs(saturation_amount_);
-  float gray_value = 0.2989 * r + 0.5870 * g + 0.1140 * b;
-  ColorData gray_color = ColorData(gray_value, gray_value, gray_value);
-  ColorData gray_contribution = gray_color * (1 - saturation_mag);
-
-  ColorData color_contribution = ColorData(r, g, b) * saturation_mag;
-  ColorData new_color = (
-    color_contribution + gray_contribution).clamped_color();
-
-  return new_color;
-}
-
-ColorData FilterManager::Channel(int x, int y) {
-  ColorData current_color = pixel_buffer_->get_pixel(x, y);
-  float r, g, b, a;
-  r = current_color.red();
-  g = current_color.green();
-  b = current_color.blue();
-  a = current_color.alpha();
-
-  return (ColorData(r * channel_color_red_,
-                    g * channel_color_green_,
-                    b * channel_color_blue_,
-                    a)).clamped_color();
-}
-
-ColorData FilterManager::Quantize(int x, int y) {
-  ColorData current_color = pixel_buffer_->get_pixel(x, y);
-  float r, g, b, a;
-  r = current_color.red();
-  g = current_color.green();
-  b = current_color.blue();
-  a = current_color.alpha();
-
-  int one_less_bin = quantize_bins_ - 1;
-
-  int r_bin = rint(r * one_less_bin);
-  int g_bin = rint(g * one_less_bin);
-  int b_bin = rint(b * one_less_bin);
-
-  float quantize_factor = 1. / one_less_bin;
-
-  float new_r = r_bin * quantize_factor;
-  float new_g = g_bin * quantize_factor;
-  float new_b = b_bin * quantize_factor;
-
-  return ColorData(new_r, new_g, new_b, a);
-}
-
 }  /* namespace image_tools */
@@ -0,0 +1,169 @@
+/*******************************************************************************
+ * Name            : filter_preview.cc
+ * Project         : FlashPhoto
+ * Module          : filter_preview
+ * Description     : Implementation of the FilterPreview class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/filter_preview.h"
+#include <algorithm>
+#include <chrono>
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int FilterPreview::kBandRows;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/**
+ * @brief Copy a rectangle of one image into the top left of another
+ */
+static void CopyRegion(const PixelBuffer& source, int x, int y, int width,
+                       int height, PixelBuffer* target) {
+  for (int row = 0; row < height; row++) {
+    const ColorData* from = source.row(y + row) + x;
+    std::copy(from, from + width, target->row(row));
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+FilterPreview::FilterPreview(void) : render_task_(), rendering_(false),
+                                     progress_(), done_(false),
+                                     pending_source_(nullptr),
+                                     pending_result_(nullptr), pending_x_(0),
+                                     pending_y_(0), pending_scale_(1),
+                                     pending_ms_(0.0), result_(nullptr),
+                                     x_(0), y_(0), scale_(1),
+                                     render_ms_(0.0) {}
+
+FilterPreview::~FilterPreview(void) {
+  Cancel();
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void FilterPreview::Start(const PixelBuffer& source, int x, int y, int width,
+                          int height, int scale,
+                          const FilterOperation& operation) {
+  TRACE_SCOPE("FilterPreview::Start", "filter");
+  // The previous result stays up until this one replaces it.
+  StopRender();
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  FilterOperation scaled = operation.Scaled(scale);
+  int border = scaled.halo();
+  int source_x = std::max(0, x - border);
+  int source_y = std::max(0, y - border);
+  int source_width = std::min(source.width(), x + width + border) - source_x;
+  int source_height = std::min(source.height(), y + height + border) -
+                      source_y;
+
+  pending_source_ = new PixelBuffer(source_width, source_height, ColorData());
+  CopyRegion(source, source_x, source_y, source_width, source_height,
+             pending_source_);
+  pending_result_ = new PixelBuffer(width, height, ColorData());
+  pending_x_ = x;
+  pending_y_ = y;
+  pending_scale_ = scale;
+
+  progress_.Reset(height);
+  done_.store(false);
+  rendering_ = true;
+  int border_x = x - source_x;
+  int border_y = y - source_y;
+  render_task_.Run([this, scaled, border_x, border_y, width, height]() {
+    Render(scaled, border_x, border_y, width, height);
+  }, TASK_PRIORITY_INTERACTIVE);
+}
+
+void FilterPreview::Render(FilterOperation operation, int border_x,
+                           int border_y, int width, int height) {
+  TRACE_SCOPE("FilterPreview::Render", "filter");
+  auto start = std::chrono::steady_clock::now();
+  const PixelBuffer& source = *pending_source_;
+  int border = operation.halo();
+
+  for (int band_y = 0; band_y < height; band_y += kBandRows) {
+    if (progress_.cancel_requested()) {
+      return;
+    }
+    int band_height = std::min(kBandRows, height - band_y);
+    int region_y = std::max(0, border_y + band_y - border);
+    int region_height = std::min(source.height(), border_y + band_y +
+                                 band_height + border) - region_y;
+
+    // Scratch bands come from the pixel pool, so this does not allocate
+    PixelBuffer band(source.width(), region_height, ColorData());
+    CopyRegion(source, 0, region_y, source.width(), region_height, &band);
+    operation.Apply(&band, 0, region_y);
+    for (int row = 0; row < band_height; row++) {
+      const ColorData* from = band.row(border_y + band_y + row - region_y) +
+                              border_x;
+      std::copy(from, from + width, pending_result_->row(band_y + row));
+      progress_.AdvanceRow();
+    }
+  }
+
+  pending_ms_ = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  done_.store(true);
+}
+
+bool FilterPreview::Poll(void) {
+  if (!rendering_ || !done_.load()) {
+    return false;
+  }
+  render_task_.Wait();
+  rendering_ = false;
+
+  delete result_;
+  result_ = pending_result_;
+  x_ = pending_x_;
+  y_ = pending_y_;
+  scale_ = pending_scale_;
+  render_ms_ = pending_ms_;
+  pending_result_ = nullptr;
+  delete pending_source_;
+  pending_source_ = nullptr;
+  return true;
+}
+
+void FilterPreview::StopRender(void) {
+  if (rendering_) {
+    progress_.RequestCancel();
+    render_task_.Wait();
+    rendering_ = false;
+  }
+  delete pending_source_;
+  delete pending_result_;
+  pending_source_ = nullptr;
+  pending_result_ = nullptr;
+}
+
+void FilterPreview::Cancel(void) {
+  StopRender();
+  delete result_;
+  result_ = nullptr;
+}
+
+}  /* namespace image_tools */
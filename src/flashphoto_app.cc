@@ -13,24 +13,58 @@
  * Includes
  ******************************************************************************/
 #include "include/flashphoto_app.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include "include/color_data.h"
 #include "include/pixel_buffer.h"
+#include "include/pixel_pool.h"
 #include "include/ui_ctrl.h"
 #include "include/state_manager.h"
 #include "include/filter_manager.h"
 #include "include/io_manager.h"
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** How often a background image load/save is polled for completion */
+const int kAsyncIOPollIntervalMs = 50;
+
+/** Where the trace is written if FLASHPHOTO_TRACE does not name a file */
+const char kDefaultTraceFile[] = "flashphoto_trace.json";
+
+/** The largest window a loaded canvas resizes the window to */
+const int kMaxWindowWidth = 1280;
+const int kMaxWindowHeight = 960;
+
+/** How often a filter preview being rendered is polled for completion */
+const int kPreviewPollIntervalMs = 15;
+
+/**
+ * Convolution filters on canvases of at least this many pixels are applied
+ * progressively
+ */
+const int kProgressiveFilterPixels = 1 << 20;
+
+/** Zoom factor of one press of + or - */
+const double kZoomStep = 2.0;
+
+/** Fraction of the window one press of an arrow key pans by */
+const int kPanDivisor = 4;
+
 /*******************************************************************************
  * Constructors/Destructor
  ******************************************************************************/
 FlashPhotoApp::FlashPhotoApp(int width, int height) : BaseGfxApp(width, height),
+                                                      scheduler_(),
                                                       filter_manager_(),
                                                       io_manager_(),
                                                       state_manager_(),
@@ -40,7 +74,20 @@ FlashPhotoApp::FlashPhotoApp(int width, int height) : BaseGfxApp(width, height),
                                                       cur_color_red_(0.0),
                                                       cur_color_green_(0.0),
                                                       cur_color_blue_(0.0),
-                                                      toolbelt_(nullptr) {}
+                                                      toolbelt_(nullptr),
+                                                      trace_file_(
+                                                        kDefaultTraceFile),
+                                                      progressive_(),
+                                                      progressive_name_(""),
+                                                      progressive_tiles_drawn_(
+                                                        0),
+                                                      hud_(),
+                                                      pyramid_(),
+                                                      viewport_(),
+                                                      preview_(),
+                                                      preview_control_(-1) {
+  TaskScheduler::set_instance(&scheduler_);
+}
 
 /*******************************************************************************
  * Member Functions
@@ -61,6 +108,13 @@ void FlashPhotoApp::Init(
   // Set the name of the window
   set_caption("FlashPhoto");
 
+  // Trace from startup if asked to; the trace is written when toggled off.
+  const char* trace_file = getenv("FLASHPHOTO_TRACE");
+  if (trace_file && *trace_file) {
+    trace_file_ = trace_file;
+    Tracer::set_enabled(true);
+  }
+
   // Initialize Interface
   InitializeBuffers(background_color, width(), height());
 
@@ -74,13 +128,126 @@ void FlashPhotoApp::Init(
                                cur_color_blue_));
 
   state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+
+  pyramid_.Reset(display_buffer_);
+  viewport_.set_canvas_size(display_buffer_->width(),
+                            display_buffer_->height());
+  viewport_.set_window_size(width(), height());
+  viewport_.FitToWindow();
 }
 
 void FlashPhotoApp::Display(void) {
-  DrawPixels(0, 0, width(), height(), display_buffer_->data());
+  // The window may have been resized since the last frame.
+  glViewport(0, 0, width(), height());
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  gluOrtho2D(0, width(), 0, height());
+  glMatrixMode(GL_MODELVIEW);
+
+  // Draw only the visible part of the level closest to the zoom, so a
+  // zoomed-out view of a large canvas uploads little more than the window.
+  pyramid_.Update();
+  int level, x_begin, y_begin, x_end, y_end;
+  VisibleLevelRegion(&level, &x_begin, &y_begin, &x_end, &y_end);
+  size_t drawn_bytes = DrawScaled(*pyramid_.level(level), 0, 0, 1 << level,
+                                  x_begin, y_begin, x_end, y_end);
+
+  // Then the finished tiles of a progressive filter, coarsest first, leaving
+  // out passes finer than the level drawn.
+  if (progressive_.running()) {
+    int tiles_done = progressive_.tiles_done();
+    for (int i = 0; i < tiles_done; i++) {
+      const ProgressiveFilter::Tile& tile = progressive_.tile(i);
+      int scale = progressive_.pass_scale(tile.pass);
+      int level_scale = 1 << level;
+      bool visible = (tile.x + tile.width) * scale > x_begin * level_scale &&
+                     tile.x * scale < x_end * level_scale &&
+                     (tile.y + tile.height) * scale > y_begin * level_scale &&
+                     tile.y * scale < y_end * level_scale;
+      if (scale < level_scale || !visible) {
+        continue;
+      }
+      drawn_bytes += DrawScaled(*progressive_.pass_result(tile.pass), 0, 0,
+                                scale, tile.x, tile.y, tile.x + tile.width,
+                                tile.y + tile.height);
+    }
+    progressive_tiles_drawn_ = tiles_done;
+  }
+
+  const PixelBuffer* preview = preview_.result();
+  if (preview) {
+    drawn_bytes += DrawScaled(*preview, preview_.x(), preview_.y(),
+                              preview_.scale(), 0, 0, preview->width(),
+                              preview->height());
+  }
+  hud_.RecordView(viewport_.zoom(), level, drawn_bytes);
+  hud_.RecordWorkers(scheduler_);
+
+  if (hud_.visible()) {
+    size_t canvas_bytes = sizeof(ColorData) *
+                          display_buffer_->width() * display_buffer_->height();
+    hud_.Draw(height(), canvas_bytes, state_manager_.undo_depth(),
+              state_manager_.redo_depth(), state_manager_.evicted_states());
+  }
+}
+
+void FlashPhotoApp::VisibleLevelRegion(int* level, int* x_begin,
+                                       int* y_begin, int* x_end,
+                                       int* y_end) const {
+  *level = pyramid_.LevelForScale(viewport_.zoom());
+  const PixelBuffer* image = pyramid_.level(*level);
+  int scale = 1 << *level;
+  viewport_.VisibleRegion(x_begin, y_begin, x_end, y_end);
+  *x_begin /= scale;
+  *y_begin /= scale;
+  *x_end = std::min(image->width(), (*x_end + scale - 1) / scale);
+  *y_end = std::min(image->height(), (*y_end + scale - 1) / scale);
+}
+
+size_t FlashPhotoApp::DrawScaled(const PixelBuffer& image, int origin_x,
+                                 int origin_y, int scale, int x_begin,
+                                 int y_begin, int x_end, int y_end) {
+  if (x_begin >= x_end || y_begin >= y_end) {
+    return 0;
+  }
+  DrawPixelRegion(
+    viewport_.CanvasToWindowX((origin_x + x_begin) * scale),
+    height() - viewport_.CanvasToWindowY((origin_y + y_end) * scale),
+    viewport_.zoom() * scale, image.width(), x_begin, image.height() - y_end,
+    x_end - x_begin, y_end - y_begin, image.data());
+  return sizeof(ColorData) * (x_end - x_begin) * (y_end - y_begin);
+}
+
+void FlashPhotoApp::StartPreview(int control_id) {
+  FilterOperation operation;
+  if (!filter_manager_.preview_enabled() ||
+      !filter_manager_.OperationFor(control_id, &operation)) {
+    return;
+  }
+  preview_control_ = control_id;
+
+  pyramid_.Update();
+  int level, x_begin, y_begin, x_end, y_end;
+  VisibleLevelRegion(&level, &x_begin, &y_begin, &x_end, &y_end);
+  preview_.Start(*pyramid_.level(level), x_begin, y_begin, x_end - x_begin,
+                 y_end - y_begin, 1 << level, operation);
+  ScheduleUpdate(kPreviewPollIntervalMs);
+}
+
+void FlashPhotoApp::CancelPreview(void) {
+  preview_.Cancel();
+  preview_control_ = -1;
+}
+
+void FlashPhotoApp::RenderOneFrame(void) {
+  hud_.BeginFrame();
+  BaseGfxApp::RenderOneFrame();
+  hud_.EndFrame();
 }
 
 FlashPhotoApp::~FlashPhotoApp(void) {
+  CancelPreview();
+  CancelProgressiveFilter();
   if (display_buffer_) {
     delete display_buffer_;
     delete toolbelt_;
@@ -89,22 +256,85 @@ FlashPhotoApp::~FlashPhotoApp(void) {
 
 void FlashPhotoApp::set_pixel_buffer(
   PixelBuffer *new_pixel_buffer, bool reset_canvas_state) {
+  // Background work still reads the old canvas, so stop it before freeing it
+  CancelPreview();
+  CancelProgressiveFilter();
+
+  PixelBuffer *old_pixel_buffer = display_buffer_;
   display_buffer_ = new_pixel_buffer;
   toolbelt_->set_pixel_buffer(display_buffer_);
   filter_manager_.set_pixel_buffer(display_buffer_);
 
-  BaseGfxApp::SetWindowDimensions(
-    display_buffer_->width(), display_buffer_->height());
+  if (old_pixel_buffer != new_pixel_buffer) {
+    delete old_pixel_buffer;
+  }
+
+  pyramid_.Reset(display_buffer_);
+  FitWindowToCanvas();
 
   if (reset_canvas_state) {
     state_manager_.ClearUndoAndRedoStacks();
   }
+  // Release the old canvas's size classes now nothing of that size is held
+  PixelPool::Trim();
 
   state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
 }
 
+void FlashPhotoApp::Update(int delta_time_ms) {
+  switch (io_manager_.PollAsyncOperation()) {
+    case IOManager::ASYNC_RUNNING:
+      ScheduleUpdate(kAsyncIOPollIntervalMs);
+      break;
+    case IOManager::ASYNC_LOAD_FINISHED:
+      // Only swap the canvas once the whole image has been decoded.
+      set_pixel_buffer(io_manager_.GetLoadedPixelBuffer(), true);
+      glutPostRedisplay();
+      break;
+    case IOManager::ASYNC_SAVE_FINISHED:
+      // Reload the current directory:
+      io_manager_.file_browser()->fbreaddir(".");
+      break;
+    default:
+      break;
+  }
+
+  if (progressive_.finished()) {
+    FinishProgressiveFilter();
+  } else if (progressive_.running()) {
+    if (progressive_.tiles_done() != progressive_tiles_drawn_) {
+      glutPostRedisplay();
+    }
+    ScheduleUpdate(kPreviewPollIntervalMs);
+  }
+
+  if (preview_.running()) {
+    if (preview_.Poll()) {
+      const PixelBuffer* preview = preview_.result();
+      hud_.RecordFilter("Preview", preview_.render_ms(),
+                        preview->width() * 1e-6 * preview->height());
+      glutPostRedisplay();
+    } else {
+      ScheduleUpdate(kPreviewPollIntervalMs);
+    }
+  }
+}
+
+void FlashPhotoApp::FitWindowToCanvas(void) {
+  int window_width = std::min(display_buffer_->width(), kMaxWindowWidth);
+  int window_height = std::min(display_buffer_->height(), kMaxWindowHeight);
+  BaseGfxApp::SetWindowDimensions(window_width, window_height);
+  viewport_.set_canvas_size(display_buffer_->width(),
+                            display_buffer_->height());
+  viewport_.set_window_size(window_width, window_height);
+  viewport_.FitToWindow();
+}
+
 void FlashPhotoApp::DrawPixel(int x, int y) {
-  toolbelt_->get_active_tool()->ApplyClick(x, y);
+  Tool* tool = toolbelt_->get_active_tool();
+  tool->ApplyClick(x, y);
+  int size = tool->mask_size();
+  pyramid_.MarkDirty(x - size / 2, y - size / 2, size, size);
   last_draw_location_ = {x, y};
 }
 
@@ -178,19 +408,158 @@ void FlashPhotoApp::InterpolateToPoint(int destination_x, int destination_y) {
 }
 
 void FlashPhotoApp::MouseDragged(int x, int y) {
-  InterpolateToPoint(x, y);
+  TRACE_SCOPE("FlashPhotoApp::MouseDragged", "tool");
+  hud_.MarkInput();
+  int canvas_x, canvas_y;
+  viewport_.WindowToCanvas(x, y, &canvas_x, &canvas_y);
+  InterpolateToPoint(canvas_x, canvas_y);
 }
 
 void FlashPhotoApp::MouseMoved(int x, int y) {}
 
 void FlashPhotoApp::LeftMouseDown(int x, int y) {
-  DrawPixel(x, y);
+  TRACE_SCOPE("FlashPhotoApp::LeftMouseDown", "tool");
+  hud_.MarkInput();
+  CancelPreview();
+  CancelProgressiveFilter();
+  int canvas_x, canvas_y;
+  viewport_.WindowToCanvas(x, y, &canvas_x, &canvas_y);
+  DrawPixel(canvas_x, canvas_y);
 }
 
 void FlashPhotoApp::LeftMouseUp(int x, int y) {
+  TRACE_SCOPE("FlashPhotoApp::LeftMouseUp", "undo");
   state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
 }
 
+void FlashPhotoApp::Keyboard(unsigned char c, int x, int y) {
+  switch (c) {
+    case 'h':
+    case 'H':
+      hud_.toggle_visible();
+      return;
+    case 't':
+    case 'T':
+      ToggleTracing();
+      return;
+    case '+':
+    case '=':
+      viewport_.ZoomAt(viewport_.zoom() * kZoomStep, x, y);
+      break;
+    case '-':
+    case '_':
+      viewport_.ZoomAt(viewport_.zoom() / kZoomStep, x, y);
+      break;
+    case '0':
+      viewport_.FitToWindow();
+      break;
+    case '1':
+      viewport_.ZoomAt(1.0, x, y);
+      break;
+    default:
+      return;
+  }
+  // The preview covers only what was visible.
+  if (preview_control_ >= 0) {
+    StartPreview(preview_control_);
+  }
+}
+
+void FlashPhotoApp::KeyboardSpecial(int key, int x, int y) {
+  int pan_x = width() / kPanDivisor;
+  int pan_y = height() / kPanDivisor;
+  switch (key) {
+    case GLUT_KEY_LEFT:
+      viewport_.Pan(-pan_x, 0);
+      break;
+    case GLUT_KEY_RIGHT:
+      viewport_.Pan(pan_x, 0);
+      break;
+    case GLUT_KEY_UP:
+      viewport_.Pan(0, -pan_y);
+      break;
+    case GLUT_KEY_DOWN:
+      viewport_.Pan(0, pan_y);
+      break;
+    default:
+      return;
+  }
+  if (preview_control_ >= 0) {
+    StartPreview(preview_control_);
+  }
+}
+
+void FlashPhotoApp::ApplyFilter(int control_id,
+                                void (FilterManager::*apply)(void),
+                                const char* name) {
+  auto start = std::chrono::steady_clock::now();
+  // The preview is replaced by the full-size result.
+  CancelPreview();
+  CancelProgressiveFilter();
+
+  FilterOperation operation;
+  if (filter_manager_.OperationFor(control_id, &operation) &&
+      operation.halo() > 0 && display_buffer_->width() *
+      display_buffer_->height() >= kProgressiveFilterPixels) {
+    int center_x, center_y;
+    viewport_.WindowToCanvas(width() / 2, height() / 2, &center_x,
+                             &center_y);
+    std::cout << "Applying " << name << " progressively" << std::endl;
+    progressive_name_ = name;
+    progressive_tiles_drawn_ = 0;
+    progressive_.Start(display_buffer_, operation, center_x, center_y);
+    ScheduleUpdate(kPreviewPollIntervalMs);
+    return;
+  }
+
+  (filter_manager_.*apply)();
+  pyramid_.MarkAllDirty();
+  double milliseconds = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  hud_.RecordFilter(name, milliseconds, display_buffer_->width() * 1e-6 *
+                    display_buffer_->height());
+
+  state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+}
+
+void FlashPhotoApp::FinishProgressiveFilter(void) {
+  TRACE_SCOPE("FlashPhotoApp::FinishProgressiveFilter", "filter");
+  double milliseconds = progressive_.elapsed_ms();
+  PixelBuffer* result = progressive_.TakeResult();
+  display_buffer_->SetAllPixels(result->data());
+  delete result;
+  pyramid_.MarkAllDirty();
+  hud_.RecordFilter(progressive_name_, milliseconds,
+                    display_buffer_->width() * 1e-6 *
+                    display_buffer_->height());
+  state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+  glutPostRedisplay();
+}
+
+void FlashPhotoApp::CancelProgressiveFilter(void) {
+  if (progressive_.running()) {
+    progressive_.Cancel();
+    std::cout << progressive_name_ << " cancelled" << std::endl;
+  }
+}
+
+void FlashPhotoApp::ToggleTracing(void) {
+  if (!Tracer::enabled()) {
+    Tracer::Clear();
+    Tracer::set_enabled(true);
+    std::cout << "Tracing started; press T again to write " << trace_file_
+              << std::endl;
+    return;
+  }
+  Tracer::set_enabled(false);
+  if (Tracer::WriteChromeTrace(trace_file_)) {
+    std::cout << "Wrote trace to " << trace_file_
+              << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+  } else {
+    std::cerr << "Could not write trace to " << trace_file_ << std::endl;
+  }
+}
+
 void FlashPhotoApp::InitializeBuffers(ColorData background_color,
                                       int width, int height) {
   display_buffer_ = new PixelBuffer(width, height, background_color);
@@ -274,6 +643,8 @@ void FlashPhotoApp::InitGlui(void) {
 }
 
 void FlashPhotoApp::GluiControl(int control_id) {
+  TRACE_SCOPE_ARG("FlashPhotoApp::GluiControl", "ui", "control_id",
+                  control_id);
   switch (control_id) {
     case UICtrl::UI_PRESET_RED:
       cur_color_red_ = 1;
@@ -324,69 +695,101 @@ void FlashPhotoApp::GluiControl(int control_id) {
       update_colors();
       break;
     case UICtrl::UI_APPLY_BLUR:
-      filter_manager_.ApplyBlur();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyBlur, "Blur");
+      break;
+    case UICtrl::UI_APPLY_GAUSSIAN_BLUR:
+      ApplyFilter(control_id, &FilterManager::ApplyGaussianBlur,
+                  "Gaussian Blur");
       break;
     case UICtrl::UI_APPLY_SHARP:
-      filter_manager_.ApplySharpen();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplySharpen, "Sharpen");
       break;
     case UICtrl::UI_APPLY_MOTION_BLUR:
-      filter_manager_.ApplyMotionBlur();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyMotionBlur,
+                  "Motion Blur");
       break;
     case UICtrl::UI_APPLY_EDGE:
-      filter_manager_.ApplyEdgeDetect();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyEdgeDetect, "Edge Detect");
       break;
     case UICtrl::UI_APPLY_THRESHOLD:
-      filter_manager_.ApplyThreshold();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyThreshold, "Threshold");
       break;
     case UICtrl::UI_APPLY_DITHER:
-      filter_manager_.ApplyThreshold();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyDither, "Dither");
       break;
     case UICtrl::UI_APPLY_SATURATE:
-      filter_manager_.ApplySaturate();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplySaturate, "Saturate");
       break;
     case UICtrl::UI_APPLY_CHANNEL:
-      filter_manager_.ApplyChannel();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyChannel, "Channels");
       break;
     case UICtrl::UI_APPLY_QUANTIZE:
-      filter_manager_.ApplyQuantize();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplyQuantize, "Quantize");
+      break;
+    case UICtrl::UI_APPLY_MEDIAN:
+      ApplyFilter(control_id, &FilterManager::ApplyMedian, "Median");
+      break;
+    case UICtrl::UI_APPLY_MORPHOLOGY:
+      ApplyFilter(control_id, &FilterManager::ApplyMorphology, "Morphology");
+      break;
+    case UICtrl::UI_APPLY_BILATERAL:
+      ApplyFilter(control_id, &FilterManager::ApplyBilateral, "Bilateral");
       break;
     case UICtrl::UI_APPLY_SPECIAL_FILTER:
-      filter_manager_.ApplySpecial();
-      state_manager_.RegisterNewCanvasState(display_buffer_->GetAllPixels());
+      ApplyFilter(control_id, &FilterManager::ApplySpecial, "Emboss");
+      break;
+    case UICtrl::UI_PREVIEW_TOGGLE:
+      if (!filter_manager_.preview_enabled()) {
+        CancelPreview();
+      }
+      break;
+    case UICtrl::UI_PREVIEW_BLUR:
+    case UICtrl::UI_PREVIEW_GAUSSIAN_BLUR:
+    case UICtrl::UI_PREVIEW_MOTION_BLUR:
+    case UICtrl::UI_PREVIEW_SHARP:
+    case UICtrl::UI_PREVIEW_THRESHOLD:
+    case UICtrl::UI_PREVIEW_SATURATE:
+    case UICtrl::UI_PREVIEW_CHANNEL:
+    case UICtrl::UI_PREVIEW_QUANTIZE:
+    case UICtrl::UI_PREVIEW_DITHER:
+    case UICtrl::UI_PREVIEW_MEDIAN:
+    case UICtrl::UI_PREVIEW_MORPHOLOGY:
+    case UICtrl::UI_PREVIEW_BILATERAL:
+      StartPreview(control_id);
       break;
     case UICtrl::UI_FILE_BROWSER:
       io_manager_.set_image_file(io_manager_.file_browser()->get_file());
       break;
     case UICtrl::UI_LOAD_CANVAS_BUTTON:
-      if (io_manager_.LoadImageToCanvas()) {
-        set_pixel_buffer(io_manager_.GetLoadedPixelBuffer(), true);
+      if (io_manager_.LoadImageToCanvasAsync()) {
+        ScheduleUpdate(kAsyncIOPollIntervalMs);
       }
       break;
     case UICtrl::UI_LOAD_STAMP_BUTTON:
       io_manager_.LoadImageToStamp(toolbelt_->get_buffer_stamper());
       break;
     case UICtrl::UI_SAVE_CANVAS_BUTTON:
-      io_manager_.SaveCanvasToFile(display_buffer_);
-      // Reload the current directory:
-      io_manager_.file_browser()->fbreaddir(".");
+      if (io_manager_.SaveCanvasToFileAsync(display_buffer_)) {
+        ScheduleUpdate(kAsyncIOPollIntervalMs);
+      }
+      break;
+    case UICtrl::UI_CANCEL_IO_BUTTON:
+      io_manager_.CancelAsyncOperation();
       break;
     case UICtrl::UI_FILE_NAME:
       io_manager_.set_image_file(io_manager_.file_name());
       break;
     case UICtrl::UI_UNDO:
+      CancelPreview();
+      CancelProgressiveFilter();
       display_buffer_->SetAllPixels(state_manager_.UndoOperation());
+      pyramid_.MarkAllDirty();
       break;
     case UICtrl::UI_REDO:
+      CancelPreview();
+      CancelProgressiveFilter();
       display_buffer_->SetAllPixels(state_manager_.RedoOperation());
+      pyramid_.MarkAllDirty();
       break;
     default:
       break;
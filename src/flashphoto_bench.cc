@@ -0,0 +1,892 @@
+/*******************************************************************************
+ * Name            : flashphoto_bench.cc
+ * Project         : FlashPhoto
+ * Module          : bench
+ * Description     : Benchmark suite for the image processing core
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "include/batch_processor.h"
+#include "include/canvas_history.h"
+#include "include/color_data.h"
+#include "include/encode_settings.h"
+#include "include/image_codec.h"
+#include "include/memory_accounting.h"
+#include "include/pixel_buffer.h"
+#include "include/pixel_pool.h"
+#include "include/stamper.h"
+#include "include/task_scheduler.h"
+#include "include/tool.h"
+#include "include/toolbelt.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+using image_tools::CanvasHistory;
+using image_tools::ColorData;
+using image_tools::EncodeProfile;
+using image_tools::FilterOperation;
+using image_tools::ImageCodec;
+using image_tools::JpegEncodeSettings;
+using image_tools::PixelAllocationPolicy;
+using image_tools::PixelBuffer;
+using image_tools::PixelPool;
+using image_tools::PngEncodeSettings;
+using image_tools::Stamper;
+using image_tools::TaskScheduler;
+using image_tools::Tool;
+using image_tools::ToolBelt;
+using image_tools::WorkerStats;
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/* The filters measured, in the same syntax as FlashPhotoCLI's --filter */
+static const char* kFilterSpecs[] = {
+  "blur:2", "blur:8", "gaussian:2", "gaussian:64", "sharpen:2", "sharpen:8",
+  "unsharp:2:1", "unsharp:16:1",
+  "motionblur:5:ew", "motionblur:5:nesw", "edgedetect", "threshold:0.5", "saturate:0.5",
+  "saturate:-1", "channel:1.2,1,0.8", "quantize:8",
+  "dither:4:bayer", "dither:4:bluenoise", "dither:4:floyd", "dither:4:atkinson",
+  "median:2", "median:16", "erode:2", "close:32,8",
+  "bilateral:4:0.1", "bilateral:32:0.1", "special"
+};
+
+/* The tools measured, by their index in the ToolBelt */
+static const struct {
+  int index;
+  const char* name;
+} kTools[] = {
+  {0, "pen"}, {1, "eraser"}, {2, "spray_can"}, {3, "calligraphy_pen"},
+  {4, "highlighter"}, {5, "stamp"}, {6, "blur"}, {7, "stamper"}
+};
+
+static const int kStrokeLength = 256;
+static const int kStampSize = 64;
+static const int kHistoryDepth = 8;
+
+/* States the history's budget holds while it evicts, and states registered */
+static const int kEvictionBudgetStates = 3;
+static const int kEvictionRounds = 16;
+
+/* Filters run under each allocation policy; motion blur N/S walks columns */
+static const char* kAllocationFilterSpecs[] = {"motionblur:5:ns", "blur:2"};
+static const PixelAllocationPolicy kAllocationPolicies[] = {
+  image_tools::PIXEL_ALLOC_STANDARD, image_tools::PIXEL_ALLOC_HUGE_PAGES
+};
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Command line settings for a benchmark run.
+ */
+struct BenchOptions {
+  BenchOptions(void) : sizes(), suites(), images_dir("test-images"),
+                       csv_file(), json_file(), baseline_file(),
+                       tmp_dir(), min_time_ms(200.0), max_reps(10),
+                       tolerance(0.10), memory_limit_mb(4096) {}
+  std::vector<double> sizes; /**< Megapixels of the synthetic images */
+  std::vector<std::string> suites;
+  std::string images_dir;
+  std::string csv_file;
+  std::string json_file;
+  std::string baseline_file;
+  std::string tmp_dir;
+  double min_time_ms; /**< Repeat each case until it has run this long */
+  int max_reps;
+  double tolerance; /**< Slowdown vs. the baseline reported as a regression */
+  int memory_limit_mb; /**< Cases needing more than this are skipped */
+};
+
+/**
+ * @brief One measured case.
+ */
+struct BenchResult {
+  BenchResult(void) : suite(), name(), params(), width(0), height(0),
+                      reps(0), mean_ms(0.0), min_ms(0.0), bytes(0) {}
+  std::string suite;
+  std::string name;
+  std::string params;
+  int width;
+  int height;
+  int reps;
+  double mean_ms;
+  double min_ms;
+  int64_t bytes; /**< Encoded size for codec cases, else 0 */
+
+  double megapixels(void) const { return width * 1e-6 * height; }
+  /* A tool dab only touches the pixels under it, so only ops/s applies */
+  double mpix_per_s(void) const {
+    return (min_ms > 0.0 && suite != "tool") ?
+        megapixels() * 1000.0 / min_ms : 0.0;
+  }
+  double ops_per_s(void) const {
+    return (min_ms > 0.0) ? 1000.0 / min_ms : 0.0;
+  }
+  std::string key(void) const {
+    std::ostringstream key;
+    key << suite << "/" << name << "/" << params << "/" << width << "x"
+        << height;
+    return key.str();
+  }
+};
+
+/**
+ * @brief Silences std::cout (the codecs and tools report to it) while a case
+ * is being measured.
+ */
+class QuietStdout {
+ public:
+  QuietStdout(void) : saved_(std::cout.rdbuf(nullptr)) {}
+  ~QuietStdout(void) { std::cout.rdbuf(saved_); }
+
+ private:
+  QuietStdout(const QuietStdout &rhs) = delete;
+  QuietStdout& operator=(const QuietStdout &rhs) = delete;
+
+  std::streambuf* saved_;
+};
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Run body() until it has taken at least the minimum time (and at least
+ * once), up to the maximum repetitions, and record the mean and best time.
+ */
+template <typename Body>
+static void Measure(const BenchOptions& options, Body body,
+                    BenchResult* result) {
+  QuietStdout quiet;
+  double total_ms = 0.0;
+  result->reps = 0;
+  result->min_ms = 0.0;
+  do {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    double elapsed_ms = MillisecondsSince(start);
+    total_ms += elapsed_ms;
+    if (result->reps == 0 || elapsed_ms < result->min_ms) {
+      result->min_ms = elapsed_ms;
+    }
+    result->reps++;
+  } while (total_ms < options.min_time_ms && result->reps < options.max_reps);
+  result->mean_ms = total_ms / result->reps;
+}
+
+static void ReportResult(const BenchResult& result,
+                         std::vector<BenchResult>* results) {
+  std::printf("%-6s %-28s %-16s %6dx%-6d %4d reps %11.3f ms ",
+              result.suite.c_str(), result.name.c_str(),
+              result.params.c_str(), result.width, result.height,
+              result.reps, result.min_ms);
+  if (result.suite == "tool") {
+    std::printf("%9.0f ops/s\n", result.ops_per_s());
+  } else {
+    std::printf("%9.2f MP/s\n", result.mpix_per_s());
+  }
+  std::fflush(stdout);
+  results->push_back(result);
+}
+
+static uint32_t NextRandom(uint32_t* state) {
+  /* xorshift32: the same sequence on every machine */
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+/**
+ * @brief Build a deterministic test image with smooth gradients, hard edges,
+ * a translucent region and noise, so that filters and codecs see content
+ * similar to a photograph with some drawing on it.
+ */
+static PixelBuffer* MakeSyntheticImage(int width, int height, uint32_t seed) {
+  PixelBuffer* image = new PixelBuffer(width, height, ColorData(1, 1, 1));
+  uint32_t state = seed ? seed : 1;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float u = static_cast<float>(x) / width;
+      float v = static_cast<float>(y) / height;
+      float noise = (NextRandom(&state) & 0xff) / 2550.0f;
+      bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+      float r = 0.5f + 0.4f * std::sin(6.2832f * (u + v)) + noise;
+      float g = checker ? 0.8f * u + noise : 0.2f + noise;
+      float b = 0.5f + 0.4f * std::cos(12.566f * v) - noise;
+      float a = (u > 0.75f && v > 0.75f) ? 0.5f : 1.0f;
+      image->set_pixel(x, y, ColorData(r, g, b, a).clamped_color());
+    }
+  }
+  return image;
+}
+
+/**
+ * @brief The width and height of a roughly 4:3 image of the given size
+ */
+static void ImageDimensions(double megapixels, int* width, int* height) {
+  *width = std::max(1, static_cast<int>(std::sqrt(megapixels * 1e6 * 4 / 3)));
+  *height = std::max(1, static_cast<int>(megapixels * 1e6 / *width));
+}
+
+static bool FitsInMemory(const BenchOptions& options, int width, int height,
+                         int buffers) {
+  double mb = static_cast<double>(width) * height * sizeof(ColorData) *
+              buffers / (1024 * 1024);
+  if (mb <= options.memory_limit_mb) {
+    return true;
+  }
+  std::printf("(skipping %dx%d: needs %.0f MB, limit %d MB)\n", width, height,
+              mb, options.memory_limit_mb);
+  return false;
+}
+
+static int64_t FileSize(const std::string& file_name) {
+  struct stat file_stat;
+  return (stat(file_name.c_str(), &file_stat) == 0) ? file_stat.st_size : -1;
+}
+
+static std::vector<std::string> Split(const std::string& text,
+                                      char delimiter) {
+  std::vector<std::string> fields;
+  std::stringstream stream(text);
+  std::string field;
+  while (std::getline(stream, field, delimiter)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+/*******************************************************************************
+ * Suites
+ ******************************************************************************/
+static void BenchFilters(const BenchOptions& options, int width, int height,
+                         std::vector<BenchResult>* results) {
+  /* The image and the copy each convolution filter makes */
+  if (!FitsInMemory(options, width, height, 2)) {
+    return;
+  }
+  PixelBuffer* image = MakeSyntheticImage(width, height, 1);
+  for (const char* spec : kFilterSpecs) {
+    FilterOperation operation;
+    FilterOperation::Parse(spec, &operation);
+    std::string text = spec;
+    size_t colon = text.find(':');
+
+    BenchResult result;
+    result.suite = "filter";
+    result.name = text.substr(0, colon);
+    result.params = (colon == std::string::npos) ? "" : text.substr(colon + 1);
+    result.width = width;
+    result.height = height;
+    Measure(options, [&]() { operation.Apply(image); }, &result);
+    ReportResult(result, results);
+  }
+  delete image;
+}
+
+static void BenchTools(const BenchOptions& options, int width, int height,
+                       std::vector<BenchResult>* results) {
+  /* The canvas and the copy the blur tool makes on each dab */
+  if (!FitsInMemory(options, width, height, 2)) {
+    return;
+  }
+  PixelBuffer* canvas = MakeSyntheticImage(width, height, 2);
+  PixelBuffer* stamp = MakeSyntheticImage(kStampSize, kStampSize, 3);
+  ToolBelt toolbelt(canvas, 0, ColorData(0.2, 0.4, 0.8));
+  static_cast<Stamper*>(toolbelt.get_buffer_stamper())->
+    set_buffer_stamp_mask(stamp);
+
+  int center_x = width / 2;
+  int center_y = height / 2;
+  int half_stroke = std::min(kStrokeLength, std::min(width, height)) / 2;
+  for (const auto& tool_info : kTools) {
+    toolbelt.set_active_tool(tool_info.index);
+    Tool* tool = toolbelt.get_active_tool();
+
+    BenchResult dab;
+    dab.suite = "tool";
+    dab.name = tool_info.name;
+    dab.params = "dab";
+    dab.width = width;
+    dab.height = height;
+    Measure(options, [&]() { tool->ApplyClick(center_x, center_y); }, &dab);
+    ReportResult(dab, results);
+
+    BenchResult stroke = dab;
+    stroke.params = "stroke" + std::to_string(2 * half_stroke);
+    Measure(options, [&]() {
+        tool->ApplyDragged(center_x - half_stroke, center_y - half_stroke,
+                           center_x + half_stroke, center_y + half_stroke);
+      }, &stroke);
+    ReportResult(stroke, results);
+  }
+  delete stamp;
+  delete canvas;
+}
+
+static void BenchCodecFile(const BenchOptions& options,
+                           const PixelBuffer& image, const std::string& name,
+                           const std::string& file_name, EncodeProfile profile,
+                           std::vector<BenchResult>* results) {
+  std::string format = ImageCodec::is_png_file_name(file_name) ? "png" :
+                       "jpeg";
+  PngEncodeSettings png_settings = PngEncodeSettings::ForProfile(profile);
+  JpegEncodeSettings jpeg_settings = JpegEncodeSettings::ForProfile(profile,
+                                                                    75);
+
+  BenchResult save;
+  save.suite = "codec";
+  save.name = name + "_save_" + format;
+  save.params = image_tools::EncodeProfileName(profile);
+  save.width = image.width();
+  save.height = image.height();
+  bool saved = true;
+  Measure(options, [&]() {
+      saved = ImageCodec::Save(image, file_name, png_settings, jpeg_settings,
+                               nullptr) && saved;
+    }, &save);
+  if (!saved) {
+    std::cerr << "Could not save " << file_name << std::endl;
+    return;
+  }
+  save.bytes = FileSize(file_name);
+  ReportResult(save, results);
+
+  BenchResult load = save;
+  load.name = name + "_load_" + format;
+  Measure(options, [&]() {
+      delete ImageCodec::Load(file_name, true, nullptr);
+    }, &load);
+  ReportResult(load, results);
+  unlink(file_name.c_str());
+}
+
+static void BenchCodecs(const BenchOptions& options, int width, int height,
+                        std::vector<BenchResult>* results) {
+  /* The image and the decoded copy */
+  if (!FitsInMemory(options, width, height, 2)) {
+    return;
+  }
+  PixelBuffer* image = MakeSyntheticImage(width, height, 4);
+  for (int p = 0; p < image_tools::ENCODE_PROFILE_COUNT; p++) {
+    EncodeProfile profile = static_cast<EncodeProfile>(p);
+    BenchCodecFile(options, *image, "synthetic",
+                   options.tmp_dir + "/synthetic.png", profile, results);
+    BenchCodecFile(options, *image, "synthetic",
+                   options.tmp_dir + "/synthetic.jpg", profile, results);
+  }
+  delete image;
+}
+
+static void BenchTestImages(const BenchOptions& options,
+                            std::vector<BenchResult>* results) {
+  DIR* dir = opendir(options.images_dir.c_str());
+  if (!dir) {
+    std::cerr << "Could not open " << options.images_dir << std::endl;
+    return;
+  }
+  std::vector<std::string> names;
+  while (struct dirent* entry = readdir(dir)) {
+    if (ImageCodec::is_valid_image_file_name(entry->d_name)) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  for (const std::string& name : names) {
+    PixelBuffer* image = nullptr;
+    {
+      QuietStdout quiet;
+      image = ImageCodec::Load(options.images_dir + "/" + name, true,
+                               nullptr);
+    }
+    if (!image) {
+      std::cerr << "Could not load " << name << std::endl;
+      continue;
+    }
+    std::string base = name;
+    std::replace(base.begin(), base.end(), '.', '_');
+    BenchCodecFile(options, *image, base, options.tmp_dir + "/" + base +
+                   ".png", image_tools::ENCODE_PROFILE_BALANCED, results);
+    BenchCodecFile(options, *image, base, options.tmp_dir + "/" + base +
+                   ".jpg", image_tools::ENCODE_PROFILE_BALANCED, results);
+    delete image;
+  }
+}
+
+/**
+ * @return FALSE if evicting undo states left the pool holding more memory
+ */
+static bool BenchHistory(const BenchOptions& options, int width, int height,
+                         std::vector<BenchResult>* results) {
+  /* The canvas and every state on the stacks */
+  if (!FitsInMemory(options, width, height, kHistoryDepth + 1)) {
+    return true;
+  }
+  PixelBuffer* canvas = MakeSyntheticImage(width, height, 5);
+  CanvasHistory history;
+  // Every state must stay undoable; FitsInMemory() has already checked them
+  int64_t saved_budget = CanvasHistory::max_bytes();
+  history.set_max_bytes(0);
+
+  /*
+   * Each operation is done the way FlashPhotoApp does it: registering a state
+   * snapshots the canvas, and undo/redo copy a state back into it. They
+   * cannot be repeated freely, so each is timed kHistoryDepth - 1 times.
+   */
+  BenchResult base;
+  base.suite = "undo";
+  base.params = "depth" + std::to_string(kHistoryDepth);
+  base.width = width;
+  base.height = height;
+  history.RegisterNewState(canvas->GetAllPixels());
+
+  BenchOptions once = options;
+  once.min_time_ms = 0.0;
+  once.max_reps = 1;
+  const char* names[] = {"register", "undo", "redo"};
+  for (int op = 0; op < 3; op++) {
+    BenchResult result = base;
+    result.name = names[op];
+    double total_ms = 0.0;
+    for (int i = 0; i < kHistoryDepth - 1; i++) {
+      BenchResult one;
+      Measure(once, [&]() {
+          if (op == 0) {
+            history.RegisterNewState(canvas->GetAllPixels());
+          } else if (op == 1) {
+            canvas->SetAllPixels(history.Undo());
+          } else {
+            canvas->SetAllPixels(history.Redo());
+          }
+        }, &one);
+      total_ms += one.min_ms;
+      if (i == 0 || one.min_ms < result.min_ms) {
+        result.min_ms = one.min_ms;
+      }
+    }
+    result.reps = kHistoryDepth - 1;
+    result.mean_ms = total_ms / result.reps;
+    ReportResult(result, results);
+  }
+
+  /*
+   * Then register state after state over a budget of a few, so each evicts
+   * the oldest. Evicted states must go back to the system rather than stay
+   * idle in the pool, so it must never reserve more than it does with just
+   * the canvas and the budget's states borrowed.
+   */
+  history.set_max_bytes(static_cast<int64_t>(kEvictionBudgetStates) *
+                        width * height * sizeof(ColorData));
+  history.RegisterNewState(canvas->GetAllPixels());
+  PixelPool::Trim();
+  int64_t reserved_bytes = PixelPool::stats().reserved_bytes;
+  int64_t max_reserved_bytes = reserved_bytes;
+  BenchResult result = base;
+  result.name = "evict";
+  double total_ms = 0.0;
+  for (int i = 0; i < kEvictionRounds; i++) {
+    BenchResult one;
+    Measure(once, [&]() {
+        history.RegisterNewState(canvas->GetAllPixels());
+      }, &one);
+    total_ms += one.min_ms;
+    if (i == 0 || one.min_ms < result.min_ms) {
+      result.min_ms = one.min_ms;
+    }
+    max_reserved_bytes = std::max(max_reserved_bytes,
+                                  PixelPool::stats().reserved_bytes);
+  }
+  result.reps = kEvictionRounds;
+  result.mean_ms = total_ms / result.reps;
+  ReportResult(result, results);
+
+  bool flat = (max_reserved_bytes <= reserved_bytes);
+  if (!flat) {
+    std::printf("undo   evict: FAILED, pool reserved grew from %lld to %lld "
+                "bytes over %d evictions\n",
+                static_cast<long long>(reserved_bytes),
+                static_cast<long long>(max_reserved_bytes),
+                kEvictionRounds);
+  }
+  history.set_max_bytes(saved_budget);
+  delete canvas;
+  return flat;
+}
+
+static void BenchAllocation(const BenchOptions& options, int width,
+                            int height, std::vector<BenchResult>* results) {
+  /* The image and the copy each convolution filter makes */
+  if (!FitsInMemory(options, width, height, 2)) {
+    return;
+  }
+  PixelAllocationPolicy saved_policy = PixelPool::policy();
+  std::vector<BenchResult> measured;
+  for (PixelAllocationPolicy policy : kAllocationPolicies) {
+    /* Release the pooled buffers so everything below gets new memory */
+    PixelPool::Trim();
+    PixelPool::set_policy(policy);
+
+    BenchResult base;
+    base.suite = "alloc";
+    base.params = PixelPool::PolicyName(policy);
+    base.width = width;
+    base.height = height;
+
+    BenchResult result = base;
+    result.name = "allocate";
+    Measure(options, [&]() {
+        PixelPool::Trim();
+        delete new PixelBuffer(width, height, ColorData(1, 1, 1));
+      }, &result);
+    ReportResult(result, results);
+    measured.push_back(result);
+
+    PixelPool::Trim();
+    PixelBuffer* image = MakeSyntheticImage(width, height, 6);
+    for (const char* spec : kAllocationFilterSpecs) {
+      FilterOperation operation;
+      FilterOperation::Parse(spec, &operation);
+      std::string text = spec;
+      size_t colon = text.find(':');
+      result = base;
+      result.name = text.substr(0, colon);
+      result.params += "," + text.substr(colon + 1);
+      Measure(options, [&]() { operation.Apply(image); }, &result);
+      ReportResult(result, results);
+      measured.push_back(result);
+    }
+    delete image;
+  }
+  PixelPool::Trim();
+  PixelPool::set_policy(saved_policy);
+
+  /* The cases for the two policies were measured in the same order */
+  size_t cases = measured.size() / 2;
+  for (size_t i = 0; i < cases; i++) {
+    const BenchResult& standard = measured[i];
+    const BenchResult& huge_pages = measured[cases + i];
+    if (huge_pages.min_ms > 0.0) {
+      std::printf("alloc  %-28s %-16s %.2fx standard\n",
+                  huge_pages.name.c_str(), huge_pages.params.c_str(),
+                  standard.min_ms / huge_pages.min_ms);
+    }
+  }
+}
+
+/*******************************************************************************
+ * Output
+ ******************************************************************************/
+static std::string CsvField(const std::string& text) {
+  if (text.find_first_of(",\"") == std::string::npos) {
+    return text;
+  }
+  std::string quoted = "\"";
+  for (char c : text) {
+    quoted += (c == '"') ? "\"\"" : std::string(1, c);
+  }
+  return quoted + "\"";
+}
+
+static std::vector<std::string> ParseCsvLine(const std::string& line) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); i++) {
+    char c = line[i];
+    if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+      fields.back() += '"';
+      i++;
+    } else if (c == '"') {
+      quoted = !quoted;
+    } else if (c == ',' && !quoted) {
+      fields.push_back("");
+    } else {
+      fields.back() += c;
+    }
+  }
+  return fields;
+}
+
+static bool WriteCsv(const std::string& file_name,
+                     const std::vector<BenchResult>& results) {
+  std::ofstream out(file_name.c_str());
+  if (!out) {
+    return false;
+  }
+  out << "suite,name,params,width,height,megapixels,reps,mean_ms,min_ms,"
+      << "mpix_per_s,ops_per_s,bytes\n";
+  for (const BenchResult& r : results) {
+    out << r.suite << "," << r.name << "," << CsvField(r.params) << ","
+        << r.width << "," << r.height << "," << r.megapixels() << ","
+        << r.reps << "," << r.mean_ms << "," << r.min_ms << ","
+        << r.mpix_per_s() << "," << r.ops_per_s() << "," << r.bytes << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+static bool WriteJson(const std::string& file_name,
+                      const std::vector<BenchResult>& results) {
+  std::ofstream out(file_name.c_str());
+  if (!out) {
+    return false;
+  }
+  out << "{\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    out << (i ? "," : "") << "\n    {\"suite\": \"" << r.suite
+        << "\", \"name\": \"" << r.name << "\", \"params\": \"" << r.params
+        << "\", \"width\": " << r.width << ", \"height\": " << r.height
+        << ", \"megapixels\": " << r.megapixels() << ", \"reps\": " << r.reps
+        << ", \"mean_ms\": " << r.mean_ms << ", \"min_ms\": " << r.min_ms
+        << ", \"mpix_per_s\": " << r.mpix_per_s() << ", \"ops_per_s\": "
+        << r.ops_per_s() << ", \"bytes\": " << r.bytes << "}";
+  }
+  out << "\n  ]\n}\n";
+  return static_cast<bool>(out);
+}
+
+/**
+ * @brief Print how busy each of the scheduler's workers was over the run
+ */
+static void PrintWorkerStats(void) {
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  std::printf("\nScheduler workers (the calling thread also runs tasks):\n");
+  for (int worker = 0; worker < scheduler.worker_count(); worker++) {
+    WorkerStats stats = scheduler.worker_stats(worker);
+    std::printf("worker %-3d %9lld tasks %9lld stolen %11.0f ms busy %5.1f%%\n",
+                worker, static_cast<long long>(stats.tasks_run),
+                static_cast<long long>(stats.tasks_stolen), stats.busy_ms,
+                stats.utilization * 100.);
+  }
+}
+
+/**
+ * @brief Compare the best times against a CSV file written by an earlier run
+ *
+ * @return The number of cases slower than the baseline by more than the
+ * tolerance, or -1 if the baseline could not be read
+ */
+static int CompareToBaseline(const BenchOptions& options,
+                             const std::vector<BenchResult>& results) {
+  std::ifstream in(options.baseline_file.c_str());
+  if (!in) {
+    std::cerr << "Could not read baseline " << options.baseline_file
+              << std::endl;
+    return -1;
+  }
+  std::map<std::string, BenchResult> baseline;
+  std::string line;
+  std::getline(in, line);  // header
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields = ParseCsvLine(line);
+    if (fields.size() < 9) {
+      continue;
+    }
+    BenchResult r;
+    r.suite = fields[0];
+    r.name = fields[1];
+    r.params = fields[2];
+    r.width = atoi(fields[3].c_str());
+    r.height = atoi(fields[4].c_str());
+    r.min_ms = atof(fields[8].c_str());
+    baseline[r.key()] = r;
+  }
+
+  int regressions = 0;
+  int compared = 0;
+  std::printf("\nComparison with %s (best times, tolerance %.0f%%):\n",
+              options.baseline_file.c_str(), options.tolerance * 100);
+  for (const BenchResult& r : results) {
+    auto it = baseline.find(r.key());
+    if (it == baseline.end() || it->second.min_ms <= 0.0) {
+      continue;
+    }
+    compared++;
+    double ratio = r.min_ms / it->second.min_ms;
+    const char* verdict = "";
+    if (ratio > 1.0 + options.tolerance) {
+      verdict = "REGRESSION";
+      regressions++;
+    } else if (ratio < 1.0 / (1.0 + options.tolerance)) {
+      verdict = "improved";
+    }
+    std::printf("%-48s %11.3f -> %11.3f ms  %6.2fx  %s\n", r.key().c_str(),
+                it->second.min_ms, r.min_ms, it->second.min_ms / r.min_ms,
+                verdict);
+  }
+  std::printf("%d cases compared, %d regressions.\n", compared, regressions);
+  return regressions;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+static void PrintUsage(const char* program) {
+  std::cout
+    << "Usage: " << program << " [options]\n"
+    << "\n"
+    << "Measures the image processing core on deterministic synthetic images\n"
+    << "of each size and on the images in test-images/.\n"
+    << "\n"
+    << "Options:\n"
+    << "  -s, --sizes LIST     Synthetic image sizes in megapixels\n"
+    << "                       (default 1,10,100)\n"
+    << "      --suites LIST    Any of filter,tool,codec,images,undo,alloc\n"
+    << "                       (default all); undo also checks that evicting\n"
+    << "                       states keeps the pool flat, else exits with\n"
+    << "                       status 3\n"
+    << "      --images DIR     Real images to load/save (default test-images)\n"
+    << "      --csv FILE       Write the results as CSV\n"
+    << "      --json FILE      Write the results as JSON\n"
+    << "  -b, --baseline FILE  Compare with a CSV from an earlier run; exits\n"
+    << "                       with status 2 if anything regressed\n"
+    << "      --tolerance PCT  Slowdown reported as a regression (default 10)\n"
+    << "      --min-time MS    Repeat each case for at least this long\n"
+    << "                       (default 200)\n"
+    << "      --max-reps N     Repeat each case at most N times (default 10)\n"
+    << "      --memory-limit MB  Skip cases needing more (default 4096)\n"
+    << "      --quick          Same as --sizes 1 --min-time 0 --max-reps 1\n"
+    << "  -h, --help           Show this message\n";
+}
+
+int main(int argc, char* argv[]) {
+  BenchOptions options;
+  std::string sizes = "1,10,100";
+  std::string suites = "filter,tool,codec,images,undo,alloc";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    } else if ((arg == "-s" || arg == "--sizes") && has_value) {
+      sizes = argv[++i];
+    } else if (arg == "--suites" && has_value) {
+      suites = argv[++i];
+    } else if (arg == "--images" && has_value) {
+      options.images_dir = argv[++i];
+    } else if (arg == "--csv" && has_value) {
+      options.csv_file = argv[++i];
+    } else if (arg == "--json" && has_value) {
+      options.json_file = argv[++i];
+    } else if ((arg == "-b" || arg == "--baseline") && has_value) {
+      options.baseline_file = argv[++i];
+    } else if (arg == "--tolerance" && has_value) {
+      options.tolerance = atof(argv[++i]) / 100;
+    } else if (arg == "--min-time" && has_value) {
+      options.min_time_ms = atof(argv[++i]);
+    } else if (arg == "--max-reps" && has_value) {
+      options.max_reps = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--memory-limit" && has_value) {
+      options.memory_limit_mb = atoi(argv[++i]);
+    } else if (arg == "--quick") {
+      sizes = "1";
+      options.min_time_ms = 0.0;
+      options.max_reps = 1;
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  for (const std::string& size : Split(sizes, ',')) {
+    double megapixels = atof(size.c_str());
+    if (megapixels <= 0.0) {
+      std::cerr << "Invalid size: " << size << std::endl;
+      return 1;
+    }
+    options.sizes.push_back(megapixels);
+  }
+  options.suites = Split(suites, ',');
+  auto enabled = [&](const char* suite) {
+    return std::find(options.suites.begin(), options.suites.end(), suite) !=
+           options.suites.end();
+  };
+
+  const char* tmp_root = getenv("TMPDIR");
+  std::string tmp_template = std::string(tmp_root ? tmp_root : "/tmp") +
+                             "/flashphoto_bench.XXXXXX";
+  std::vector<char> tmp_name(tmp_template.begin(), tmp_template.end());
+  tmp_name.push_back('\0');
+  if (!mkdtemp(tmp_name.data())) {
+    std::cerr << "Could not create a temporary directory" << std::endl;
+    return 1;
+  }
+  options.tmp_dir = tmp_name.data();
+
+  std::vector<BenchResult> results;
+  bool checks_passed = true;
+  for (double megapixels : options.sizes) {
+    int width, height;
+    ImageDimensions(megapixels, &width, &height);
+    if (enabled("filter")) {
+      BenchFilters(options, width, height, &results);
+    }
+    if (enabled("tool")) {
+      BenchTools(options, width, height, &results);
+    }
+    if (enabled("codec")) {
+      BenchCodecs(options, width, height, &results);
+    }
+    if (enabled("undo")) {
+      checks_passed = BenchHistory(options, width, height, &results) &&
+                      checks_passed;
+    }
+    if (enabled("alloc")) {
+      BenchAllocation(options, width, height, &results);
+    }
+  }
+  if (enabled("images")) {
+    BenchTestImages(options, &results);
+  }
+  rmdir(options.tmp_dir.c_str());
+  PrintWorkerStats();
+  image_tools::MemoryAccounting::ReportLeaks(std::cerr);
+
+  if (!options.csv_file.empty() && !WriteCsv(options.csv_file, results)) {
+    std::cerr << "Could not write " << options.csv_file << std::endl;
+    return 1;
+  }
+  if (!options.json_file.empty() && !WriteJson(options.json_file, results)) {
+    std::cerr << "Could not write " << options.json_file << std::endl;
+    return 1;
+  }
+  if (!options.baseline_file.empty()) {
+    int regressions = CompareToBaseline(options, results);
+    if (regressions != 0) {
+      return (regressions < 0) ? 1 : 2;
+    }
+  }
+  return checks_passed ? 0 : 3;
+}
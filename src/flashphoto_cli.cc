@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * Name            : flashphoto_cli.cc
+ * Project         : FlashPhoto
+ * Module          : batch_processor
+ * Description     : Headless command line front end for batch processing
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "include/batch_processor.h"
+#include "include/encode_settings.h"
+#include "include/image_codec.h"
+#include "include/memory_accounting.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+static void PrintUsage(const char* program) {
+  std::cout
+    << "Usage: " << program << " [options] INPUT OUTPUT\n"
+    << "\n"
+    << "Loads INPUT, applies the filters in the order given and saves the\n"
+    << "result to OUTPUT. If INPUT is a directory, every image in it is\n"
+    << "processed and written to the directory OUTPUT.\n"
+    << "\n"
+    << "Options:\n"
+    << "  -f, --filter SPEC    Add a filter (may be repeated)\n"
+    << "  -j, --jobs N         Images processed at once (directories only)\n"
+    << "  -p, --profile NAME   Encode profile: store, fastest, balanced,\n"
+    << "                       smallest (default balanced)\n"
+    << "  -q, --quality N      JPEG quality, 1-100 (default 75)\n"
+    << "      --format EXT     Output format for directories: png or jpg\n"
+    << "                       (default: same as each input)\n"
+    << "      --out-of-core MP Stream images larger than MP megapixels\n"
+    << "                       through a memory-mapped tile file (default\n"
+    << "                       128; 0 for every image)\n"
+    << "      --tile-dir DIR   Where to put tile files (default $TMPDIR)\n"
+    << "      --trace FILE     Write a Chrome trace of the run to FILE\n"
+    << "  -h, --help           Show this message\n"
+    << "\n"
+    << "Filters:\n"
+    << "  blur:AMOUNT  gaussian:SIGMA  sharpen:AMOUNT\n"
+    << "  unsharp:RADIUS[:AMOUNT[:THRESHOLD]]\n"
+    << "  motionblur:AMOUNT[:ns|ew|nesw|nwse]\n"
+    << "  edgedetect  threshold:AMOUNT  saturate:AMOUNT  channel:R,G,B\n"
+    << "  quantize:BINS  dither:BINS[:bayer|bluenoise|floyd|atkinson]\n"
+    << "  median:RADIUS[:PERCENTILE]  bilateral:SIGMA[:RANGE_SIGMA]\n"
+    << "  erode|dilate|open|close:RADIUS[,RADIUS_Y][:gray]  special\n";
+}
+
+static bool ParseProfile(const std::string& name,
+                         image_tools::EncodeProfile* profile) {
+  for (int p = 0; p < image_tools::ENCODE_PROFILE_COUNT; p++) {
+    image_tools::EncodeProfile candidate =
+      static_cast<image_tools::EncodeProfile>(p);
+    if (name == image_tools::EncodeProfileName(candidate)) {
+      *profile = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<image_tools::FilterOperation> operations;
+  std::vector<std::string> paths;
+  image_tools::EncodeProfile profile = image_tools::ENCODE_PROFILE_BALANCED;
+  int jobs = 0;
+  int quality = 75;
+  std::string output_suffix;
+  std::string trace_file;
+  int64_t out_of_core_pixels =
+    image_tools::BatchProcessor::kDefaultOutOfCorePixels;
+  std::string tile_directory;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
+    } else if ((arg == "-f" || arg == "--filter") && has_value) {
+      image_tools::FilterOperation operation;
+      if (!image_tools::FilterOperation::Parse(argv[++i], &operation)) {
+        std::cerr << "Invalid filter: " << argv[i] << std::endl;
+        return 1;
+      }
+      operations.push_back(operation);
+    } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+      jobs = atoi(argv[++i]);
+    } else if ((arg == "-p" || arg == "--profile") && has_value) {
+      if (!ParseProfile(argv[++i], &profile)) {
+        std::cerr << "Invalid profile: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if ((arg == "-q" || arg == "--quality") && has_value) {
+      quality = atoi(argv[++i]);
+      if (quality < 1 || quality > 100) {
+        std::cerr << "Quality must be between 1 and 100" << std::endl;
+        return 1;
+      }
+    } else if (arg == "--format" && has_value) {
+      output_suffix = std::string(".") + argv[++i];
+      if (!image_tools::ImageCodec::is_valid_image_file_name(output_suffix)) {
+        std::cerr << "Invalid format: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--out-of-core" && has_value) {
+      out_of_core_pixels = static_cast<int64_t>(atof(argv[++i]) * (1 << 20));
+    } else if (arg == "--tile-dir" && has_value) {
+      tile_directory = argv[++i];
+    } else if (arg == "--trace" && has_value) {
+      trace_file = argv[++i];
+      image_tools::Tracer::set_enabled(true);
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.size() != 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  image_tools::BatchProcessor processor(operations);
+  processor.set_encode_profile(profile);
+  processor.set_jpeg_quality(quality);
+  processor.set_out_of_core_pixels(out_of_core_pixels);
+  processor.set_tile_directory(tile_directory);
+  if (jobs > 0) {
+    processor.set_max_threads(jobs);
+  }
+
+  struct stat input_stat;
+  if (stat(paths[0].c_str(), &input_stat) != 0) {
+    std::cerr << "Could not open " << paths[0] << std::endl;
+    return 1;
+  }
+
+  bool succeeded;
+  if (S_ISDIR(input_stat.st_mode)) {
+    succeeded = processor.ProcessDirectory(paths[0], paths[1], output_suffix);
+  } else {
+    image_tools::BatchTiming timing;
+    succeeded = processor.ProcessImage(paths[0], paths[1], &timing);
+    image_tools::BatchProcessor::PrintTiming(timing);
+  }
+
+  if (!trace_file.empty() &&
+      !image_tools::Tracer::WriteChromeTrace(trace_file)) {
+    std::cerr << "Could not write trace to " << trace_file << std::endl;
+  }
+
+  image_tools::MemoryAccounting::ReportLeaks(std::cerr);
+  return succeeded ? 0 : 1;
+}
@@ -0,0 +1,687 @@
+/*******************************************************************************
+ * Name            : image_codec.cc
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Implementation of the ImageCodec class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/image_codec.h"
+#include <setjmp.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../ext/libpng-1.6.16/png.h"
+#include "../ext/jpeg-9a/jpeglib.h"
+#include "../ext/jpeg-9a/jerror.h"
+#include "include/color_data.h"
+#include "include/png_encoder.h"
+#include "include/jpeg_encoder.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+static const ColorData kLoadBackgroundColor(1, 1, static_cast<float>(0.95));
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/* Have libpng expand every PNG to 8-bit RGBA rows */
+static void SetPngReadTransforms(png_structp png, png_infop info) {
+  png_byte color_type = png_get_color_type(png, info);
+  png_byte bit_depth = png_get_bit_depth(png, info);
+
+  if (bit_depth == 16)
+    png_set_strip_16(png);
+
+  if (color_type == PNG_COLOR_TYPE_PALETTE)
+    png_set_palette_to_rgb(png);
+
+  if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+    png_set_expand_gray_1_2_4_to_8(png);
+
+  if (color_type == PNG_COLOR_TYPE_GRAY ||
+    color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+      png_set_gray_to_rgb(png);
+  }
+
+  if (png_get_valid(png, info, PNG_INFO_tRNS))
+    png_set_tRNS_to_alpha(png);
+
+  // Fill in the alpha values if the color type does not contain an alpha value.
+  if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY ||
+    color_type == PNG_COLOR_TYPE_PALETTE) {
+    png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+  }
+}
+
+static void PngRowToPixels(const png_byte* row, int width,
+                           bool composite_color_values, ColorData* pixels) {
+  ColorData background_color = kLoadBackgroundColor.clamped_color();
+  for (int x = 0; x < width; x++) {
+    // Get the RGBA values from the PNG.
+    float red = static_cast<float>(row[(x * 4) + 0] / 255.);
+    float green = static_cast<float>(row[(x * 4) + 1] / 255.);
+    float blue = static_cast<float>(row[(x * 4) + 2] / 255.);
+    float alpha = static_cast<float>(row[(x * 4) + 3] / 255.);
+
+    if (composite_color_values) {
+      // Composite the values with the background.
+      red = (red * alpha) + (background_color.red() * (1 - alpha));
+      green = (green * alpha) + (background_color.red() * (1 - alpha));
+      blue = (blue * alpha) + (background_color.blue() * (1 - alpha));
+      alpha = alpha + (background_color.alpha() * (1 - alpha));
+    }
+    pixels[x] = ColorData(red, green, blue, alpha);
+  }
+}
+
+static void JpegRowToPixels(const JSAMPLE* row, int width,
+                            ColorData* pixels) {
+  for (int x = 0; x < width; x++) {
+    float red = static_cast<float>(row[(x*3)+0]/255.);
+    float green = static_cast<float>(row[(x*3)+1]/255.);
+    float blue = static_cast<float>(row[(x*3)+2]/255.);
+    pixels[x] = ColorData(red, green, blue);
+  }
+}
+
+static inline unsigned char ToSample(float value) {
+  return static_cast<unsigned char>(value * 255.);
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+PixelBuffer* ImageCodec::Load(const std::string& file_name,
+                              bool composite_color_values,
+                              IOProgress* progress) {
+  TRACE_SCOPE("ImageCodec::Load", "io");
+  if (has_suffix(file_name , ".png")) {
+    return LoadPNG(file_name, composite_color_values, progress);
+  } else if (has_suffix(file_name, ".jpg") ||
+             has_suffix(file_name, ".jpeg")) {
+    return LoadJPEG(file_name, progress);
+  }
+  std::cout << "Could not determine image type for load operation." <<
+            std::endl;
+  return nullptr;
+}
+
+bool ImageCodec::Save(const PixelBuffer& image,
+                      const std::string& file_name,
+                      const PngEncodeSettings& png_settings,
+                      const JpegEncodeSettings& jpeg_settings,
+                      IOProgress* progress) {
+  TRACE_SCOPE("ImageCodec::Save", "io");
+  if (has_suffix(file_name , ".png")) {
+    return PngEncoder::Encode(image, file_name, png_settings, progress);
+  } else if (has_suffix(file_name, ".jpg") ||
+             has_suffix(file_name, ".jpeg")) {
+    return JpegEncoder::Encode(image, file_name, jpeg_settings, progress);
+  }
+  std::cout << "Could not determine image type for save operation." <<
+            std::endl;
+  return false;
+}
+
+PixelBuffer* ImageCodec::LoadJPEG(const std::string& file_name,
+                                  IOProgress* progress) {
+  std::cout << "Load JPEG." << std::endl;
+  PixelBuffer* loaded_image = nullptr;
+
+  struct jpeg_decompress_struct info;
+  struct jpeg_error_mgr jpeg_error;
+  JSAMPROW image_row[1];
+
+  info.err = jpeg_std_error(&jpeg_error);
+
+  FILE *fp = fopen(file_name.c_str(), "rb");
+
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to load JPEG." << std::endl;
+    return loaded_image;
+  }
+
+  jpeg_create_decompress(&info);
+  jpeg_stdio_src(&info, fp);
+
+  (void) jpeg_read_header(&info, TRUE);
+
+  // Have libjpeg expand grayscale images so every scanline is RGB.
+  info.out_color_space = JCS_RGB;
+  (void) jpeg_start_decompress(&info);
+
+  if (progress) {
+    progress->set_rows_total(info.output_height);
+  }
+
+  PixelBuffer* pixel_buffer = new PixelBuffer(
+    info.output_width,
+    info.output_height,
+    kLoadBackgroundColor);
+
+  image_row[0] = reinterpret_cast<unsigned char *>(
+    malloc(info.output_width * info.output_components));
+
+  bool cancelled = false;
+  while (info.output_scanline < info.output_height) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+
+    int y = info.output_scanline;
+    (void) jpeg_read_scanlines(&info, image_row, 1);
+    JpegRowToPixels(image_row[0], info.output_width, pixel_buffer->row(y));
+
+    if (progress) {
+      progress->AdvanceRow();
+    }
+  }
+
+  if (cancelled) {
+    jpeg_abort_decompress(&info);
+    delete pixel_buffer;
+  } else {
+    (void) jpeg_finish_decompress(&info);
+    loaded_image = pixel_buffer;
+  }
+
+  free(image_row[0]);
+  jpeg_destroy_decompress(&info);
+  fclose(fp);
+
+  return loaded_image;
+}
+
+PixelBuffer* ImageCodec::LoadPNG(const std::string& file_name,
+                                 bool composite_color_values,
+                                 IOProgress* progress) {
+  PixelBuffer* loaded_image = nullptr;
+  int width, height;
+  int number_of_passes;
+  png_bytep* image_rows;
+
+  FILE *fp = fopen(file_name.c_str(), "rb");
+
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to load PNG." << std::endl;
+    return loaded_image;
+  }
+
+  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                           NULL, NULL, NULL);
+  if (!png) {
+    std::cout << "ERROR: Could not create read struct for PNG." << std::endl;
+    fclose(fp);
+    return loaded_image;
+  }
+
+  png_infop info = png_create_info_struct(png);
+  if (!info) {
+    std::cout << "ERROR: Could not create info struct for PNG." << std::endl;
+    png_destroy_read_struct(&png, nullptr, nullptr);
+    fclose(fp);
+    return loaded_image;
+  }
+
+  if (setjmp(png_jmpbuf(png)))  {
+    std::cout << "ERROR: Could not initialize read buffer for PNG."
+              << std::endl;
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+    return loaded_image;
+  }
+  png_init_io(png, fp);
+
+  png_read_info(png, info);
+
+  width      = png_get_image_width(png, info);
+  height     = png_get_image_height(png, info);
+  SetPngReadTransforms(png, info);
+
+  // Interlaced images are read row by row once per pass.
+  number_of_passes = png_set_interlace_handling(png);
+
+  png_read_update_info(png, info);
+
+  image_rows = reinterpret_cast<png_bytep*>(malloc(sizeof(png_bytep) * height));
+  for (int y = 0; y < height; y++) {
+    image_rows[y] = reinterpret_cast<png_byte*>(
+      malloc(png_get_rowbytes(png, info)));
+  }
+
+  if (progress) {
+    progress->set_rows_total(height * number_of_passes);
+  }
+
+  bool cancelled = false;
+  for (int pass = 0; pass < number_of_passes && !cancelled; pass++) {
+    for (int y = 0; y < height; y++) {
+      if (progress && progress->cancel_requested()) {
+        cancelled = true;
+        break;
+      }
+      png_read_row(png, image_rows[y], nullptr);
+      if (progress) {
+        progress->AdvanceRow();
+      }
+    }
+  }
+
+  png_destroy_read_struct(&png, &info, nullptr);
+  fclose(fp);
+
+  if (!cancelled) {
+    loaded_image = new PixelBuffer(width, height, kLoadBackgroundColor);
+
+    for (int y = 0; y < height; y++) {
+      PngRowToPixels(image_rows[y], width, composite_color_values,
+                     loaded_image->row(y));
+    }
+  }
+
+  for (int y = 0; y < height; y++) {
+    free(image_rows[y]);
+  }
+  free(image_rows);
+
+  if (!cancelled) {
+    std::cout << "Loaded PNG." << std::endl;
+  }
+  return loaded_image;
+}
+
+bool ImageCodec::ReadDimensions(const std::string& file_name, int* width,
+                                int* height) {
+  FILE *fp = fopen(file_name.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  bool found = false;
+  if (has_suffix(file_name, ".png")) {
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                             NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (info && !setjmp(png_jmpbuf(png))) {
+      png_init_io(png, fp);
+      png_read_info(png, info);
+      *width = png_get_image_width(png, info);
+      *height = png_get_image_height(png, info);
+      found = true;
+    }
+    png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
+  } else if (has_suffix(file_name, ".jpg") ||
+             has_suffix(file_name, ".jpeg")) {
+    struct jpeg_decompress_struct info;
+    struct jpeg_error_mgr jpeg_error;
+    info.err = jpeg_std_error(&jpeg_error);
+    jpeg_create_decompress(&info);
+    jpeg_stdio_src(&info, fp);
+    (void) jpeg_read_header(&info, TRUE);
+    *width = info.image_width;
+    *height = info.image_height;
+    found = true;
+    jpeg_destroy_decompress(&info);
+  }
+  fclose(fp);
+  return found;
+}
+
+TiledImage* ImageCodec::LoadTiled(const std::string& file_name,
+                                  bool composite_color_values,
+                                  const std::string& tile_directory,
+                                  IOProgress* progress) {
+  TRACE_SCOPE("ImageCodec::LoadTiled", "io");
+  if (has_suffix(file_name , ".png")) {
+    return LoadTiledPNG(file_name, composite_color_values, tile_directory,
+                        progress);
+  } else if (has_suffix(file_name, ".jpg") ||
+             has_suffix(file_name, ".jpeg")) {
+    return LoadTiledJPEG(file_name, tile_directory, progress);
+  }
+  std::cout << "Could not determine image type for load operation." <<
+            std::endl;
+  return nullptr;
+}
+
+bool ImageCodec::SaveTiled(TiledImage* image,
+                           const std::string& file_name,
+                           const PngEncodeSettings& png_settings,
+                           const JpegEncodeSettings& jpeg_settings,
+                           IOProgress* progress) {
+  TRACE_SCOPE("ImageCodec::SaveTiled", "io");
+  if (has_suffix(file_name , ".png")) {
+    return SaveTiledPNG(image, file_name, png_settings, progress);
+  } else if (has_suffix(file_name, ".jpg") ||
+             has_suffix(file_name, ".jpeg")) {
+    return SaveTiledJPEG(image, file_name, jpeg_settings, progress);
+  }
+  std::cout << "Could not determine image type for save operation." <<
+            std::endl;
+  return false;
+}
+
+TiledImage* ImageCodec::LoadTiledJPEG(const std::string& file_name,
+                                      const std::string& tile_directory,
+                                      IOProgress* progress) {
+  struct jpeg_decompress_struct info;
+  struct jpeg_error_mgr jpeg_error;
+  info.err = jpeg_std_error(&jpeg_error);
+
+  FILE *fp = fopen(file_name.c_str(), "rb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to load JPEG." << std::endl;
+    return nullptr;
+  }
+
+  jpeg_create_decompress(&info);
+  jpeg_stdio_src(&info, fp);
+  (void) jpeg_read_header(&info, TRUE);
+  info.out_color_space = JCS_RGB;
+  (void) jpeg_start_decompress(&info);
+
+  int width = info.output_width;
+  int height = info.output_height;
+  TiledImage* image = TiledImage::Create(width, height, kLoadBackgroundColor,
+                                         false, tile_directory);
+  if (!image) {
+    jpeg_abort_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    fclose(fp);
+    return nullptr;
+  }
+  if (progress) {
+    progress->set_rows_total(height);
+  }
+
+  std::vector<JSAMPLE> samples(static_cast<size_t>(width) *
+                               info.output_components);
+  std::vector<ColorData> pixels(width);
+  JSAMPROW image_row[1] = {samples.data()};
+  bool cancelled = false;
+  while (info.output_scanline < info.output_height) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+    int y = info.output_scanline;
+    (void) jpeg_read_scanlines(&info, image_row, 1);
+    JpegRowToPixels(samples.data(), width, pixels.data());
+    image->WriteRow(y, 0, width, pixels.data());
+    if ((y + 1) % TiledImage::kTileSize == 0) {
+      image->ReleaseTileRows(y / TiledImage::kTileSize,
+                             y / TiledImage::kTileSize + 1);
+    }
+    if (progress) {
+      progress->AdvanceRow();
+    }
+  }
+
+  if (cancelled) {
+    jpeg_abort_decompress(&info);
+    delete image;
+    image = nullptr;
+  } else {
+    (void) jpeg_finish_decompress(&info);
+    image->ReleaseTileRows(0, image->tiles_y());
+    std::cout << "Loaded JPEG." << std::endl;
+  }
+  jpeg_destroy_decompress(&info);
+  fclose(fp);
+  return image;
+}
+
+TiledImage* ImageCodec::LoadTiledPNG(const std::string& file_name,
+                                     bool composite_color_values,
+                                     const std::string& tile_directory,
+                                     IOProgress* progress) {
+  FILE *fp = fopen(file_name.c_str(), "rb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to load PNG." << std::endl;
+    return nullptr;
+  }
+
+  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                           NULL, NULL, NULL);
+  png_infop info = png ? png_create_info_struct(png) : nullptr;
+  if (!info) {
+    std::cout << "ERROR: Could not create read structs for PNG." << std::endl;
+    png_destroy_read_struct(&png, nullptr, nullptr);
+    fclose(fp);
+    return nullptr;
+  }
+
+  // Declared before setjmp() so that the error path can clean them up
+  TiledImage* volatile image = nullptr;
+  if (setjmp(png_jmpbuf(png))) {
+    std::cout << "ERROR: Could not read PNG." << std::endl;
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+    delete image;
+    return nullptr;
+  }
+  png_init_io(png, fp);
+  png_read_info(png, info);
+
+  int width = png_get_image_width(png, info);
+  int height = png_get_image_height(png, info);
+  SetPngReadTransforms(png, info);
+  if (png_set_interlace_handling(png) != 1) {
+    std::cout << "ERROR: Interlaced PNGs cannot be loaded tile by tile."
+              << std::endl;
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+    return nullptr;
+  }
+  png_read_update_info(png, info);
+
+  image = TiledImage::Create(width, height, kLoadBackgroundColor, false,
+                             tile_directory);
+  if (!image) {
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+    return nullptr;
+  }
+  if (progress) {
+    progress->set_rows_total(height);
+  }
+
+  std::vector<png_byte> row(png_get_rowbytes(png, info));
+  std::vector<ColorData> pixels(width);
+  bool cancelled = false;
+  for (int y = 0; y < height; y++) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+    png_read_row(png, row.data(), nullptr);
+    PngRowToPixels(row.data(), width, composite_color_values, pixels.data());
+    image->WriteRow(y, 0, width, pixels.data());
+    if ((y + 1) % TiledImage::kTileSize == 0) {
+      image->ReleaseTileRows(y / TiledImage::kTileSize,
+                             y / TiledImage::kTileSize + 1);
+    }
+    if (progress) {
+      progress->AdvanceRow();
+    }
+  }
+
+  png_destroy_read_struct(&png, &info, nullptr);
+  fclose(fp);
+  TiledImage* loaded_image = image;
+  if (cancelled) {
+    delete loaded_image;
+    return nullptr;
+  }
+  loaded_image->ReleaseTileRows(0, loaded_image->tiles_y());
+  std::cout << "Loaded PNG." << std::endl;
+  return loaded_image;
+}
+
+bool ImageCodec::SaveTiledJPEG(TiledImage* image,
+                               const std::string& file_name,
+                               const JpegEncodeSettings& settings,
+                               IOProgress* progress) {
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to save JPEG." << std::endl;
+    return false;
+  }
+
+  struct jpeg_compress_struct info;
+  struct jpeg_error_mgr jpeg_error;
+  info.err = jpeg_std_error(&jpeg_error);
+  jpeg_create_compress(&info);
+  jpeg_stdio_dest(&info, fp);
+  info.image_width = image->width();
+  info.image_height = image->height();
+  info.input_components = 3;
+  info.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&info);
+  jpeg_set_quality(&info, settings.quality, TRUE);
+  if (settings.fast_dct) {
+    info.dct_method = JDCT_IFAST;
+  }
+  jpeg_start_compress(&info, TRUE);
+
+  int width = image->width();
+  if (progress) {
+    progress->set_rows_total(image->height());
+  }
+  std::vector<ColorData> pixels(width);
+  std::vector<JSAMPLE> samples(static_cast<size_t>(width) * 3);
+  JSAMPROW image_row[1] = {samples.data()};
+  bool cancelled = false;
+  for (int y = 0; y < image->height(); y++) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+    image->ReadRow(y, 0, width, pixels.data());
+    for (int x = 0; x < width; x++) {
+      ColorData color_data = pixels[x].clamped_color();
+      samples[x * 3] = ToSample(color_data.red());
+      samples[x * 3 + 1] = ToSample(color_data.green());
+      samples[x * 3 + 2] = ToSample(color_data.blue());
+    }
+    (void) jpeg_write_scanlines(&info, image_row, 1);
+    if ((y + 1) % TiledImage::kTileSize == 0) {
+      image->ReleaseTileRows(y / TiledImage::kTileSize,
+                             y / TiledImage::kTileSize + 1);
+    }
+    if (progress) {
+      progress->AdvanceRow();
+    }
+  }
+
+  if (cancelled) {
+    jpeg_abort_compress(&info);
+  } else {
+    jpeg_finish_compress(&info);
+  }
+  jpeg_destroy_compress(&info);
+  fclose(fp);
+  image->ReleaseTileRows(0, image->tiles_y());
+  if (cancelled) {
+    remove(file_name.c_str());
+    return false;
+  }
+  std::cout << "Saved JPEG." << std::endl;
+  return true;
+}
+
+bool ImageCodec::SaveTiledPNG(TiledImage* image,
+                              const std::string& file_name,
+                              const PngEncodeSettings& settings,
+                              IOProgress* progress) {
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to save PNG." << std::endl;
+    return false;
+  }
+
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                            NULL, NULL, NULL);
+  png_infop info = png ? png_create_info_struct(png) : nullptr;
+  if (!info) {
+    std::cout << "ERROR: Could not create write structs for PNG." << std::endl;
+    png_destroy_write_struct(&png, nullptr);
+    fclose(fp);
+    return false;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    std::cout << "ERROR: Could not write PNG." << std::endl;
+    png_destroy_write_struct(&png, &info);
+    fclose(fp);
+    remove(file_name.c_str());
+    return false;
+  }
+
+  int width = image->width();
+  png_init_io(png, fp);
+  png_set_IHDR(png, info, width, image->height(), 8, PNG_COLOR_TYPE_RGBA,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+               PNG_FILTER_TYPE_DEFAULT);
+  png_set_compression_level(png, settings.compression_level);
+  png_write_info(png, info);
+
+  if (progress) {
+    progress->set_rows_total(image->height());
+  }
+  std::vector<ColorData> pixels(width);
+  std::vector<png_byte> row(static_cast<size_t>(width) * 4);
+  bool cancelled = false;
+  for (int y = 0; y < image->height(); y++) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+    image->ReadRow(y, 0, width, pixels.data());
+    for (int x = 0; x < width; x++) {
+      ColorData color_data = pixels[x].clamped_color();
+      row[x * 4] = ToSample(color_data.red());
+      row[x * 4 + 1] = ToSample(color_data.green());
+      row[x * 4 + 2] = ToSample(color_data.blue());
+      row[x * 4 + 3] = ToSample(color_data.alpha());
+    }
+    png_write_row(png, row.data());
+    if ((y + 1) % TiledImage::kTileSize == 0) {
+      image->ReleaseTileRows(y / TiledImage::kTileSize,
+                             y / TiledImage::kTileSize + 1);
+    }
+    if (progress) {
+      progress->AdvanceRow();
+    }
+  }
+
+  if (!cancelled) {
+    png_write_end(png, nullptr);
+  }
+  png_destroy_write_struct(&png, &info);
+  fclose(fp);
+  image->ReleaseTileRows(0, image->tiles_y());
+  if (cancelled) {
+    remove(file_name.c_str());
+    return false;
+  }
+  std::cout << "Saved PNG." << std::endl;
+  return true;
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,419 @@
+/*******************************************************************************
+ * Name            : image_filters.cc
+ * Project         : FlashPhoto
+ * Module          : image_filters
+ * Description     : Implementation of the ImageFilters class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/image_filters.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "include/bilateral_grid.h"
+#include "include/ditherer.h"
+#include "include/fft_convolution.h"
+#include "include/morphology_pass.h"
+#include "include/rank_filter.h"
+#include "include/recursive_gaussian.h"
+#include "include/task_scheduler.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Pixel Functions
+ ******************************************************************************/
+static ColorData ThresholdColor(const ColorData& current_color,
+                                const float* params) {
+  float threshold_amount = params[0];
+  float r, g, b, a;
+  r = (current_color.red() >= threshold_amount) ? 1. : 0.;
+  g = (current_color.green() >= threshold_amount) ? 1. : 0.;
+  b = (current_color.blue() >= threshold_amount) ? 1. : 0.;
+  a = current_color.alpha();
+
+  return ColorData(r, g, b, a);
+}
+
+static ColorData SaturateColor(const ColorData& current_color,
+                               const float* params) {
+  float saturation_amount = params[0];
+  float r, g, b;
+  if (saturation_amount < 0.) {
+    r = 1 - current_color.red();
+    g = 1 - current_color.green();
+    b = 1 - current_color.blue();
+  } else {
+    r = current_color.red();
+    g = current_color.green();
+    b = current_color.blue();
+  }
+
+  float saturation_mag = fabs(saturation_amount);
+  float gray_value = 0.2989 * r + 0.5870 * g + 0.1140 * b;
+  ColorData gray_color = ColorData(gray_value, gray_value, gray_value);
+  ColorData gray_contribution = gray_color * (1 - saturation_mag);
+
+  ColorData color_contribution = ColorData(r, g, b) * saturation_mag;
+  ColorData new_color = (
+    color_contribution + gray_contribution).clamped_color();
+
+  return new_color;
+}
+
+static ColorData ChannelColor(const ColorData& current_color,
+                              const float* params) {
+  return (ColorData(current_color.red() * params[0],
+                    current_color.green() * params[1],
+                    current_color.blue() * params[2],
+                    current_color.alpha())).clamped_color();
+}
+
+static ColorData QuantizeColor(const ColorData& current_color,
+                               const float* params) {
+  int one_less_bin = static_cast<int>(params[0]) - 1;
+
+  int r_bin = rint(current_color.red() * one_less_bin);
+  int g_bin = rint(current_color.green() * one_less_bin);
+  int b_bin = rint(current_color.blue() * one_less_bin);
+
+  float quantize_factor = 1. / one_less_bin;
+
+  float new_r = r_bin * quantize_factor;
+  float new_g = g_bin * quantize_factor;
+  float new_b = b_bin * quantize_factor;
+
+  return ColorData(new_r, new_g, new_b, current_color.alpha());
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void ImageFilters::Blur(PixelBuffer* image, float amount) {
+  TRACE_SCOPE("ImageFilters::Blur", "filter");
+  FilterKernel kernel;
+  kernel.Init(amount, FilterKernel::BLUR);
+  ApplyConvolutionFilter(image, &kernel, 0.);
+}
+
+void ImageFilters::GaussianBlur(PixelBuffer* image, float sigma) {
+  TRACE_SCOPE("ImageFilters::GaussianBlur", "filter");
+  RecursiveGaussian gaussian(sigma);
+  if (gaussian.identity()) {
+    return;
+  }
+
+  // Every row is blurred before any column, in bands and strips in parallel
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  scheduler.ParallelFor(0, image->height(), 0, [&](int y_begin, int y_end) {
+    gaussian.FilterRows(image, y_begin, y_end);
+  });
+  scheduler.ParallelFor(0, image->width(), 0, [&](int x_begin, int x_end) {
+    gaussian.FilterColumns(image, x_begin, x_end);
+  });
+}
+
+void ImageFilters::Sharpen(PixelBuffer* image, float amount) {
+  TRACE_SCOPE("ImageFilters::Sharpen", "filter");
+  FilterKernel kernel;
+  kernel.Init(amount, FilterKernel::SHARPEN);
+  ApplyConvolutionFilter(image, &kernel, 0.);
+}
+
+void ImageFilters::UnsharpMask(PixelBuffer* image, float radius,
+                               float amount, float threshold) {
+  TRACE_SCOPE("ImageFilters::UnsharpMask", "filter");
+  RecursiveGaussian gaussian(radius);
+  if (gaussian.identity()) {
+    return;
+  }
+
+  PixelBuffer* blurred = image->Copy();
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  scheduler.ParallelFor(0, image->height(), 0, [&](int y_begin, int y_end) {
+    gaussian.FilterRows(blurred, y_begin, y_end);
+  });
+  // The column pass adds the thresholded detail straight into the image
+  scheduler.ParallelFor(0, image->width(), 0, [&](int x_begin, int x_end) {
+    gaussian.SharpenColumns(*blurred, image, x_begin, x_end, amount,
+                            threshold);
+  });
+  delete blurred;
+}
+
+void ImageFilters::MotionBlur(PixelBuffer* image, float amount,
+                              MotionBlurDirection direction) {
+  TRACE_SCOPE("ImageFilters::MotionBlur", "filter");
+  FilterKernel kernel;
+  switch (direction) {
+    case MOTION_BLUR_N_S:
+      kernel.Init(amount, FilterKernel::BLUR_N_S);
+      break;
+    case MOTION_BLUR_E_W:
+      kernel.Init(amount, FilterKernel::BLUR_E_W);
+      break;
+    case MOTION_BLUR_NE_SW:
+      kernel.Init(amount, FilterKernel::BLUR_NE_SW);
+      break;
+    default:
+      kernel.Init(amount, FilterKernel::BLUR_NW_SE);
+      break;
+  }
+  ApplyConvolutionFilter(image, &kernel, 0.);
+}
+
+void ImageFilters::EdgeDetect(PixelBuffer* image) {
+  TRACE_SCOPE("ImageFilters::EdgeDetect", "filter");
+  FilterKernel kernel;
+  kernel.Init(1.5, FilterKernel::EDGE_DETECT);
+  ApplyConvolutionFilter(image, &kernel, 0.);
+}
+
+void ImageFilters::Threshold(PixelBuffer* image, float amount) {
+  TRACE_SCOPE("ImageFilters::Threshold", "filter");
+  float params[1] = {amount};
+  ApplyPixelFunction(image, &ThresholdColor, params);
+}
+
+void ImageFilters::Saturate(PixelBuffer* image, float amount) {
+  TRACE_SCOPE("ImageFilters::Saturate", "filter");
+  float params[1] = {amount};
+  ApplyPixelFunction(image, &SaturateColor, params);
+}
+
+void ImageFilters::Channel(PixelBuffer* image, float red, float green,
+                           float blue) {
+  TRACE_SCOPE("ImageFilters::Channel", "filter");
+  float params[3] = {red, green, blue};
+  ApplyPixelFunction(image, &ChannelColor, params);
+}
+
+void ImageFilters::Quantize(PixelBuffer* image, int bins) {
+  TRACE_SCOPE("ImageFilters::Quantize", "filter");
+  if (bins > 1) {
+    float params[1] = {static_cast<float>(bins)};
+    ApplyPixelFunction(image, &QuantizeColor, params);
+  }
+}
+
+void ImageFilters::Dither(PixelBuffer* image, int bins,
+                          DitherMethod method) {
+  TRACE_SCOPE("ImageFilters::Dither", "filter");
+  std::vector<float> carried_errors;
+  DitherBand(image, bins, method, &carried_errors);
+}
+
+void ImageFilters::DitherBand(PixelBuffer* band, int bins,
+                              DitherMethod method,
+                              std::vector<float>* carried_errors) {
+  if (bins < 2) {
+    return;
+  }
+  Ditherer::Method ditherer_method;
+  switch (method) {
+    case DITHER_BAYER:
+      ditherer_method = Ditherer::BAYER;
+      break;
+    case DITHER_BLUE_NOISE:
+      ditherer_method = Ditherer::BLUE_NOISE;
+      break;
+    case DITHER_FLOYD_STEINBERG:
+      ditherer_method = Ditherer::FLOYD_STEINBERG;
+      break;
+    default:
+      ditherer_method = Ditherer::ATKINSON;
+      break;
+  }
+  Ditherer ditherer(ditherer_method, bins);
+
+  int band_width = band->width();
+  int band_height = band->height();
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  if (ditherer.ordered()) {
+    scheduler.ParallelFor(0, band_height, 0, [&](int y_begin, int y_end) {
+      ditherer.OrderRows(band, y_begin, y_end);
+    });
+    return;
+  }
+
+  // The rows above come first, from the band before or zero
+  size_t row_floats = static_cast<size_t>(band_width) *
+                      Ditherer::kErrorChannels;
+  size_t carried_floats = Ditherer::kHistoryRows * row_floats;
+  std::vector<float> errors(carried_floats + band_height * row_floats);
+  carried_errors->resize(carried_floats, 0.f);
+  std::copy(carried_errors->begin(), carried_errors->end(), errors.begin());
+  float* band_errors = errors.data() + carried_floats;
+
+  // A wavefront: the blocks on each anti-diagonal only depend on those on
+  // the ones before it, so each anti-diagonal is diffused in parallel
+  int blocks_x = Ditherer::block_columns(band_width, band_height);
+  int blocks_y = (band_height + Ditherer::kBlockRows - 1) /
+                 Ditherer::kBlockRows;
+  for (int diagonal = 0; diagonal < blocks_x + blocks_y - 1; diagonal++) {
+    int first_y = std::max(0, diagonal - blocks_x + 1);
+    int last_y = std::min(blocks_y - 1, diagonal);
+    scheduler.ParallelFor(first_y, last_y + 1, 1,
+                          [&](int y_begin, int y_end) {
+      for (int block_y = y_begin; block_y < y_end; block_y++) {
+        ditherer.DiffuseBlock(band, band_errors, block_y,
+                              diagonal - block_y);
+      }
+    });
+  }
+  std::copy(errors.end() - carried_floats, errors.end(),
+            carried_errors->begin());
+}
+
+void ImageFilters::Median(PixelBuffer* image, int radius,
+                          float percentile) {
+  TRACE_SCOPE("ImageFilters::Median", "filter");
+  RankFilter filter(radius, percentile);
+  if (filter.identity()) {
+    return;
+  }
+
+  PixelBuffer* buffer_copy = image->Copy();
+  TaskScheduler::Instance().ParallelForTiles(
+    image->width(), image->height(), filter.tile_size(),
+    [&](int x_begin, int y_begin, int x_end, int y_end) {
+      filter.FilterTile(*buffer_copy, image, x_begin, y_begin, x_end, y_end);
+    });
+  delete buffer_copy;
+}
+
+void ImageFilters::Morphology(PixelBuffer* image,
+                              MorphologyOperation operation, int radius_x,
+                              int radius_y, bool grayscale) {
+  TRACE_SCOPE("ImageFilters::Morphology", "filter");
+  // Opening and closing undo their first pass with the opposite one
+  bool dilate_first = (operation == MORPHOLOGY_DILATE ||
+                       operation == MORPHOLOGY_CLOSE);
+  int passes = (operation == MORPHOLOGY_OPEN ||
+                operation == MORPHOLOGY_CLOSE) ? 2 : 1;
+
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  for (int pass = 0; pass < passes; pass++) {
+    MorphologyPass morphology(dilate_first != (pass == 1), radius_x,
+                              radius_y, grayscale);
+    if (morphology.identity()) {
+      return;
+    }
+
+    // Every row is filtered before any column, as for the Gaussian blur
+    scheduler.ParallelFor(0, image->height(), 0, [&](int y_begin, int y_end) {
+      morphology.FilterRows(image, y_begin, y_end);
+    });
+    scheduler.ParallelFor(0, image->width(), 0, [&](int x_begin, int x_end) {
+      morphology.FilterColumns(image, x_begin, x_end);
+    });
+  }
+}
+
+void ImageFilters::Bilateral(PixelBuffer* image, float sigma_spatial,
+                             float sigma_range, int origin_x, int origin_y) {
+  TRACE_SCOPE("ImageFilters::Bilateral", "filter");
+  BilateralGrid grid(image->width(), image->height(), sigma_spatial,
+                     sigma_range, origin_x, origin_y);
+  if (grid.identity()) {
+    return;
+  }
+
+  // Each step covers the whole grid before the next starts
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  scheduler.ParallelFor(0, grid.rows(), 0, [&](int row_begin, int row_end) {
+    grid.SplatRows(*image, row_begin, row_end);
+    grid.BlurRows(row_begin, row_end);
+  });
+  scheduler.ParallelFor(0, grid.rows(), 0, [&](int row_begin, int row_end) {
+    grid.BlurColumns(row_begin, row_end);
+  });
+  scheduler.ParallelFor(0, image->height(), 0, [&](int y_begin, int y_end) {
+    grid.SliceRows(image, y_begin, y_end);
+  });
+}
+
+void ImageFilters::Special(PixelBuffer* image) {
+  TRACE_SCOPE("ImageFilters::Special", "filter");
+  FilterKernel kernel;
+  kernel.Init(1.5, FilterKernel::EMBOSS);
+  ApplyConvolutionFilter(image, &kernel, .5);
+}
+
+void ImageFilters::ApplyConvolutionFilter(PixelBuffer* image,
+                                          FilterKernel* kernel,
+                                          float bias) {
+  int image_width = image->width();
+  int image_height = image->height();
+
+  PixelBuffer* buffer_copy = image->Copy();
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+
+  int fft_size = FftConvolution::ChooseFftSize(*kernel, image_width,
+                                               image_height);
+  if (fft_size > 0) {
+    FftConvolution convolution(*kernel, fft_size);
+    int tile_size = convolution.tile_size();
+    int tiles_x = (image_width + tile_size - 1) / tile_size;
+    int tiles_y = (image_height + tile_size - 1) / tile_size;
+    image->FillPixelBufferWithColor(ColorData(0., 0., 0., 0.));
+
+    // Neighboring tiles add to each other's edges, so the tiles are summed
+    // in four rounds, each of tiles two apart both ways
+    for (int round = 0; round < 4; round++) {
+      int first_x = round % 2;
+      int first_y = round / 2;
+      int round_x = (tiles_x - first_x + 1) / 2;
+      int round_y = (tiles_y - first_y + 1) / 2;
+      scheduler.ParallelFor(0, round_x * round_y, 1,
+                            [&](int tile_begin, int tile_end) {
+        for (int tile = tile_begin; tile < tile_end; tile++) {
+          int x = (first_x + 2 * (tile % round_x)) * tile_size;
+          int y = (first_y + 2 * (tile / round_x)) * tile_size;
+          convolution.AddTile(*buffer_copy, x, y, image);
+        }
+      });
+    }
+    scheduler.ParallelFor(0, image_height, 0, [&](int y_begin, int y_end) {
+      convolution.Finish(image, y_begin, y_end, bias);
+    });
+  } else {
+    // Each task filters one contiguous band of rows
+    scheduler.ParallelFor(0, image_height, 0, [&](int y_begin, int y_end) {
+      kernel->ApplyRows(*buffer_copy, image, y_begin, y_end, bias);
+    });
+  }
+
+  delete buffer_copy;
+}
+
+void ImageFilters::ApplyPixelFunction(
+    PixelBuffer* image,
+    ColorData (*function)(const ColorData& color, const float* params),
+    const float* params) {
+  int image_width = image->width();
+  int image_height = image->height();
+
+  TaskScheduler::Instance().ParallelFor(0, image_height, 0,
+                                        [&](int y_begin, int y_end) {
+    for (int buffer_y = y_begin; buffer_y < y_end; buffer_y++) {
+      for (int buffer_x = 0; buffer_x < image_width; buffer_x++) {
+        image->set_valid_pixel(
+          buffer_x, buffer_y, (*function)(
+            image->get_pixel(buffer_x, buffer_y), params));
+      }
+    }
+  });
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * Name            : image_pyramid.cc
+ * Project         : FlashPhoto
+ * Module          : image_pyramid
+ * Description     : Implementation of the ImagePyramid class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/image_pyramid.h"
+#include <algorithm>
+#include <cmath>
+#include "include/task_scheduler.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+ImagePyramid::ImagePyramid(void) : base_(nullptr), levels_(), dirty_(),
+                                   tiles_x_() {}
+
+ImagePyramid::~ImagePyramid(void) {
+  Clear();
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void ImagePyramid::Clear(void) {
+  for (PixelBuffer* level : levels_) {
+    delete level;
+  }
+  levels_.clear();
+  dirty_.clear();
+  tiles_x_.clear();
+  base_ = nullptr;
+}
+
+void ImagePyramid::Reset(const PixelBuffer* base) {
+  TRACE_SCOPE("ImagePyramid::Reset", "render");
+  Clear();
+  base_ = base;
+  if (!base_) {
+    return;
+  }
+
+  int width = base_->width();
+  int height = base_->height();
+  while (width > kMinLevelSize || height > kMinLevelSize) {
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+    levels_.push_back(new PixelBuffer(width, height, ColorData()));
+  }
+
+  // Only levels with a level after them need to track what has changed.
+  for (int level = 0; level + 1 < level_count(); level++) {
+    int tiles_x = (this->level(level)->width() + kTileSize - 1) / kTileSize;
+    int tiles_y = (this->level(level)->height() + kTileSize - 1) / kTileSize;
+    tiles_x_.push_back(tiles_x);
+    dirty_.push_back(std::vector<char>(tiles_x * tiles_y, 1));
+  }
+}
+
+void ImagePyramid::MarkDirty(int x, int y, int width, int height) {
+  if (!dirty_.empty()) {
+    MarkLevelDirty(0, x, y, width, height);
+  }
+}
+
+void ImagePyramid::MarkAllDirty(void) {
+  for (std::vector<char>& tiles : dirty_) {
+    std::fill(tiles.begin(), tiles.end(), 1);
+  }
+}
+
+void ImagePyramid::MarkLevelDirty(int level, int x, int y, int width,
+                                  int height) {
+  const PixelBuffer* image = this->level(level);
+  int x_begin = std::max(0, x);
+  int y_begin = std::max(0, y);
+  int x_end = std::min(image->width(), x + width);
+  int y_end = std::min(image->height(), y + height);
+  if (x_begin >= x_end || y_begin >= y_end) {
+    return;
+  }
+
+  int tiles_x = tiles_x_[level];
+  for (int tile_y = y_begin / kTileSize; tile_y <= (y_end - 1) / kTileSize;
+       tile_y++) {
+    for (int tile_x = x_begin / kTileSize;
+         tile_x <= (x_end - 1) / kTileSize; tile_x++) {
+      dirty_[level][tile_y * tiles_x + tile_x] = 1;
+    }
+  }
+}
+
+void ImagePyramid::Update(void) {
+  TRACE_SCOPE("ImagePyramid::Update", "render");
+  std::vector<int> tiles;
+  for (int level = 0; level + 1 < level_count(); level++) {
+    std::vector<char>& dirty = dirty_[level];
+    tiles.clear();
+    for (int tile = 0; tile < static_cast<int>(dirty.size()); tile++) {
+      if (dirty[tile]) {
+        tiles.push_back(tile);
+        dirty[tile] = 0;
+      }
+    }
+    if (tiles.empty()) {
+      continue;
+    }
+
+    int tiles_x = tiles_x_[level];
+    int tile_count = static_cast<int>(tiles.size());
+    TaskScheduler::Instance().ParallelFor(0, tile_count, 1,
+                                          [&](int i_begin, int i_end) {
+      for (int i = i_begin; i < i_end; i++) {
+        DownsampleTile(level, tiles[i] % tiles_x, tiles[i] / tiles_x);
+      }
+    });
+
+    if (level + 2 < level_count()) {
+      const int half_tile = kTileSize / 2;
+      for (int tile : tiles) {
+        MarkLevelDirty(level + 1, (tile % tiles_x) * half_tile,
+                       (tile / tiles_x) * half_tile, half_tile, half_tile);
+      }
+    }
+  }
+}
+
+void ImagePyramid::DownsampleTile(int level, int tile_x, int tile_y) {
+  PixelBuffer* target = levels_[level];
+  const int half_tile = kTileSize / 2;
+  int x_begin = tile_x * half_tile;
+  int y_begin = tile_y * half_tile;
+  Halve(*this->level(level), target, x_begin, y_begin,
+        std::min(target->width(), x_begin + half_tile),
+        std::min(target->height(), y_begin + half_tile));
+}
+
+void ImagePyramid::Halve(const PixelBuffer& source, PixelBuffer* target,
+                         int x_begin, int y_begin, int x_end, int y_end) {
+  int source_width = source.width();
+  int source_height = source.height();
+  for (int y = y_begin; y < y_end; y++) {
+    // An odd last row or column is averaged with itself.
+    const ColorData* upper = source.row(2 * y);
+    const ColorData* lower = source.row(std::min(2 * y + 1,
+                                                 source_height - 1));
+    ColorData* out = target->row(y);
+    for (int x = x_begin; x < x_end; x++) {
+      int left = 2 * x;
+      int right = std::min(left + 1, source_width - 1);
+      out[x] = (upper[left] + upper[right] + lower[left] + lower[right]) *
+               0.25f;
+    }
+  }
+}
+
+int ImagePyramid::LevelForScale(double scale) const {
+  if (scale >= 1.0 || level_count() == 0) {
+    return 0;
+  }
+  int level = static_cast<int>(std::floor(std::log2(1.0 / scale)));
+  return std::min(level, level_count() - 1);
+}
+
+size_t ImagePyramid::bytes(void) const {
+  size_t total = 0;
+  for (const PixelBuffer* level : levels_) {
+    total += sizeof(ColorData) * level->width() * level->height();
+  }
+  return total;
+}
+
+}  /* namespace image_tools */
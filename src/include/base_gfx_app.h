@@ -91,12 +91,47 @@ class BaseGfxApp {
       int height,
       void const *const pixels);
 
+  /**
+   * @brief Draw part of an array of pixel data on the screen, scaled.
+   *
+   * @param[in] window_x The window position of the region's lower left
+   * corner, which may be outside the window
+   * @param[in] window_y As window_x, from the bottom of the window
+   * @param[in] zoom Window pixels per pixel of data
+   * @param[in] row_length The width of the whole array
+   * @param[in] skip_x The first column of the region
+   * @param[in] skip_rows The first row of the region, counting up from the
+   * bottom row of the array
+   * @param[in] width The size of the region
+   * @param[in] height The size of the region
+   * @param[in] pixels The whole array, bottom row first
+   */
+  void DrawPixelRegion(
+      double window_x,
+      double window_y,
+      double zoom,
+      int row_length,
+      int skip_x,
+      int skip_rows,
+      int width,
+      int height,
+      void const *const pixels);
+
   /**
    * @brief Redraw the screen.
    * @param[in] delta_time_ms Milliseconds since the last redraw of the screen
    */
   virtual void Update(int delta_time_ms) {}
 
+  /**
+   * @brief Have Update() called once, after the given delay, from the GLUT
+   * event loop. Useful for polling work running on another thread without
+   * keeping an idle callback spinning.
+   *
+   * @param[in] delay_ms Milliseconds to wait before calling Update()
+   */
+  void ScheduleUpdate(int delay_ms);
+
   /**
    * @brief Callback for mouse moving interface event in the GLUT window
    * Note that (0,0) is in the lower right corner of the image, (this is what is
@@ -233,6 +268,7 @@ class BaseGfxApp {
   static void s_draw(void);
   static void s_gluicallback(int control_id);
   static void s_idle(void);
+  static void s_timer(int value);
 
   /**
    * @brief Get the drag
@@ -0,0 +1,238 @@
+/*******************************************************************************
+ * Name            : batch_processor.h
+ * Project         : FlashPhoto
+ * Module          : batch_processor
+ * Description     : Header for the BatchProcessor class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_BATCH_PROCESSOR_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_BATCH_PROCESSOR_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "./encode_settings.h"
+#include "./image_filters.h"
+#include "./pixel_buffer.h"
+#include "./tiled_image.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief One filter to apply, with its parameters, as given on the command
+ * line.
+ */
+struct FilterOperation {
+  enum Type {
+    BLUR,
+    GAUSSIAN_BLUR,
+    SHARPEN,
+    UNSHARP_MASK,
+    MOTION_BLUR,
+    EDGE_DETECT,
+    THRESHOLD,
+    SATURATE,
+    CHANNEL,
+    QUANTIZE,
+    DITHER,
+    MEDIAN,
+    MORPHOLOGY,
+    BILATERAL,
+    SPECIAL
+  };
+
+  FilterOperation(void) : type(BLUR), amount(0.0), red(1.0), green(1.0),
+                          blue(1.0), bins(2),
+                          direction(ImageFilters::MOTION_BLUR_E_W),
+                          dither(ImageFilters::DITHER_FLOYD_STEINBERG),
+                          percentile(0.5),
+                          morphology(ImageFilters::MORPHOLOGY_ERODE),
+                          radius_x(0), radius_y(0), grayscale(false),
+                          range_sigma(0.1), unsharp_amount(1.0),
+                          unsharp_threshold(0.0) {}
+
+  /**
+   * @brief Parse a filter specification of the form name[:params], e.g.
+   * "blur:5", "gaussian:40", "motionblur:10:ns", "channel:1.2,1,0.8" or
+   * "dither:4:bayer", "median:3:0.25", "open:20,4:gray",
+   * "bilateral:16:0.1" or "unsharp:2:1.5:0.02".
+   *
+   * @param[in] spec The specification
+   * @param[out] operation The parsed operation
+   *
+   * @return TRUE if the specification was valid
+   */
+  static bool Parse(const std::string& spec, FilterOperation* operation);
+
+  /**
+   * @brief Apply the operation to an image in place
+   */
+  void Apply(PixelBuffer* image) const;
+
+  /**
+   * @brief Apply the operation to a region of a larger image in place,
+   * given where the region's top left pixel lies in it, so that filters
+   * that work on a grid of their own line it up with the whole image's
+   */
+  void Apply(PixelBuffer* image, int x, int y) const;
+
+  /**
+   * @brief The number of pixels around a pixel that its result depends on
+   */
+  int halo(void) const;
+
+  /**
+   * @brief The same operation for an image shrunk by a factor, with its
+   * radius scaled to match, e.g. to preview it on a reduced copy
+   */
+  FilterOperation Scaled(int scale) const;
+
+  /**
+   * @brief Apply the operation to an out-of-core image a tile at a time.
+   * Each tile is filtered with a border of its neighbors' pixels, so the
+   * result is the same as Apply() on the whole image. Convolution filters
+   * write to a second tile file that then replaces the image's. Dithering
+   * goes a full-width row of tiles at a time, carrying its error down.
+   *
+   * @return FALSE if the second tile file could not be created
+   */
+  bool ApplyTiled(TiledImage* image) const;
+
+  Type type;
+  /**
+   * Blur/sharpen/motion blur/threshold/saturation amount, Gaussian or
+   * bilateral spatial sigma, unsharp mask radius or median radius
+   */
+  float amount;
+  float red;
+  float green;
+  float blue;
+  /** Quantize/dither values per channel */
+  int bins;
+  ImageFilters::MotionBlurDirection direction;
+  ImageFilters::DitherMethod dither;
+  float percentile;
+  ImageFilters::MorphologyOperation morphology;
+  int radius_x;
+  int radius_y;
+  bool grayscale;
+  /** Bilateral range sigma */
+  float range_sigma;
+  float unsharp_amount;
+  float unsharp_threshold;
+};
+
+/**
+ * @brief How long each stage of processing one image took.
+ */
+struct BatchTiming {
+  BatchTiming(void) : input(), output(), succeeded(false), load_ms(0.0),
+                      filter_ms(0.0), save_ms(0.0) {}
+  std::string input;
+  std::string output;
+  bool succeeded;
+  double load_ms;
+  double filter_ms;
+  double save_ms;
+};
+
+/**
+ * @brief Loads images, applies a fixed sequence of filters and saves the
+ * results using only the image processing core (ImageFilters and ImageCodec),
+ * so it links without GLUT/GLUI/OpenGL. A directory of images is processed by
+ * a bounded pool of worker threads.
+ */
+class BatchProcessor {
+ public:
+  /**
+   * @brief The default size above which images are processed out of core:
+   * 128 megapixels, 2 GB as float pixels
+   */
+  static const int64_t kDefaultOutOfCorePixels = 128LL << 20;
+
+  explicit BatchProcessor(const std::vector<FilterOperation>& operations);
+
+  /**
+   * @brief The most images processed at once by ProcessDirectory()
+   */
+  void set_max_threads(int max_threads) { max_threads_ = max_threads; }
+  void set_encode_profile(EncodeProfile profile) { encode_profile_ = profile; }
+  void set_jpeg_quality(int quality) { jpeg_quality_ = quality; }
+
+  /**
+   * @brief Images of more than this many pixels are processed out of core,
+   * in tile files in tile_directory (empty for $TMPDIR)
+   */
+  void set_out_of_core_pixels(int64_t pixels) { out_of_core_pixels_ = pixels; }
+  void set_tile_directory(const std::string& directory) {
+    tile_directory_ = directory;
+  }
+
+  /**
+   * @brief Process a single image on the calling thread. Images larger than
+   * the out-of-core size are streamed through a tile file instead of being
+   * loaded into memory.
+   *
+   * @param[in] input The image to load
+   * @param[in] output The file to save the result to
+   * @param[out] timing Receives the stage timings
+   *
+   * @return TRUE on success
+   */
+  bool ProcessImage(const std::string& input, const std::string& output,
+                    BatchTiming* timing) const;
+
+  /**
+   * @brief Process every image in a directory, writing results with the same
+   * names to the output directory (created if needed), optionally changing
+   * their format.
+   *
+   * @param[in] input_dir The directory to read images from
+   * @param[in] output_dir The directory to write results to
+   * @param[in] output_suffix Suffix replacing each input's, e.g. ".png", or
+   * empty to keep the input format
+   *
+   * @return TRUE if every image was processed
+   */
+  bool ProcessDirectory(const std::string& input_dir,
+                        const std::string& output_dir,
+                        const std::string& output_suffix) const;
+
+  /**
+   * @brief Print one line summarizing an image's timings
+   */
+  static void PrintTiming(const BatchTiming& timing);
+
+ private:
+  /**
+   * @brief ProcessImage() for images too large for memory, streamed through
+   * a TiledImage
+   */
+  bool ProcessImageOutOfCore(const std::string& input,
+                             const std::string& output,
+                             BatchTiming* timing) const;
+
+  std::vector<FilterOperation> operations_;
+  int max_threads_;
+  EncodeProfile encode_profile_;
+  int jpeg_quality_;
+  int64_t out_of_core_pixels_;
+  std::string tile_directory_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_BATCH_PROCESSOR_H_ */
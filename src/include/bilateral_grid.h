@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Name            : bilateral_grid.h
+ * Project         : FlashPhoto
+ * Module          : bilateral_grid
+ * Description     : Header for the BilateralGrid class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_BILATERAL_GRID_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_BILATERAL_GRID_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <vector>
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief An edge-preserving bilateral filter approximated on a bilateral
+ * grid (Paris and Durand; Chen, Paris and Durand).
+ *
+ * The grid has one cell per spatial sigma across and down the image, and
+ * one per range sigma of luminance. Each pixel's color, with a weight of
+ * one, is added to the cell nearest it (splat); the grid is blurred by
+ * 1-4-6-4-1 along each of its three axes, a Gaussian of one cell; and each
+ * pixel's new color is read back by trilinear interpolation at its own
+ * position and luminance and divided by the weight found there (slice).
+ * Pixels across an edge land in distant cells along the luminance axis, so
+ * they barely mix.
+ *
+ * The grid is the image's size divided by the spatial sigma squared, so the
+ * cost is a splat and a slice per pixel plus a blur that shrinks as the
+ * sigma grows. Rows of cells are splatted and blurred across independently,
+ * so SplatRows() then BlurRows() can be split across threads by rows, as
+ * can BlurColumns() once every row is done, and then SliceRows() by rows of
+ * pixels.
+ */
+class BilateralGrid {
+ public:
+  /** Spatial sigmas are raised to this, to bound the grid's size */
+  static const float kMinSpatialSigma;
+
+  /** Range sigmas are raised to this, likewise */
+  static const float kMinRangeSigma;
+
+  /** Cells around the image, so the blur never reaches past the grid */
+  static const int kPadding = 2;
+
+  /**
+   * @param[in] width The width of the image to filter
+   * @param[in] height The height of the image to filter
+   * @param[in] sigma_spatial The spatial sigma, in pixels
+   * @param[in] sigma_range The range sigma, on the luminance's [0, 1]
+   * @param[in] origin_x The column of the image's left edge in the picture
+   * it is a part of, so that tiles of it use the same cells
+   * @param[in] origin_y The row of its top edge, likewise
+   */
+  BilateralGrid(int width, int height, float sigma_spatial,
+                float sigma_range, int origin_x, int origin_y);
+
+  /**
+   * @return Whether the filter would leave the image unchanged
+   */
+  bool identity(void) const { return identity_; }
+
+  /**
+   * @return How many pixels away a pixel still has an effect: the splat,
+   * blur and slice each reach further by a cell or so
+   */
+  static int halo(float sigma_spatial);
+
+  /**
+   * @return The number of rows of cells
+   */
+  int rows(void) const { return rows_; }
+
+  /**
+   * @brief Clear rows [row_begin, row_end) of cells and add to them the
+   * pixels of the image nearest them
+   */
+  void SplatRows(const PixelBuffer& image, int row_begin, int row_end);
+
+  /**
+   * @brief Blur rows [row_begin, row_end) of cells across and along the
+   * luminance, in place
+   */
+  void BlurRows(int row_begin, int row_end);
+
+  /**
+   * @brief Blur rows [row_begin, row_end) of cells down, into a second
+   * grid that SliceRows() reads
+   */
+  void BlurColumns(int row_begin, int row_end);
+
+  /**
+   * @brief Replace the colors of rows [y_begin, y_end) of the image with
+   * those read from the blurred grid. Alpha is kept.
+   */
+  void SliceRows(PixelBuffer* image, int y_begin, int y_end) const;
+
+ private:
+  /**
+   * @return The cell, counted across the whole picture, nearest a pixel
+   * that far from its edge
+   */
+  int nearest(int pixels) const {
+    return static_cast<int>(pixels * spatial_scale_ + 0.5f);
+  }
+
+  /**
+   * @return The index of cell (column, row, level)'s first float
+   */
+  int cell(int column, int row, int level) const {
+    return ((row * columns_ + column) * levels_ + level) * kCellFloats;
+  }
+
+  /** Red, green, blue and weight */
+  static const int kCellFloats = 4;
+
+  bool identity_;
+  float spatial_scale_;  /**< Cells per pixel */
+  float range_scale_;    /**< Cells per unit of luminance */
+  int origin_x_;
+  int origin_y_;
+  int first_column_;     /**< nearest() the image's left edge, less padding */
+  int first_row_;        /**< nearest() its top edge, less padding */
+  int columns_;
+  int rows_;
+  int levels_;
+  std::vector<float> cells_;
+  std::vector<float> blurred_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_BILATERAL_GRID_H_ */
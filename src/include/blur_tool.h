@@ -37,10 +37,13 @@ class BlurTool : public Brush {
     BlurTool(ToolBelt* my_toolbelt, int diameter) :
             Brush(my_toolbelt, diameter,
                   static_cast<double>(diameter / 2), .5, false) {
-      filter_kernel_array_ = new FilterKernel*[diameter + 1];
+      kernel_count_ = diameter + 1;
+      filter_kernel_array_ = new FilterKernel*[kernel_count_]();
       set_blur_mask();
     }
 
+    virtual ~BlurTool(void);
+
  private:
     /**
      * @brief Uses the mask_ data member set via the call to the constructor
@@ -73,6 +76,7 @@ class BlurTool : public Brush {
      * is equal to the kernel size.
      */
     FilterKernel** filter_kernel_array_ = nullptr;
+    int kernel_count_ = 0;
 };
 }  // namespace image_tools
 
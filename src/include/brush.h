@@ -80,13 +80,7 @@ class Brush: public Tool {
     /**
      * @brief Destructor for brushes, deletes the mask
      */
-    virtual ~Brush(void) {
-      if (mask_) {
-        for (int mask_row = 0; mask_row < mask_size_; mask_row++) {
-          delete mask_[mask_row];
-        }
-      }
-    }
+    virtual ~Brush(void) { clear_mask(); }
 
     /**
      * @brief Draws the brush's mask on the canvas, centered at the mouse
@@ -107,6 +101,8 @@ class Brush: public Tool {
     virtual void ApplyDragged(int x1, int y1,
                               int x2, int y2);
 
+    virtual int mask_size(void) const { return mask_size_; }
+
  protected:
     /**
      * @brief Sets the mask of the brush to a rectangular shape of intensity values
@@ -134,6 +130,11 @@ class Brush: public Tool {
                          double intensity_center,
                          double intensity_outer);
 
+    /**
+     * @brief Frees the mask, if any.
+     */
+    void clear_mask(void);
+
     /**
      * Grid of color intensity values that are applied to the canvas when drawing
      * with the brush, using the active color as set from the application UI.
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Name            : canvas_history.h
+ * Project         : FlashPhoto
+ * Module          : state_manager
+ * Description     : Header for the CanvasHistory class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_HISTORY_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_HISTORY_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stack>
+#include "./color_data.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief The undo/redo stacks of canvas states.
+ *
+ * The top of the undo stack is always the current state of the canvas, so
+ * there is something to undo only while the undo stack holds more than one
+ * state. Registering a new state discards everything that could be redone,
+ * then evicts the oldest states while the undo subsystem is over its
+ * MemoryAccounting budget, so a long session's history stays within a fixed
+ * number of bytes however large the canvas is. The current state and the one
+ * before it are always kept, so a single undo works even over budget.
+ *
+ * This is part of the image processing core; StateManager binds it to the
+ * GLUI undo/redo buttons.
+ */
+class CanvasHistory {
+ public:
+  CanvasHistory(void) : undo_stack_(), redo_stack_(), evicted_states_(0) {}
+  ~CanvasHistory(void) { Clear(); }
+
+  /**
+   * @brief Push a new canvas state, taking ownership of it
+   *
+   * @param[in] pixels The array of pixels to be pushed onto the stack, from
+   * PixelBuffer::GetAllPixels(); it is counted as undo memory from now on
+   */
+  void RegisterNewState(ColorData* pixels);
+
+  /**
+   * @brief Step back one state
+   *
+   * @return The state now current (still owned by the history)
+   */
+  ColorData* Undo(void);
+
+  /**
+   * @brief Step forward one state
+   *
+   * @return The state now current (still owned by the history)
+   */
+  ColorData* Redo(void);
+
+  /**
+   * @brief Discard every state
+   */
+  void Clear(void);
+
+  bool can_undo(void) const { return undo_stack_.size() > 1; }
+  bool can_redo(void) const { return !redo_stack_.empty(); }
+
+  /**
+   * @brief The number of states on each stack; the undo stack includes the
+   * current state
+   */
+  size_t undo_depth(void) const { return undo_stack_.size(); }
+  size_t redo_depth(void) const { return redo_stack_.size(); }
+
+  /**
+   * @brief The number of states evicted to keep within the budget
+   */
+  size_t evicted_states(void) const { return evicted_states_; }
+
+  /**
+   * @brief The bytes the history may hold (the MEMORY_UNDO budget)
+   */
+  static int64_t max_bytes(void);
+
+  /**
+   * @brief Change the budget, evicting states at once if now over it
+   */
+  void set_max_bytes(int64_t max_bytes);
+
+ private:
+  CanvasHistory(const CanvasHistory &rhs) = delete;
+  CanvasHistory& operator=(const CanvasHistory &rhs) = delete;
+
+  void ClearRedoStack(void);
+  void ClearUndoStack(void);
+  void TrimUndoStack(void);
+
+  /* Oldest state at the front, current state at the back */
+  std::deque<ColorData *> undo_stack_;
+  std::stack<ColorData *> redo_stack_;
+  size_t evicted_states_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_HISTORY_H_ */
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Name            : canvas_viewport.h
+ * Project         : FlashPhoto
+ * Module          : canvas_viewport
+ * Description     : Header for the CanvasViewport class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_VIEWPORT_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_VIEWPORT_H_
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief The zoom and pan of the canvas within the window, and the mapping
+ * between window and canvas coordinates (both with the origin top left).
+ *
+ * When the zoomed canvas is smaller than the window along an axis it is
+ * centered along that axis; otherwise it can be panned, but not past its
+ * edges.
+ */
+class CanvasViewport {
+ public:
+  /** The closest and furthest zoom allowed, in window pixels per canvas pixel */
+  static const double kMaxZoom;
+  static const double kMinZoom;
+
+  CanvasViewport(void);
+
+  void set_canvas_size(int width, int height);
+  void set_window_size(int width, int height);
+
+  /**
+   * @brief Show the whole canvas, at actual size if it fits in the window
+   * and shrunk to fit otherwise
+   */
+  void FitToWindow(void);
+
+  /**
+   * @brief Set the zoom, keeping the canvas point under a window position
+   * where it is
+   */
+  void ZoomAt(double zoom, int window_x, int window_y);
+
+  /**
+   * @brief Move the view by a distance in window pixels
+   */
+  void Pan(int window_dx, int window_dy);
+
+  /**
+   * @brief Convert a window position into canvas coordinates
+   */
+  void WindowToCanvas(int window_x, int window_y, int* canvas_x,
+                      int* canvas_y) const;
+
+  /**
+   * @brief The window position (x, and y from the top) of a canvas point
+   */
+  double CanvasToWindowX(double canvas_x) const;
+  double CanvasToWindowY(double canvas_y) const;
+
+  /**
+   * @brief The part of the canvas inside the window, as [x_begin, x_end) by
+   * [y_begin, y_end); empty if the canvas is entirely outside it
+   */
+  void VisibleRegion(int* x_begin, int* y_begin, int* x_end,
+                     int* y_end) const;
+
+  double zoom(void) const { return zoom_; }
+
+ private:
+  /**
+   * @brief Center the canvas along axes where it fits and keep its edges
+   * within the window along the others
+   */
+  void ClampOrigin(void);
+
+  int canvas_width_;
+  int canvas_height_;
+  int window_width_;
+  int window_height_;
+  double zoom_;
+  double origin_x_;  /**< Canvas position at the window's left edge */
+  double origin_y_;  /**< Canvas position at the window's top edge */
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_CANVAS_VIEWPORT_H_ */
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * Name            : ditherer.h
+ * Project         : FlashPhoto
+ * Module          : ditherer
+ * Description     : Header for the Ditherer class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_DITHERER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_DITHERER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <vector>
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Quantizes each color channel to a number of evenly spaced values,
+ * as ImageFilters::Quantize() does, while dithering so the average color of
+ * an area is kept.
+ *
+ * Ordered methods compare each pixel with a tiled threshold matrix, so every
+ * pixel is independent and OrderRows() can be split across threads freely.
+ *
+ * Error diffusion methods pass each pixel's rounding error on to the pixels
+ * after it: right, and below. Each pixel pulls the errors of the pixels
+ * before it, rather than pushing its own, so no two pixels write to the
+ * same place. A pixel only needs pixels up to one column to its right in
+ * the rows above, so with columns skewed by kSkew per row the image splits
+ * into blocks of kBlockRows x kBlockColumns that depend only on the blocks
+ * above and to the left. All blocks on one anti-diagonal can be diffused at
+ * once, and the result is the same however the work is split.
+ */
+class Ditherer {
+ public:
+  enum Method {
+    BAYER,           /**< 8x8 recursive (Bayer) threshold matrix */
+    BLUE_NOISE,      /**< 64x64 void-and-cluster threshold matrix */
+    FLOYD_STEINBERG, /**< Error spread to four neighbors, all of it */
+    ATKINSON         /**< Error spread to six neighbors, 3/4 of it */
+  };
+
+  /** Rows of the blocks error diffusion is scheduled in */
+  static const int kBlockRows = 8;
+
+  /** Width of the blocks, in skewed columns */
+  static const int kBlockColumns = 128;
+
+  /** Columns each row is shifted left by, relative to the row above */
+  static const int kSkew = 2;
+
+  /** Floats of error per pixel: red, green and blue */
+  static const int kErrorChannels = 3;
+
+  /** Rows above a pixel that it takes a share of the error of */
+  static const int kHistoryRows = 2;
+
+  /**
+   * @param[in] method How to dither
+   * @param[in] bins The number of values per channel, at least 2
+   */
+  Ditherer(Method method, int bins);
+
+  /**
+   * @return Whether each pixel is dithered independently (OrderRows())
+   * rather than by error diffusion (DiffuseBlock())
+   */
+  bool ordered(void) const { return method_ == BAYER ||
+                                    method_ == BLUE_NOISE; }
+
+  /**
+   * @return The number of blocks across a width x height image when it is
+   * diffused; there are (height + kBlockRows - 1) / kBlockRows down
+   */
+  static int block_columns(int width, int height);
+
+  /**
+   * @brief Dither rows [y_begin, y_end) of the image in place with the
+   * threshold matrix
+   */
+  void OrderRows(PixelBuffer* image, int y_begin, int y_end) const;
+
+  /**
+   * @brief Dither one block of the image in place by error diffusion. The
+   * blocks above and to the left of it, (block_y - 1, block_x),
+   * (block_y - 1, block_x - 1) and (block_y, block_x - 1), must be done.
+   *
+   * @param[in,out] image The image
+   * @param[in,out] errors Each pixel's red, green and blue rounding error,
+   * by rows; written for the block's pixels. kHistoryRows rows before it
+   * hold the errors of the rows above the image, or 0.
+   * @param[in] block_y The block's row, counting kBlockRows rows
+   * @param[in] block_x The block's column, counting kBlockColumns skewed
+   * columns
+   */
+  void DiffuseBlock(PixelBuffer* image, float* errors, int block_y,
+                    int block_x) const;
+
+ private:
+  /**
+   * @brief One neighbor a pixel takes a share of the error of
+   */
+  struct Tap {
+    int dx;
+    int dy;
+    float weight;
+  };
+
+  Method method_;
+  float levels_;   /**< bins - 1 */
+  int matrix_size_;
+  /** Thresholds in (0, 1), matrix_size_ x matrix_size_ by rows */
+  std::vector<float> thresholds_;
+  std::vector<Tap> taps_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_DITHERER_H_ */
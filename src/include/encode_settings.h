@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Name            : encode_settings.h
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Tunable settings and named profiles for the image encoders
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_ENCODE_SETTINGS_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_ENCODE_SETTINGS_H_
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/**
+ * @brief Named trade-offs between encode speed and file size.
+ */
+enum EncodeProfile {
+  ENCODE_PROFILE_STORE,     /**< No compression at all; for scratch files */
+  ENCODE_PROFILE_FASTEST,   /**< Cheapest compression; intermediate files */
+  ENCODE_PROFILE_BALANCED,  /**< The libpng/libjpeg defaults */
+  ENCODE_PROFILE_SMALLEST,  /**< Smallest output; deliverables */
+  ENCODE_PROFILE_COUNT
+};
+
+/**
+ * @brief How each PNG scanline's filter type is chosen.
+ */
+enum PngFilterHeuristic {
+  PNG_FILTER_HEURISTIC_ADAPTIVE,  /**< Per row, min sum of magnitudes */
+  PNG_FILTER_HEURISTIC_NONE,
+  PNG_FILTER_HEURISTIC_SUB,
+  PNG_FILTER_HEURISTIC_UP,
+  PNG_FILTER_HEURISTIC_AVERAGE,
+  PNG_FILTER_HEURISTIC_PAETH
+};
+
+/**
+ * @brief The zlib deflate strategy for PNG image data.
+ */
+enum PngDeflateStrategy {
+  PNG_STRATEGY_DEFAULT,
+  PNG_STRATEGY_FILTERED,
+  PNG_STRATEGY_HUFFMAN_ONLY,
+  PNG_STRATEGY_RLE
+};
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Settings for PngEncoder.
+ */
+struct PngEncodeSettings {
+  PngEncodeSettings(void) : compression_level(6),
+                            filter(PNG_FILTER_HEURISTIC_ADAPTIVE),
+                            strategy(PNG_STRATEGY_DEFAULT) {}
+
+  /**
+   * @brief Get the settings for a profile
+   */
+  static PngEncodeSettings ForProfile(EncodeProfile profile);
+
+  int compression_level; /**< zlib level, 0 (store) to 9 */
+  PngFilterHeuristic filter;
+  PngDeflateStrategy strategy;
+};
+
+/**
+ * @brief Settings for JpegEncoder.
+ */
+struct JpegEncodeSettings {
+  JpegEncodeSettings(void) : quality(75), progressive(false),
+                             optimize_coding(false), fast_dct(false),
+                             parallel_strips(true) {}
+
+  /**
+   * @brief Get the settings for a profile
+   *
+   * @param[in] profile The profile
+   * @param[in] quality The quality to use, 1 to 100
+   */
+  static JpegEncodeSettings ForProfile(EncodeProfile profile, int quality);
+
+  int quality; /**< libjpeg quality, 1 to 100 */
+  bool progressive; /**< Write a progressive rather than baseline JPEG */
+  bool optimize_coding; /**< Compute optimal Huffman tables (a second pass) */
+  bool fast_dct; /**< JDCT_IFAST instead of JDCT_ISLOW */
+
+  /**
+   * Entropy code strips of the image on separate threads. Only possible for
+   * baseline JPEGs with the standard Huffman tables; ignored otherwise.
+   */
+  bool parallel_strips;
+};
+
+/**
+ * @brief Get a human readable name for a profile
+ */
+const char* EncodeProfileName(EncodeProfile profile);
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_ENCODE_SETTINGS_H_ */
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * Name            : fft.h
+ * Project         : FlashPhoto
+ * Module          : fft
+ * Description     : Header for the Fft class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_FFT_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_FFT_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <complex>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief An iterative radix-2 fast Fourier transform of a fixed power-of-two
+ * size, in one dimension or over a square of that size.
+ *
+ * The bit-reversal permutation and twiddle factors are computed once by the
+ * constructor, after which Transform() and Transform2D() only read them, so
+ * one Fft can be shared by threads transforming their own data.
+ */
+class Fft {
+ public:
+  typedef std::complex<double> Complex;
+
+  /**
+   * @param[in] size The length of the transform; a power of two
+   */
+  explicit Fft(int size);
+
+  int size(void) const { return size_; }
+
+  /**
+   * @brief Transform size values in place. The inverse is not scaled: a
+   * forward and inverse transform multiply by size.
+   */
+  void Transform(Complex* data, bool inverse) const;
+
+  /**
+   * @brief Transform a size x size square, stored by rows, in place: each
+   * row and then each column. The result is left transposed, which a
+   * transform the other way undoes, so a forward and inverse transform
+   * restore the layout and multiply by size * size.
+   *
+   * @param[in,out] data The square
+   * @param[in] rows Only rows [0, rows) of the input are non-zero
+   * @param[in] inverse Whether to transform back
+   */
+  void Transform2D(Complex* data, int rows, bool inverse) const;
+
+ private:
+  int size_;
+  std::vector<int> bit_reverse_;
+  std::vector<Complex> twiddles_; /**< e^(-2 pi i k / size), k < size / 2 */
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_FFT_H_ */
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Name            : fft_convolution.h
+ * Project         : FlashPhoto
+ * Module          : fft_convolution
+ * Description     : Header for the FftConvolution class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_FFT_CONVOLUTION_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_FFT_CONVOLUTION_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <vector>
+#include "./fft.h"
+#include "./filter_kernel.h"
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Applies a FilterKernel by multiplying Fourier transforms, for large
+ * kernels with too many taps to sum at every pixel.
+ *
+ * The image is cut into square tiles (overlap-add): each is zero-padded to
+ * the transform size, convolved with the kernel and added into the result,
+ * including the border of kernel_size() / 2 it spreads into its neighbors.
+ * Memory therefore stays at two transforms per thread however large the
+ * image. Red and green, and blue and alpha, share a complex transform.
+ *
+ * Pixels outside the image count as zero, so once every tile is added
+ * Finish() divides by the weight of the taps that fall on the image, as
+ * FilterKernel::Apply() does.
+ */
+class FftConvolution {
+ public:
+  /** The smallest and largest transforms tried */
+  static const int kMinFftSize = 32;
+  static const int kMaxFftSize = 1024;
+
+  /**
+   * @brief Pick the transform size that makes filtering a width x height
+   * image cheapest, by a cost model measured against FilterKernel's
+   *
+   * @return The size, or 0 unless it is clearly cheaper than
+   * FilterKernel::ApplyRows()
+   */
+  static int ChooseFftSize(const FilterKernel& kernel, int width, int height);
+
+  /**
+   * @param[in] kernel The initialized kernel, which must outlive this
+   * @param[in] fft_size From ChooseFftSize()
+   */
+  FftConvolution(const FilterKernel& kernel, int fft_size);
+
+  /**
+   * @return The side of the tiles the image is cut into. Tiles two apart
+   * never add to the same pixel.
+   */
+  int tile_size(void) const { return tile_size_; }
+
+  /**
+   * @brief Convolve the tile at (x, y), top left, and add it into target
+   *
+   * @param[in] source The image
+   * @param[in] x The tile's left column, a multiple of tile_size()
+   * @param[in] y The tile's top row, a multiple of tile_size()
+   * @param[in,out] target Sums, the same size as source, that start at 0
+   */
+  void AddTile(const PixelBuffer& source, int x, int y,
+               PixelBuffer* target) const;
+
+  /**
+   * @brief Turn rows [y_begin, y_end) of the summed tiles into filtered
+   * colors: normalize, add the bias and clamp
+   */
+  void Finish(PixelBuffer* target, int y_begin, int y_end, float bias) const;
+
+ private:
+  /* Copy/move assignment/construction disallowed */
+  FftConvolution(const FftConvolution& rhs) = delete;
+  FftConvolution& operator=(const FftConvolution& rhs) = delete;
+
+  const FilterKernel& kernel_;
+  int radius_;
+  int tile_size_;
+  int total_weight_;
+  Fft fft_;
+  /** The transformed kernel, scaled to undo the transforms' gain */
+  std::vector<Fft::Complex> kernel_spectrum_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_FFT_CONVOLUTION_H_ */
@@ -16,7 +16,7 @@
  * Includes
  ******************************************************************************/
 #include <math.h>
-#include "GL/glui.h"
+#include <vector>
 #include "./pixel_buffer.h"
 
 /*******************************************************************************
@@ -31,14 +31,22 @@ namespace image_tools {
  ******************************************************************************/
 /**
  * @brief Manages the creation and application of convolution filters
+ *
+ * Init() compiles the kernel into its non-zero taps, merged into runs of
+ * horizontally adjacent taps of equal weight and grouped by weight, so
+ * Apply() does work in proportion to the taps rather than the kernel's
+ * area: a motion blur has kernel_size taps and a sharpen 2 * kernel_size - 1.
+ *
+ * 3x3 and 5x5 kernels, which edge detect, emboss and small blurs use, are
+ * also matched to a stencil compiled for their fixed weights, which
+ * ApplyRows() runs on every pixel whose taps all fall on the image.
  */
 
 class FilterKernel {
  public:
-  FilterKernel() { kernel_ = nullptr;
-                   kernel_function_ = &Blur; }
+  FilterKernel() : runs_(), stencil_(nullptr), kernel_function_(&Blur) {}
 
-  ~FilterKernel() { if (kernel_ != nullptr) delete kernel_; }
+  ~FilterKernel() { FreeKernel(); }
   
   enum ConvolutionFilter {
     BLUR,
@@ -63,7 +71,20 @@ class FilterKernel {
    * @return The color produced by the convolution filter to be put at buffer_x, buffer_y
    */
   ColorData Apply(
-    PixelBuffer *buffer_copy, int buffer_x, int buffer_y, float bias);
+    const PixelBuffer *buffer_copy, int buffer_x, int buffer_y,
+    float bias) const;
+
+  /**
+   * @brief Applies the convolution filter to rows of an image
+   *
+   * @param source The image to filter, not modified
+   * @param target Where the filtered rows go; the same size as source
+   * @param y_begin The first row (0 is the top)
+   * @param y_end One past the last row
+   * @param bias The offset for the colors returned by the filter
+   */
+  void ApplyRows(const PixelBuffer& source, PixelBuffer* target, int y_begin,
+                 int y_end, float bias) const;
   
   /**
    * @brief Initializes our kernel with a certain filter function and a radius
@@ -75,7 +96,62 @@ class FilterKernel {
    */
   void Init(const double filter_amount, ConvolutionFilter filter_type);
 
+  /**
+   * @brief The width (and height) of the kernel Init() makes for an amount
+   */
+  static int KernelSize(double filter_amount);
+
+  /**
+   * @return The number of non-zero taps, which Apply() costs in proportion to
+   */
+  int tap_count(void) const;
+
+  /**
+   * @return The number of runs the taps are merged into; each costs Apply()
+   * a few taps' worth of clipping and setup
+   */
+  int run_count(void) const { return static_cast<int>(runs_.size()); }
+
+  int kernel_size(void) const { return kernel_size_; }
+
+  /**
+   * @return The weights of the kernel, kernel_size() by kernel_size(), by
+   * rows from the top
+   */
+  std::vector<int> Weights(void) const;
+
+  /**
+   * @brief The sum of the weights of the taps that fall on a width x height
+   * image around a pixel, which Apply() divides its result by when positive
+   */
+  int ValidWeight(int buffer_x, int buffer_y, int width, int height) const;
+
  private:
+  /**
+   * @brief A run of horizontally adjacent taps of equal weight, relative to
+   * the pixel being filtered
+   */
+  struct TapRun {
+    int dy;
+    int dx_begin;
+    int length;
+    int weight;
+  };
+
+  /**
+   * @brief Filters pixels [x_begin, x_end) of row y, all of whose taps are
+   * on the image, with weights fixed at compile time
+   */
+  typedef void (*StencilFunction)(const PixelBuffer& source, int y,
+                                  int x_begin, int x_end, float bias,
+                                  ColorData* out);
+
+  /**
+   * @brief The compiled stencil for a filter and kernel size, or nullptr
+   */
+  static StencilFunction FindStencil(ConvolutionFilter filter_type,
+                                     int kernel_size);
+
   /**
    * @brief Get the value of the blur kernel at the column coordinate x, and row coordinate y
    * @param x The column coordinate x
@@ -171,8 +247,18 @@ class FilterKernel {
    */
   static int Emboss(int x, int y, int kernel_size);
 
+  /**
+   * @brief Free the kernel's taps, if any
+   */
+  void FreeKernel(void);
+
+  /* The kernel accounts for its taps' memory, so it must not be copied */
+  FilterKernel(const FilterKernel& rhs) = delete;
+  FilterKernel& operator=(const FilterKernel& rhs) = delete;
+
   int kernel_size_ = 0;
-  float* kernel_ = nullptr;
+  std::vector<TapRun> runs_; /**< Grouped by weight, rows in order within */
+  StencilFunction stencil_;
   int (*kernel_function_)(int x, int y, int kernel_size);
 };
 
@@ -16,11 +16,9 @@
  * Includes
  ******************************************************************************/
 #include "GL/glui.h"
-#include "./filter_kernel.h"
+#include "./batch_processor.h"
 #include "./pixel_buffer.h"
 #include "./ui_ctrl.h"
-#include "./io_manager.h"
-#include "./state_manager.h"
 
 /*******************************************************************************
  * Namespaces
@@ -34,6 +32,9 @@ namespace image_tools {
  * @brief Manager for all aspects of filters in FlashPhoto, including
  * initialization of GLUI control elements for filters, filter creation,
  * application, deletion.
+ *
+ * The filters themselves live in ImageFilters, in the image processing core;
+ * this class binds their parameters to the GLUI controls.
  */
 
 class FilterManager {
@@ -50,11 +51,60 @@ class FilterManager {
     pixel_buffer_ = pixel_buffer;
   }
 
+  /**
+   * @brief Filter parameters, normally bound to the GLUI spinners. Setting
+   * them directly allows the filters to be driven without a GUI.
+   */
+  void set_blur_amount(float amount) { blur_amount_ = amount; }
+  void set_gaussian_sigma(float sigma) { gaussian_sigma_ = sigma; }
+  void set_sharpen_amount(float amount) { sharpen_amount_ = amount; }
+  void set_unsharp_mask(bool enabled, float amount, float threshold) {
+    sharpen_unsharp_ = enabled;
+    unsharp_amount_ = amount;
+    unsharp_threshold_ = threshold;
+  }
+  void set_motion_blur(float amount,
+                       enum UICtrl::MotionBlurDirection direction) {
+    motion_blur_amount_ = amount;
+    motion_blur_direction_ = direction;
+  }
+  void set_threshold_amount(float amount) { threshold_amount_ = amount; }
+  void set_saturation_amount(float amount) { saturation_amount_ = amount; }
+  void set_channel_colors(float red, float green, float blue) {
+    channel_color_red_ = red;
+    channel_color_green_ = green;
+    channel_color_blue_ = blue;
+  }
+  void set_quantize_bins(int bins) { quantize_bins_ = bins; }
+  void set_dither_method(enum UICtrl::DitherMethod method) {
+    dither_method_ = method;
+  }
+  void set_median(int radius, float percentile) {
+    median_radius_ = radius;
+    median_percentile_ = percentile;
+  }
+  void set_morphology(enum UICtrl::MorphologyOperation operation,
+                      int radius_x, int radius_y, bool grayscale) {
+    morphology_operation_ = operation;
+    morphology_radius_x_ = radius_x;
+    morphology_radius_y_ = radius_y;
+    morphology_grayscale_ = grayscale;
+  }
+  void set_bilateral(float sigma_spatial, float sigma_range) {
+    bilateral_sigma_spatial_ = sigma_spatial;
+    bilateral_sigma_range_ = sigma_range;
+  }
+
   /**
    * @brief Apply a blur filter to the buffer, blurring sharply defined edges
    */
   void ApplyBlur(void);
 
+  /**
+   * @brief Apply a Gaussian blur to the buffer
+   */
+  void ApplyGaussianBlur(void);
+
   /**
    * @brief Apply a sharpening filter to the buffer, sharpening blurry/undefined
    * edges
@@ -92,89 +142,86 @@ class FilterManager {
   void ApplyQuantize(void);
 
   /**
-   * @brief Apply a special filter to the buffer
-   *
+   * @brief Apply the quantization filter to the buffer with dithering
    */
-  void ApplySpecial(void);
+  void ApplyDither(void);
 
   /**
-   * @brief Initialize the elements of the GLUI interface required by the
-   * FilterManager
-   *
-   * @param[in] glui GLUI handle
-   * @param[in] s_gluicallback Callback to install
+   * @brief Apply a median (or other percentile) filter to the buffer,
+   * removing specks
    */
-  void InitGlui(const GLUI *const glui,
-                void (*s_gluicallback)(int));
+  void ApplyMedian(void);
 
- private:
   /**
-   * @brief Apply a convolution filter (i.e. a filter that requires a kernel) to the canvas
-   *
-   * @param[in] bias The bias, which specifies an offset for the color produced on the canvas
+   * @brief Apply an erosion, dilation, opening or closing to the buffer
    */
-  void ApplyConvolutionFilter(float bias);
-  
+  void ApplyMorphology(void);
+
   /**
-   * @brief Apply a non-convolution filter to the canvas
-   *
-   * @param[in] non_convolution_function The non-convolution function to be used
+   * @brief Apply an edge-preserving bilateral filter to the buffer,
+   * smoothing areas of similar color
    */
-  void ApplyNonConvolutionFilter(
-          ColorData (FilterManager::* non_convolution_function)(int x, int y));
+  void ApplyBilateral(void);
+
   /**
-   * @brief Change the red, blue, green values of a color to 0 or 1 depending on if it's greater than, or less than the threshold value
+   * @brief Apply a special filter to the buffer
    *
-   * @param[in] x The column index of the pixel in the pixel buffer
-   * @param[in] y The row index of the pixel in the pixel buffer
-   * 
-   * @return The color at x,y with the threshold function applied
    */
-  ColorData Threshold(int x, int y);
-  
+  void ApplySpecial(void);
+
   /**
-   * @brief Scale the red, blue, green values of a color according to the saturate value
-   *
-   * @param[in] x The column index of the pixel in the pixel buffer
-   * @param[in] y The row index of the pixel in the pixel buffer
-   * 
-   * @return The color at x,y scaled by the saturate value
+   * @brief Whether filters are previewed as their parameters change
    */
-  ColorData Saturate(int x, int y);
-  
+  bool preview_enabled(void) const { return preview_enabled_ != 0; }
+
   /**
-   * @brief Scale the red, blue, green channels according to the different channel factors
+   * @brief The filter an Apply button or parameter control belongs to, with
+   * the current parameters, e.g. for previewing
+   *
+   * @param[in] control_id A UICtrl::UI_APPLY_* or UI_PREVIEW_* control
+   * @param[out] operation The filter
    *
-   * @param[in] x The column index of the pixel in the pixel buffer
-   * @param[in] y The row index of the pixel in the pixel buffer
-   * 
-   * @return The color at x,y with its r, g, b values scaled independently
+   * @return FALSE if the control does not belong to a filter
    */
-  ColorData Channel(int x, int y);
-  
+  bool OperationFor(int control_id, FilterOperation* operation) const;
+
   /**
-   * @brief Constrain all of the colors in the image to a set number of colors
+   * @brief Initialize the elements of the GLUI interface required by the
+   * FilterManager
    *
-   * @param[in] x The column index of the pixel in the pixel buffer
-   * @param[in] y The row index of the pixel in the pixel buffer
-   * 
-   * @return The binned color at x, y
+   * @param[in] glui GLUI handle
+   * @param[in] s_gluicallback Callback to install
    */
-  ColorData Quantize(int x, int y);
+  void InitGlui(const GLUI *const glui,
+                void (*s_gluicallback)(int));
 
+ private:
   float channel_color_red_;
   float channel_color_green_;
   float channel_color_blue_;
   float saturation_amount_;
   float threshold_amount_;
   float blur_amount_;
+  float gaussian_sigma_;
   float sharpen_amount_;
+  int sharpen_unsharp_;
+  float unsharp_amount_;
+  float unsharp_threshold_;
   float motion_blur_amount_;
   enum UICtrl::MotionBlurDirection motion_blur_direction_;
   int quantize_bins_;
+  enum UICtrl::DitherMethod dither_method_;
+  int median_radius_;
+  float median_percentile_;
+  enum UICtrl::MorphologyOperation morphology_operation_;
+  int morphology_radius_x_;
+  int morphology_radius_y_;
+  int morphology_grayscale_;
+  float bilateral_sigma_spatial_;
+  float bilateral_sigma_range_;
+  int preview_enabled_;
 
   PixelBuffer* pixel_buffer_;
-  FilterKernel kernel_;
 };
 
 }  /* namespace image_tools */
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Name            : filter_preview.h
+ * Project         : FlashPhoto
+ * Module          : filter_preview
+ * Description     : Header for the FilterPreview class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_FILTER_PREVIEW_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_FILTER_PREVIEW_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include "./batch_processor.h"
+#include "./io_progress.h"
+#include "./pixel_buffer.h"
+#include "./task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Renders a filter as an interactive task over a small part of an
+ * image, typically the visible region of a reduced copy of the canvas, so
+ * the effect of a parameter can be seen while it is being changed.
+ *
+ * The region is filtered a band of rows at a time, and starting another
+ * preview or calling Cancel() stops the one in flight at the next band, so
+ * a stream of parameter changes never queues up renders.
+ */
+class FilterPreview {
+ public:
+  /** Rows filtered between checks for cancellation */
+  static const int kBandRows = 32;
+
+  FilterPreview(void);
+  ~FilterPreview(void);
+
+  /**
+   * @brief Cancel any preview and start rendering a new one
+   *
+   * @param[in] source The image to preview on; pixels beyond the region are
+   * read as the filter's border, and it is copied before this returns
+   * @param[in] x The region to filter
+   * @param[in] y The region to filter
+   * @param[in] width The region to filter
+   * @param[in] height The region to filter
+   * @param[in] scale How many times smaller than the canvas source is, which
+   * the filter's radius is scaled by
+   * @param[in] operation The filter and its parameters at full size
+   */
+  void Start(const PixelBuffer& source, int x, int y, int width, int height,
+             int scale, const FilterOperation& operation);
+
+  /**
+   * @brief Stop any render in flight and drop the result
+   */
+  void Cancel(void);
+
+  /**
+   * @brief Check on the render in flight
+   *
+   * @return TRUE once, when a render has just finished and its result
+   * replaced the previous one
+   */
+  bool Poll(void);
+
+  /**
+   * @return Whether a render is in flight
+   */
+  bool running(void) const { return rendering_; }
+
+  /**
+   * @return The last finished preview, covering the region it was started
+   * with, or nullptr if there is none
+   */
+  const PixelBuffer* result(void) const { return result_; }
+  int x(void) const { return x_; }
+  int y(void) const { return y_; }
+  int scale(void) const { return scale_; }
+
+  /**
+   * @return How long the last finished preview took to render
+   */
+  double render_ms(void) const { return render_ms_; }
+
+ private:
+  /* Copy/move assignment/construction disallowed */
+  FilterPreview(const FilterPreview& rhs) = delete;
+  FilterPreview& operator=(const FilterPreview& rhs) = delete;
+
+  /**
+   * @brief The task: filter pending_source_ into pending_result_ a band at
+   * a time
+   */
+  void Render(FilterOperation operation, int border_x, int border_y,
+              int width, int height);
+
+  /**
+   * @brief Stop the task and free what it was working on
+   */
+  void StopRender(void);
+
+  TaskGroup render_task_;
+  bool rendering_; /**< Started and not yet polled or stopped */
+  IOProgress progress_;
+  std::atomic<bool> done_;
+  PixelBuffer* pending_source_; /**< The region and its border */
+  PixelBuffer* pending_result_;
+  int pending_x_;
+  int pending_y_;
+  int pending_scale_;
+  double pending_ms_;
+  PixelBuffer* result_;
+  int x_;
+  int y_;
+  int scale_;
+  double render_ms_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_FILTER_PREVIEW_H_ */
@@ -24,6 +24,12 @@
 #include "./ui_ctrl.h"
 #include "./state_manager.h"
 #include "./toolbelt.h"
+#include "./perf_hud.h"
+#include "./image_pyramid.h"
+#include "./canvas_viewport.h"
+#include "./filter_preview.h"
+#include "./progressive_filter.h"
+#include "./task_scheduler.h"
 
 /*******************************************************************************
  * Namespaces
@@ -42,9 +48,32 @@ class FlashPhotoApp : public BaseGfxApp {
   void MouseMoved(int x, int y);
   void LeftMouseDown(int x, int y);
   void LeftMouseUp(int x, int y);
+
+  /**
+   * @brief Keyboard shortcuts: H shows/hides the performance overlay. T
+   * starts tracing, and pressing it again writes the trace (to
+   * $FLASHPHOTO_TRACE or flashphoto_trace.json) for chrome://tracing.
+   * Setting FLASHPHOTO_TRACE traces from startup. + and - zoom around the
+   * mouse, 0 fits the canvas to the window and 1 shows it at actual size.
+   */
+  void Keyboard(unsigned char c, int x, int y);
+
+  /**
+   * @brief The arrow keys pan a zoomed-in canvas
+   */
+  void KeyboardSpecial(int key, int x, int y);
   void Display(void);
+  void RenderOneFrame(void);
   void GluiControl(int control_id);
 
+  /**
+   * @brief Poll the background image load/save, installing a freshly loaded
+   * canvas once it has been fully decoded.
+   *
+   * @param[in] delta_time_ms Milliseconds since the last update
+   */
+  void Update(int delta_time_ms);
+
   /**
    * @brief Initialize the FlashPhotoApp
    *
@@ -61,6 +90,13 @@ class FlashPhotoApp : public BaseGfxApp {
       int y,
       ColorData background_color);
 
+  /**
+   * @brief Replace the canvas. The app takes ownership of the new buffer and
+   * frees the one it replaces.
+   *
+   * @param[in] new_pixel_buffer The new canvas
+   * @param[in] reset_state_manager Whether to discard the undo/redo history
+   */
   void set_pixel_buffer(
     PixelBuffer *new_pixel_buffer, bool reset_state_manager);
 
@@ -94,6 +130,13 @@ class FlashPhotoApp : public BaseGfxApp {
   FlashPhotoApp(const FlashPhotoApp &rhs) = delete;
   FlashPhotoApp& operator=(const FlashPhotoApp &rhs) = delete;
 
+  /**
+   * @brief The workers every filter, codec, preview and background load or
+   * save runs on; installed as the scheduler while the app exists, and
+   * declared first so it outlives everything that queues tasks on it
+   */
+  TaskScheduler scheduler_;
+
   /**
    * @brief Manager for all filter operations
    */
@@ -145,6 +188,104 @@ class FlashPhotoApp : public BaseGfxApp {
     int x;
     int y;
   } last_draw_location_;
+
+  /**
+   * @brief Start tracing, or stop and write the trace to trace_file_
+   */
+  void ToggleTracing(void);
+
+  /** The file traces are written to */
+  std::string trace_file_;
+
+  /**
+   * @brief Apply a filter, timing it for the overlay, and save the result
+   * as a new undo state. Convolution filters on large canvases are applied
+   * progressively in the background, and the undo state is saved when they
+   * finish.
+   *
+   * @param[in] control_id The filter's Apply button
+   * @param[in] apply The FilterManager method that applies the filter
+   * @param[in] name The name of the filter, for the overlay
+   */
+  void ApplyFilter(int control_id, void (FilterManager::*apply)(void),
+                   const char* name);
+
+  /**
+   * @brief Put the result of a finished progressive filter on the canvas
+   * and save it as a new undo state
+   */
+  void FinishProgressiveFilter(void);
+
+  /**
+   * @brief Stop a progressive filter in progress, leaving the canvas and
+   * undo history as they were before it started
+   */
+  void CancelProgressiveFilter(void);
+
+  /** The filter being applied in the background, coarse to fine */
+  ProgressiveFilter progressive_;
+
+  /** The name of that filter and how many of its tiles have been drawn */
+  const char* progressive_name_;
+  int progressive_tiles_drawn_;
+
+  /** Performance overlay */
+  PerfHud hud_;
+
+  /**
+   * @brief Size the window to the canvas, up to a maximum, and show the
+   * whole canvas in it
+   */
+  void FitWindowToCanvas(void);
+
+  /** Reduced copies of the canvas to draw from when zoomed out */
+  ImagePyramid pyramid_;
+
+  /** The zoom and pan of the canvas in the window */
+  CanvasViewport viewport_;
+
+  /**
+   * @brief The pyramid level the canvas is drawn from at the current zoom,
+   * and the part of it in the window
+   */
+  void VisibleLevelRegion(int* level, int* x_begin, int* y_begin, int* x_end,
+                          int* y_end) const;
+
+  /**
+   * @brief Draw part of an image whose pixels each cover scale x scale
+   * canvas pixels
+   *
+   * @param[in] image The image
+   * @param[in] origin_x The image's position, in units of its own pixels
+   * @param[in] origin_y The image's position, in units of its own pixels
+   * @param[in] scale Canvas pixels per image pixel
+   * @param[in] x_begin The part of the image to draw
+   * @param[in] y_begin The part of the image to draw
+   * @param[in] x_end The part of the image to draw
+   * @param[in] y_end The part of the image to draw
+   *
+   * @return The bytes of pixels drawn
+   */
+  size_t DrawScaled(const PixelBuffer& image, int origin_x, int origin_y,
+                    int scale, int x_begin, int y_begin, int x_end,
+                    int y_end);
+
+  /**
+   * @brief Preview the filter a parameter control belongs to over the
+   * visible part of the canvas, replacing any preview in progress
+   */
+  void StartPreview(int control_id);
+
+  /**
+   * @brief Stop previewing and remove the preview from the canvas
+   */
+  void CancelPreview(void);
+
+  /** The filter being previewed while its parameters are adjusted */
+  FilterPreview preview_;
+
+  /** The control whose filter is being previewed, or -1 */
+  int preview_control_;
 };
 
 }  /* namespace image_tools */
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * Name            : image_codec.h
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Header for the ImageCodec class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_CODEC_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_CODEC_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <string>
+#include "./pixel_buffer.h"
+#include "./tiled_image.h"
+#include "./io_progress.h"
+#include "./encode_settings.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Reads and writes PNG and JPEG files, choosing the format from the
+ * file name's suffix.
+ *
+ * This is part of the image processing core: it has no GUI dependencies, only
+ * touches its arguments, and so is safe to call from any thread. The progress,
+ * if not nullptr, is advanced once per scanline and checked for cancellation.
+ */
+class ImageCodec {
+ public:
+  /**
+   * @brief Decode an image file
+   *
+   * @param[in] file_name The file to load
+   * @param[in] composite_color_values Composite translucent pixels over the
+   * canvas background color (PNG only)
+   * @param[in] progress Progress/cancellation state, or nullptr
+   *
+   * @return The image, owned by the caller, or nullptr on error/cancellation
+   */
+  static PixelBuffer* Load(const std::string& file_name,
+                           bool composite_color_values,
+                           IOProgress* progress);
+
+  /**
+   * @brief Encode an image to a file
+   *
+   * @param[in] image The image to save
+   * @param[in] file_name The file to write
+   * @param[in] png_settings The settings used if the file is a PNG
+   * @param[in] jpeg_settings The settings used if the file is a JPEG
+   * @param[in] progress Progress/cancellation state, or nullptr
+   *
+   * @return TRUE if the file was written
+   */
+  static bool Save(const PixelBuffer& image,
+                   const std::string& file_name,
+                   const PngEncodeSettings& png_settings,
+                   const JpegEncodeSettings& jpeg_settings,
+                   IOProgress* progress);
+
+  /**
+   * @brief Read an image file's width and height without decoding it
+   *
+   * @return TRUE if the file could be read
+   */
+  static bool ReadDimensions(const std::string& file_name, int* width,
+                             int* height);
+
+  /**
+   * @brief Decode an image file a row at a time into a TiledImage, so that
+   * only the row of tiles being written is resident. Interlaced PNGs cannot
+   * be streamed.
+   *
+   * @param[in] file_name The file to load
+   * @param[in] composite_color_values As for Load()
+   * @param[in] tile_directory Where to put the tile file; empty for $TMPDIR
+   * @param[in] progress Progress/cancellation state, or nullptr
+   *
+   * @return The image, owned by the caller, or nullptr on error/cancellation
+   */
+  static TiledImage* LoadTiled(const std::string& file_name,
+                               bool composite_color_values,
+                               const std::string& tile_directory,
+                               IOProgress* progress);
+
+  /**
+   * @brief Encode a TiledImage a row at a time with libpng/libjpeg, keeping
+   * only the row of tiles being read resident. JPEGs are written baseline
+   * with standard Huffman tables, since progressive and optimized coding
+   * need the whole image in memory.
+   *
+   * @return TRUE if the file was written
+   */
+  static bool SaveTiled(TiledImage* image,
+                        const std::string& file_name,
+                        const PngEncodeSettings& png_settings,
+                        const JpegEncodeSettings& jpeg_settings,
+                        IOProgress* progress);
+
+  /**
+   * @brief Determine if a file name contains a given suffix
+   *
+   * @param[in] str The name of the file
+   * @param[in] suffix The suffix to be checked
+   *
+   * @return TRUE if yes, FALSE otherwise
+   */
+  static bool has_suffix(const std::string & str, const std::string & suffix) {
+    return str.find(suffix, str.length()-suffix.length()) != std::string::npos;
+  }
+
+  /**
+   * @brief Determine if a file has a valid name for an image file
+   *
+   * @param[in] name The name of the file
+   *
+   * @return TRUE if the file has a valid name for an image, FALSE otherwise
+   */
+  static bool is_valid_image_file_name(const std::string & name) {
+    return (has_suffix(name, ".png") || has_suffix(name, ".jpg")
+           || has_suffix(name, ".jpeg"));
+  }
+
+  static bool is_png_file_name(const std::string & name) {
+    return has_suffix(name, ".png");
+  }
+
+ private:
+  static PixelBuffer* LoadJPEG(const std::string& file_name,
+                               IOProgress* progress);
+  static PixelBuffer* LoadPNG(const std::string& file_name,
+                              bool composite_color_values,
+                              IOProgress* progress);
+  static TiledImage* LoadTiledJPEG(const std::string& file_name,
+                                   const std::string& tile_directory,
+                                   IOProgress* progress);
+  static TiledImage* LoadTiledPNG(const std::string& file_name,
+                                  bool composite_color_values,
+                                  const std::string& tile_directory,
+                                  IOProgress* progress);
+  static bool SaveTiledJPEG(TiledImage* image, const std::string& file_name,
+                            const JpegEncodeSettings& settings,
+                            IOProgress* progress);
+  static bool SaveTiledPNG(TiledImage* image, const std::string& file_name,
+                           const PngEncodeSettings& settings,
+                           IOProgress* progress);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_CODEC_H_ */
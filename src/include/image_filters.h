@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Name            : image_filters.h
+ * Project         : FlashPhoto
+ * Module          : image_filters
+ * Description     : Header for the ImageFilters class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_FILTERS_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_FILTERS_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <vector>
+#include "./pixel_buffer.h"
+#include "./color_data.h"
+#include "./filter_kernel.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief The FlashPhoto filters, applied in place to a PixelBuffer with
+ * explicitly given parameters.
+ *
+ * This is part of the image processing core: it has no GUI dependencies, so
+ * it can be driven by FilterManager, the batch processor or any other client.
+ */
+class ImageFilters {
+ public:
+  /**
+   * @brief The available directions for motion blurring.
+   */
+  enum MotionBlurDirection {
+    MOTION_BLUR_N_S,
+    MOTION_BLUR_E_W,
+    MOTION_BLUR_NE_SW,
+    MOTION_BLUR_NW_SE
+  };
+
+  /**
+   * @brief The available ways of dithering, ordered or by error diffusion.
+   */
+  enum DitherMethod {
+    DITHER_BAYER,
+    DITHER_BLUE_NOISE,
+    DITHER_FLOYD_STEINBERG,
+    DITHER_ATKINSON
+  };
+
+  /**
+   * @brief The available morphological operations.
+   */
+  enum MorphologyOperation {
+    MORPHOLOGY_ERODE,
+    MORPHOLOGY_DILATE,
+    MORPHOLOGY_OPEN,
+    MORPHOLOGY_CLOSE
+  };
+
+  /**
+   * @brief Blur the image, softening sharply defined edges
+   *
+   * @param[in] image The image to filter
+   * @param[in] amount The radius of the blur
+   */
+  static void Blur(PixelBuffer* image, float amount);
+
+  /**
+   * @brief Blur the image with a Gaussian, in time independent of its size
+   *
+   * @param[in] image The image to filter
+   * @param[in] sigma The standard deviation of the Gaussian, in pixels; the
+   * image is unchanged if < 0.5
+   */
+  static void GaussianBlur(PixelBuffer* image, float sigma);
+
+  /**
+   * @brief Sharpen blurry/undefined edges
+   *
+   * @param[in] image The image to filter
+   * @param[in] amount The radius of the sharpening
+   */
+  static void Sharpen(PixelBuffer* image, float amount);
+
+  /**
+   * @brief Sharpen the image by adding back the detail a Gaussian blur
+   * removes (an unsharp mask), in time independent of the radius
+   *
+   * @param[in] image The image to filter
+   * @param[in] radius The sigma of the blur; the image is unchanged if it is
+   * under 0.5
+   * @param[in] amount How much of the detail to add, e.g. 1 to double it
+   * @param[in] threshold The smallest difference from the blur, on [0, 1],
+   * that is sharpened, so flat areas and noise can be left alone
+   */
+  static void UnsharpMask(PixelBuffer* image, float radius, float amount,
+                          float threshold);
+
+  /**
+   * @brief Blur the image along one direction
+   *
+   * @param[in] image The image to filter
+   * @param[in] amount The length of the blur
+   * @param[in] direction The direction of the blur
+   */
+  static void MotionBlur(PixelBuffer* image, float amount,
+                         MotionBlurDirection direction);
+
+  /**
+   * @brief Replace the image with its edges
+   */
+  static void EdgeDetect(PixelBuffer* image);
+
+  /**
+   * @brief Set each color channel to 0 or 1 depending on whether it is below
+   * or at/above the threshold
+   */
+  static void Threshold(PixelBuffer* image, float amount);
+
+  /**
+   * @brief Scale the saturation of the image; a negative amount inverts the
+   * colors first
+   */
+  static void Saturate(PixelBuffer* image, float amount);
+
+  /**
+   * @brief Scale the red, green and blue channels independently
+   */
+  static void Channel(PixelBuffer* image, float red, float green, float blue);
+
+  /**
+   * @brief Constrain each color channel to a number of evenly spaced values
+   *
+   * @param[in] image The image to filter
+   * @param[in] bins The number of values; the image is unchanged if < 2
+   */
+  static void Quantize(PixelBuffer* image, int bins);
+
+  /**
+   * @brief Quantize the image as Quantize() does, dithering so that areas
+   * keep their average color
+   *
+   * @param[in] image The image to filter
+   * @param[in] bins The number of values; the image is unchanged if < 2
+   * @param[in] method Ordered dithering, which is independent per pixel, or
+   * error diffusion, which is the same however many threads run it
+   */
+  static void Dither(PixelBuffer* image, int bins, DitherMethod method);
+
+  /**
+   * @brief Dither one full-width band of a larger image, carrying error
+   * diffusion on from the band above, so dithering the bands top to bottom
+   * gives the same result as Dither() on the whole image. Ordered matrices
+   * start again at the top of the band, so bands should be a multiple of 64
+   * rows.
+   *
+   * @param[in] band The band to filter
+   * @param[in] bins The number of values; the band is unchanged if < 2
+   * @param[in] method How to dither
+   * @param[in,out] carried_errors The errors left by the band above, empty
+   * for the first; replaced with the errors this band leaves
+   */
+  static void DitherBand(PixelBuffer* band, int bins, DitherMethod method,
+                         std::vector<float>* carried_errors);
+
+  /**
+   * @brief Replace each pixel's color channels with a percentile of those
+   * around it, e.g. the median to remove specks and scanning noise, in time
+   * independent of the radius
+   *
+   * @param[in] image The image to filter
+   * @param[in] radius Pixels each way the window reaches, up to 127; the
+   * image is unchanged if < 1
+   * @param[in] percentile 0.5 for the median, 0 for the minimum and 1 for
+   * the maximum
+   */
+  static void Median(PixelBuffer* image, int radius, float percentile);
+
+  /**
+   * @brief Erode (minimum), dilate (maximum), open (erode, then dilate) or
+   * close (dilate, then erode) the image over a rectangle, in time
+   * independent of its size
+   *
+   * @param[in] image The image to filter
+   * @param[in] operation The operation
+   * @param[in] radius_x Pixels the rectangle reaches left and right
+   * @param[in] radius_y Pixels the rectangle reaches up and down
+   * @param[in] grayscale Whether to order pixels by luminance, so each
+   * result is the color of the darkest or brightest pixel in the rectangle,
+   * rather than filter each color channel
+   */
+  static void Morphology(PixelBuffer* image, MorphologyOperation operation,
+                         int radius_x, int radius_y, bool grayscale);
+
+  /**
+   * @brief Smooth the image while keeping its edges, with a bilateral
+   * filter approximated on a bilateral grid, in time close to linear in the
+   * image's size and nearly independent of the sigmas
+   *
+   * @param[in] image The image to filter
+   * @param[in] sigma_spatial How far colors are averaged, in pixels; raised
+   * to 4, and the image is unchanged if < 1
+   * @param[in] sigma_range How different two luminances can be and still
+   * be averaged, e.g. 0.1; raised to 0.05
+   * @param[in] origin_x Where the image's left edge lies in the picture it
+   * is a tile of, so tiles filtered apart match; 0 for a whole image
+   * @param[in] origin_y Where its top edge lies, likewise
+   */
+  static void Bilateral(PixelBuffer* image, float sigma_spatial,
+                        float sigma_range, int origin_x, int origin_y);
+
+  /**
+   * @brief Apply the special filter (emboss)
+   */
+  static void Special(PixelBuffer* image);
+
+ private:
+  /**
+   * @brief Apply a convolution filter to the image
+   *
+   * @param[in] image The image to filter
+   * @param[in] kernel The initialized kernel
+   * @param[in] bias An offset for the color produced
+   */
+  static void ApplyConvolutionFilter(PixelBuffer* image, FilterKernel* kernel,
+                                     float bias);
+
+  /**
+   * @brief Replace every pixel with a function of its own color
+   */
+  static void ApplyPixelFunction(PixelBuffer* image,
+                                 ColorData (*function)(const ColorData& color,
+                                                       const float* params),
+                                 const float* params);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_FILTERS_H_ */
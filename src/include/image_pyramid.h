@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Name            : image_pyramid.h
+ * Project         : FlashPhoto
+ * Module          : image_pyramid
+ * Description     : Header for the ImagePyramid class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_PYRAMID_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_PYRAMID_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+#include <vector>
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Successively halved copies of an image (a mip pyramid), so that a
+ * zoomed-out view can be drawn from a copy close to the size it is shown at.
+ *
+ * Level 0 is the image itself, which the pyramid does not own; each further
+ * level box-averages 2x2 blocks of the one before it. Changes to the image
+ * are reported with MarkDirty(), and Update() recomputes only the tiles of
+ * each level that cover them, so painting a stroke costs a fraction of the
+ * stroke's own area however many levels there are.
+ */
+class ImagePyramid {
+ public:
+  /** Side of the square tiles dirty regions are tracked in */
+  static const int kTileSize = 64;
+
+  /** Levels are added until both sides are at most this size */
+  static const int kMinLevelSize = 128;
+
+  ImagePyramid(void);
+  ~ImagePyramid(void);
+
+  /**
+   * @brief Rebuild the pyramid for a new image, which must outlive it or be
+   * replaced with another Reset(). Every level is dirty afterwards.
+   *
+   * @param[in] base The image, or nullptr to drop every level
+   */
+  void Reset(const PixelBuffer* base);
+
+  /**
+   * @brief Note that a rectangle of the image (in its coordinates, origin top
+   * left) has changed; it may extend past the image
+   */
+  void MarkDirty(int x, int y, int width, int height);
+
+  /**
+   * @brief Note that the whole image has changed
+   */
+  void MarkAllDirty(void);
+
+  /**
+   * @brief Recompute the dirty tiles of every level, coarsest last
+   */
+  void Update(void);
+
+  /**
+   * @return The number of levels, including the image itself
+   */
+  int level_count(void) const {
+    return base_ ? static_cast<int>(levels_.size()) + 1 : 0;
+  }
+
+  /**
+   * @return Level 0 (the image) to level_count() - 1 (the smallest)
+   */
+  const PixelBuffer* level(int index) const {
+    return (index == 0) ? base_ : levels_[index - 1];
+  }
+
+  /**
+   * @brief The level to draw at a scale (screen pixels per image pixel): the
+   * smallest one that still has at least one pixel per screen pixel
+   */
+  int LevelForScale(double scale) const;
+
+  /**
+   * @return The memory held by the levels other than the image itself
+   */
+  size_t bytes(void) const;
+
+  /**
+   * @brief Average the 2x2 blocks of an image into a rectangle of one half
+   * its size (rounded up), origin top left
+   *
+   * @param[in] source The image
+   * @param[out] target The halved image
+   * @param[in] x_begin The rectangle of target to compute
+   * @param[in] y_begin The rectangle of target to compute
+   * @param[in] x_end The rectangle of target to compute
+   * @param[in] y_end The rectangle of target to compute
+   */
+  static void Halve(const PixelBuffer& source, PixelBuffer* target,
+                    int x_begin, int y_begin, int x_end, int y_end);
+
+ private:
+  /* Copy/move assignment/construction disallowed */
+  ImagePyramid(const ImagePyramid& rhs) = delete;
+  ImagePyramid& operator=(const ImagePyramid& rhs) = delete;
+
+  void Clear(void);
+
+  /**
+   * @brief Average the 2x2 blocks of one tile of a level into the next
+   */
+  void DownsampleTile(int level, int tile_x, int tile_y);
+
+  /**
+   * @brief Mark the tiles of a level covering a rectangle of that level
+   */
+  void MarkLevelDirty(int level, int x, int y, int width, int height);
+
+  /** The image (level 0), not owned */
+  const PixelBuffer* base_;
+
+  /** Levels 1 and up */
+  std::vector<PixelBuffer*> levels_;
+
+  /**
+   * dirty_[level] holds a flag per tile of that level: whether the tile has
+   * changed since the next level was last computed from it
+   */
+  std::vector<std::vector<char> > dirty_;
+  std::vector<int> tiles_x_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_IMAGE_PYRAMID_H_ */
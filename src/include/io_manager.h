@@ -16,12 +16,15 @@
  * Includes
  ******************************************************************************/
 #include <string>
+#include <atomic>
+#include <chrono>
 #include "GL/glui.h"
 #include "./ui_ctrl.h"
-#include "./filter_kernel.h"
-#include "./filter_manager.h"
 #include "./pixel_buffer.h"
 #include "./color_data.h"
+#include "./io_progress.h"
+#include "./encode_settings.h"
+#include "./task_scheduler.h"
 #include "include/tool.h"
 #include "include/stamper.h"
 
@@ -43,8 +46,21 @@ namespace image_tools {
  */
 class IOManager {
  public:
+  /**
+   * @brief The state of the background load/save operation, as reported by
+   * PollAsyncOperation()
+   */
+  enum AsyncStatus {
+    ASYNC_IDLE,
+    ASYNC_RUNNING,
+    ASYNC_LOAD_FINISHED,
+    ASYNC_SAVE_FINISHED,
+    ASYNC_FAILED,
+    ASYNC_CANCELLED
+  };
+
   IOManager();
-  ~IOManager() {}
+  ~IOManager();
 
   /**
    * @brief Initialize GLUI control elements for IO management
@@ -76,6 +92,20 @@ class IOManager {
    */
   GLUI_FileBrowser* file_browser(void) { return file_browser_;}
 
+  /**
+   * @brief Choose the speed/size trade-off used when saving images
+   */
+  void set_encode_profile(EncodeProfile profile) { encode_profile_ = profile; }
+  EncodeProfile encode_profile(void) const {
+    return static_cast<EncodeProfile>(encode_profile_);
+  }
+
+  /**
+   * @brief Set the quality (1-100) used when saving JPEGs
+   */
+  void set_jpeg_quality(int quality) { jpeg_quality_ = quality; }
+  int jpeg_quality(void) const { return jpeg_quality_; }
+
   /**
    * @brief Load the selected image file to the canvas
    *
@@ -94,6 +124,49 @@ class IOManager {
    */
   void SaveCanvasToFile(PixelBuffer* pixel_buffer);
 
+  /**
+   * @brief Start decoding the selected image file on a worker thread. The
+   * decoded image is handed over by GetLoadedPixelBuffer() once
+   * PollAsyncOperation() reports ASYNC_LOAD_FINISHED.
+   *
+   * @return TRUE if the load was started, FALSE if another operation is
+   * already in progress
+   */
+  bool LoadImageToCanvasAsync(void);
+
+  /**
+   * @brief Snapshot the canvas and encode the snapshot to the selected file on
+   * a worker thread, so the canvas may keep being edited during the encode.
+   *
+   * @param[in] pixel_buffer The canvas to save
+   *
+   * @return TRUE if the save was started, FALSE if another operation is
+   * already in progress
+   */
+  bool SaveCanvasToFileAsync(PixelBuffer* pixel_buffer);
+
+  /**
+   * @brief Ask the background operation to stop at the next scanline. A
+   * cancelled load leaves the canvas untouched; a cancelled save removes the
+   * partially written file.
+   */
+  void CancelAsyncOperation(void);
+
+  /**
+   * @brief Check on the background operation. Must be called from the GLUI
+   * thread; it refreshes the progress display and, once the worker is done,
+   * joins it and reports the outcome exactly once.
+   *
+   * @return The status of the background operation
+   */
+  AsyncStatus PollAsyncOperation(void);
+
+  /**
+   * @brief Hand over the most recently loaded image. The caller takes
+   * ownership of the returned buffer.
+   *
+   * @return The loaded image, or nullptr if none is pending
+   */
   PixelBuffer* GetLoadedPixelBuffer(void);
 
  private:
@@ -112,43 +185,62 @@ class IOManager {
   void load_canvas_toggle(bool enabled) {
     UICtrl::button_toggle(load_canvas_btn_, enabled);
   }
-  /**
-   * @brief Determine if a file name contains a given suffix
-   *
-   * @param[in] str The name of the file
-   * @param[in] suffix The suffix to be checked
-   *
-   * @return TRUE if yes, FALSE otherwise
-   */
-  bool has_suffix(const std::string & str, const std::string & suffix) {
-    return str.find(suffix, str.length()-suffix.length()) != std::string::npos;
-  }
 
-  /**
-   * @brief Determine if a file has a valid name for an image file
-   *
-   * @param[in] name The name of the file
-   * 
-   * @return TRUE if the file has a valid name for an image, FALSE otherwise
-   */
-  bool is_valid_image_file_name(const std::string & name) {
-    return (has_suffix(name, ".png") || has_suffix(name, ".jpg")
-           || has_suffix(name, ".jpeg"));
+  void cancel_io_toggle(bool enabled) {
+    UICtrl::button_toggle(cancel_io_btn_, enabled);
   }
-
   struct ValidatedPixelBuffer {
     bool valid_image = false;
     PixelBuffer* pixel_buffer = nullptr;
   };
 
+  enum AsyncOperation {
+    ASYNC_OP_NONE,
+    ASYNC_OP_LOAD,
+    ASYNC_OP_SAVE
+  };
+
   PixelBuffer* loaded_pixel_buffer_ = nullptr;
 
-  ValidatedPixelBuffer LoadImageDataFromFile(bool composite_color_values);
-  ValidatedPixelBuffer LoadImageDataFromJPEGFile(void);
-  ValidatedPixelBuffer LoadImageDataFromPNGFile(bool composite_color_values);
+  /**
+   * @brief Load/save through ImageCodec with the current GLUI encode settings.
+   * They only touch their arguments and the settings, so they are safe to run
+   * on a worker thread. The progress, if not nullptr, is advanced once per
+   * scanline and checked for cancellation.
+   */
+  ValidatedPixelBuffer LoadImageDataFromFile(const std::string& file_name,
+                                             bool composite_color_values,
+                                             IOProgress* progress);
 
-  void SaveCanvasToJPEGFile(PixelBuffer* pixel_buffer);
-  void SaveCanvasToPNGFile(PixelBuffer* pixel_buffer);
+  bool SaveBufferToFile(PixelBuffer* pixel_buffer,
+                        const std::string& file_name,
+                        IOProgress* progress);
+
+  /**
+   * @brief Report the size of a file just saved and how long its encode took
+   */
+  void PrintEncodeStats(const std::string& file_name,
+                        EncodeProfile profile,
+                        std::chrono::steady_clock::time_point start);
+
+  /**
+   * @brief Start a background task for the given operation, disabling the
+   * load/save buttons until it is done.
+   */
+  void StartAsyncOperation(AsyncOperation operation, PixelBuffer* snapshot);
+
+  /**
+   * @brief Body of the background task.
+   */
+  void RunAsyncOperation(AsyncOperation operation, std::string file_name,
+                         PixelBuffer* snapshot);
+
+  /**
+   * @brief Wait for the background task, if any.
+   */
+  void JoinAsyncOperation(void);
+
+  void UpdateProgressLabel(const std::string& text);
 
   /**
    * @brief Determine if the name of a file corresponds to an image
@@ -171,7 +263,20 @@ class IOManager {
   GLUI_StaticText *current_file_label_;
   GLUI_EditText *file_name_box_;
   GLUI_StaticText *save_file_label_;
+  GLUI_StaticText *progress_label_;
+  GLUI_Button *cancel_io_btn_;
   std::string file_name_;
+  int parallel_jpeg_encode_; /**< Live var: parallel JPEG encode */
+  int encode_profile_; /**< Live var: an EncodeProfile */
+  int jpeg_quality_; /**< Live var: JPEG quality */
+
+  /* background load/save state */
+  TaskGroup async_task_;
+  AsyncOperation async_operation_;
+  IOProgress async_progress_;
+  std::atomic<bool> async_done_;
+  ValidatedPixelBuffer async_result_;
+  bool async_saved_;
 };
 
 }  /* namespace image_tools */
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * Name            : io_progress.h
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Header for the IOProgress class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_IO_PROGRESS_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_IO_PROGRESS_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Progress and cancellation state shared between an image decode or
+ * encode running on a worker thread and the thread that started it.
+ *
+ * The worker reports one step per scanline processed; the owner may read the
+ * progress and request cancellation at any time. A codec that observes a
+ * cancellation request stops at the next scanline boundary.
+ */
+class IOProgress {
+ public:
+  IOProgress(void) : rows_done_(0), rows_total_(0), cancel_requested_(false) {}
+
+  /**
+   * @brief Reset the progress counters for a new operation.
+   *
+   * @param[in] rows_total The number of scanlines the operation will process
+   */
+  void Reset(int rows_total) {
+    rows_done_.store(0);
+    rows_total_.store(rows_total);
+    cancel_requested_.store(false);
+  }
+
+  /**
+   * @brief Change the number of scanlines expected, once it is known (e.g.
+   * after an image header has been read).
+   */
+  void set_rows_total(int rows_total) { rows_total_.store(rows_total); }
+
+  /**
+   * @brief Record that another scanline has been processed.
+   */
+  void AdvanceRow(void) { rows_done_.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * @brief Ask the operation to stop at the next scanline boundary.
+   */
+  void RequestCancel(void) { cancel_requested_.store(true); }
+
+  bool cancel_requested(void) const { return cancel_requested_.load(); }
+
+  /**
+   * @brief Get the fraction of the operation completed so far
+   * @return A value in [0.0, 1.0]
+   */
+  float fraction_done(void) const {
+    int total = rows_total_.load();
+    if (total <= 0) return 0.f;
+    float fraction = static_cast<float>(rows_done_.load()) / total;
+    return (fraction > 1.f) ? 1.f : fraction;
+  }
+
+ private:
+  IOProgress(const IOProgress &rhs) = delete;
+  IOProgress& operator=(const IOProgress &rhs) = delete;
+
+  std::atomic<int> rows_done_;
+  std::atomic<int> rows_total_;
+  std::atomic<bool> cancel_requested_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_IO_PROGRESS_H_ */
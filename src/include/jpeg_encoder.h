@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Name            : jpeg_encoder.h
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Header for the JpegEncoder class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_JPEG_ENCODER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_JPEG_ENCODER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <string>
+#include <vector>
+#include "./pixel_buffer.h"
+#include "./io_progress.h"
+#include "./encode_settings.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Writes a PixelBuffer as a baseline 4:2:0 YCbCr JPEG.
+ *
+ * The RGB to YCbCr conversion that libjpeg would do one scanline at a time is
+ * done up front on multiple threads, and the planes are handed to libjpeg as
+ * raw data. (libjpeg 9 subsamples chroma with a scaled 16x16 DCT rather than a
+ * separate downsampling step, so its raw chroma input is full resolution and
+ * the output is identical to a plain RGB encode.)
+ *
+ * Optionally, for baseline JPEGs with the standard Huffman tables, the entropy
+ * coding is parallelized too: the image is cut into
+ * strips of whole MCU rows, each strip is compressed as its own task with
+ * the standard Huffman tables, and the strips are spliced together with
+ * restart markers, using a restart interval of one strip.
+ */
+class JpegEncoder {
+ public:
+  /**
+   * @brief Encode the pixel buffer and write it to a file
+   *
+   * @param[in] pixel_buffer The image to save
+   * @param[in] file_name The file to write
+   * @param[in] settings Quality, scan mode, Huffman optimization, DCT method
+   * and whether to entropy code strips in parallel
+   * @param[in] progress Progress/cancellation state, or nullptr
+   *
+   * @return TRUE if the file was written, FALSE on error or cancellation (in
+   * which case the file is left untouched)
+   */
+  static bool Encode(const PixelBuffer& pixel_buffer,
+                     const std::string& file_name,
+                     const JpegEncodeSettings& settings,
+                     IOProgress* progress);
+
+ private:
+  /**
+   * @brief The image as Y, Cb and Cr planes, padded with copies of the edge
+   * samples to whole 16x16 MCUs.
+   */
+  struct YCbCrPlanes {
+    YCbCrPlanes(void) : width(0), height(0), y(), cb(), cr() {}
+    int width;
+    int height;
+    std::vector<unsigned char> y;
+    std::vector<unsigned char> cb;
+    std::vector<unsigned char> cr;
+  };
+
+  /**
+   * @brief Convert the image into planes, in parallel.
+   *
+   * @return FALSE if cancelled
+   */
+  static bool ConvertToYCbCr(const PixelBuffer& pixel_buffer,
+                             YCbCrPlanes* planes,
+                             IOProgress* progress);
+
+  /**
+   * @brief Compress rows [first_row, first_row + row_count) of the planes
+   * into an in-memory JPEG of that height.
+   *
+   * @param[in] restart_interval The restart interval to use, in MCUs, or 0
+   *
+   * @return FALSE if cancelled
+   */
+  static bool CompressRows(const YCbCrPlanes& planes,
+                           int image_width,
+                           int first_row,
+                           int row_count,
+                           const JpegEncodeSettings& settings,
+                           unsigned int restart_interval,
+                           std::vector<unsigned char>* jpeg,
+                           IOProgress* progress);
+
+  /**
+   * @brief Splice strip JPEGs into one image: the headers of the first
+   * (with the frame height patched), each strip's entropy coded data separated
+   * by RSTn markers, then EOI.
+   *
+   * @return TRUE on success
+   */
+  static bool SpliceStrips(const std::vector<std::vector<unsigned char> >&
+                           strip_jpegs,
+                           int image_height,
+                           std::vector<unsigned char>* jpeg);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_JPEG_ENCODER_H_ */
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Name            : memory_accounting.h
+ * Project         : FlashPhoto
+ * Module          : memory_accounting
+ * Description     : Header for the MemoryAccounting class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_MEMORY_ACCOUNTING_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_MEMORY_ACCOUNTING_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief The parts of the program whose memory is accounted separately.
+ */
+enum MemorySubsystem {
+  MEMORY_PIXEL_BUFFER,  /**< Canvases, images and their copies */
+  MEMORY_UNDO,          /**< Canvas snapshots held by the undo history */
+  MEMORY_TOOL_MASK,     /**< Brush, blur and stamp masks */
+  MEMORY_FILTER,        /**< Convolution kernels */
+  MEMORY_SUBSYSTEM_COUNT
+};
+
+/**
+ * @brief A subsystem's counters.
+ */
+struct MemoryUsage {
+  MemoryUsage(void) : live_bytes(0), peak_bytes(0), live_allocations(0),
+                      total_allocations(0) {}
+  int64_t live_bytes;
+  int64_t peak_bytes;
+  int64_t live_allocations;
+  int64_t total_allocations;
+};
+
+/**
+ * @brief Counts the memory held by each subsystem, so that the app can show
+ * it and report what is still allocated at exit.
+ *
+ * Pixel arrays are counted by PixelPool as they are borrowed and returned;
+ * other large allocations are counted with RecordAllocation()/RecordFree().
+ * The counters are atomic, so any thread may allocate.
+ *
+ * A subsystem may also have a budget. Nothing is refused for going over it;
+ * the subsystem checks over_budget() and frees what it can spare, as the undo
+ * history does by evicting its oldest states.
+ */
+class MemoryAccounting {
+ public:
+  /**
+   * @brief Count an allocation against a subsystem
+   */
+  static void RecordAllocation(MemorySubsystem subsystem, size_t bytes);
+  static void RecordFree(MemorySubsystem subsystem, size_t bytes);
+
+  static MemoryUsage usage(MemorySubsystem subsystem);
+
+  /**
+   * @brief The bytes a subsystem should stay within; 0 for no limit
+   */
+  static int64_t budget(MemorySubsystem subsystem);
+  static void set_budget(MemorySubsystem subsystem, int64_t bytes);
+  static bool over_budget(MemorySubsystem subsystem);
+
+  static const char* SubsystemName(MemorySubsystem subsystem);
+
+  /**
+   * @brief Print every subsystem's counters
+   */
+  static void PrintReport(std::ostream& out);
+
+  /**
+   * @brief Print the subsystems that still hold memory, if any. Called at
+   * exit, once everything should have been freed.
+   *
+   * @return TRUE if nothing is still allocated
+   */
+  static bool ReportLeaks(std::ostream& out);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_MEMORY_ACCOUNTING_H_ */
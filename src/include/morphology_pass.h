@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Name            : morphology_pass.h
+ * Project         : FlashPhoto
+ * Module          : morphology_pass
+ * Description     : Header for the MorphologyPass class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_MORPHOLOGY_PASS_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_MORPHOLOGY_PASS_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief One erosion (minimum) or dilation (maximum) over a rectangle of
+ * (2 * radius_x + 1) x (2 * radius_y + 1) pixels, by van Herk and Gil and
+ * Werman's algorithm, a horizontal pass along each row and then a vertical
+ * pass along each column.
+ *
+ * Each line is cut into blocks as long as the window. Running minimums
+ * forward from the start of each block and backward from its end cover any
+ * window with one of each, so every pixel costs three comparisons whatever
+ * the radius. Pixels outside the image are left out of the window.
+ *
+ * Red, green and blue are filtered independently, or, in grayscale, pixels
+ * are ordered by luminance alone and each result takes the whole color of
+ * the darkest or brightest pixel in its window; alpha is kept. Rows,
+ * and strips of columns, are independent, so FilterRows() and
+ * FilterColumns() can each be split across threads; every row must be
+ * filtered before any column.
+ */
+class MorphologyPass {
+ public:
+  /** Columns filtered together, so each row of them is read at once */
+  static const int kStripColumns = 16;
+
+  /**
+   * @param[in] dilate Whether to take the maximum rather than the minimum
+   * @param[in] radius_x Pixels the window reaches left and right
+   * @param[in] radius_y Pixels the window reaches up and down
+   * @param[in] grayscale Whether to order pixels by luminance, rather than
+   * filter each channel
+   */
+  MorphologyPass(bool dilate, int radius_x, int radius_y, bool grayscale);
+
+  /**
+   * @return Whether the pass would leave the image unchanged
+   */
+  bool identity(void) const { return radius_x_ < 1 && radius_y_ < 1; }
+
+  /**
+   * @brief Filter rows [y_begin, y_end) of the image horizontally, in place
+   */
+  void FilterRows(PixelBuffer* image, int y_begin, int y_end) const;
+
+  /**
+   * @brief Filter columns [x_begin, x_end) of the image vertically, in place
+   */
+  void FilterColumns(PixelBuffer* image, int x_begin, int x_end) const;
+
+ private:
+  /**
+   * @brief Filter a line of length samples of channels interleaved floats,
+   * stored starting radius samples into data, which is padded() samples
+   * long. The result is left at the start of data.
+   *
+   * @param[in,out] data The line
+   * @param[out] scratch Room for twice data
+   */
+  void FilterLine(float* data, float* scratch, int length, int radius,
+                  int channels) const;
+
+  /**
+   * @brief Copy a pixel's color into a sample of FilterLine() data, with its
+   * luminance first in grayscale
+   */
+  void ReadPixel(const ColorData& color, float* sample) const;
+
+  /**
+   * @brief Set a pixel's color from a sample, keeping its alpha
+   */
+  void WritePixel(const float* sample, ColorData* color) const;
+
+  /**
+   * @return The samples a line of length is padded to for a radius: with
+   * radius before and after it, rounded up to a whole number of windows
+   */
+  static int padded(int length, int radius);
+
+  bool dilate_;
+  int radius_x_;
+  int radius_y_;
+  bool grayscale_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_MORPHOLOGY_PASS_H_ */
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Name            : perf_hud.h
+ * Project         : FlashPhoto
+ * Module          : perf_hud
+ * Description     : Header for the PerfHud class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_PERF_HUD_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_PERF_HUD_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GL/glui.h"
+#include "./task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief An optional overlay in the corner of the canvas showing how long
+ * frames, strokes and filters take and how much memory the canvas and its
+ * undo history hold, so that slowdowns can be diagnosed as they happen.
+ *
+ * The app reports events to it as they happen; the values are always
+ * collected, and only drawn while the overlay is visible.
+ */
+class PerfHud {
+ public:
+  PerfHud(void);
+
+  void toggle_visible(void) { visible_ = !visible_; }
+  bool visible(void) const { return visible_; }
+
+  /**
+   * @brief Note that an input event that changes the canvas was received.
+   * The latency is measured from the first such event to the end of the next
+   * frame.
+   */
+  void MarkInput(void);
+
+  /**
+   * @brief Bracket the rendering of one frame, including the buffer swap
+   */
+  void BeginFrame(void);
+  void EndFrame(void);
+
+  /**
+   * @brief Record the filter just applied
+   *
+   * @param[in] name The name of the filter
+   * @param[in] milliseconds How long it took
+   * @param[in] megapixels The size of the image it was applied to
+   */
+  void RecordFilter(const std::string& name, double milliseconds,
+                    double megapixels);
+
+  /**
+   * @brief Record how the canvas was drawn this frame
+   *
+   * @param[in] zoom Window pixels per canvas pixel
+   * @param[in] level The pyramid level drawn from (0 is full size)
+   * @param[in] drawn_bytes The size of the pixels sent to OpenGL
+   */
+  void RecordView(double zoom, int level, size_t drawn_bytes);
+
+  /**
+   * @brief Sample how busy the scheduler's workers have been, at most once
+   * per sampling interval so the figures are readable
+   */
+  void RecordWorkers(const TaskScheduler& scheduler);
+
+  /**
+   * @brief Draw the overlay in the top left corner of the window, in window
+   * coordinates (origin bottom left)
+   *
+   * @param[in] window_height The height of the window
+   * @param[in] display_bytes The size of the canvas's pixels
+   * @param[in] undo_depth States on the undo stack
+   * @param[in] redo_depth States on the redo stack
+   * @param[in] evicted_states Undo states dropped to stay within budget
+   */
+  void Draw(int window_height, size_t display_bytes, size_t undo_depth,
+            size_t redo_depth, size_t evicted_states) const;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  static double MillisecondsBetween(Clock::time_point start,
+                                    Clock::time_point end);
+
+  bool visible_;
+  Clock::time_point frame_start_;
+  Clock::time_point input_time_;
+  bool input_pending_;
+  int frames_;
+  double frame_ms_; /**< Smoothed */
+  double frame_max_ms_;
+  double latency_ms_; /**< Of the last stroke event */
+  double latency_max_ms_;
+  std::string filter_name_;
+  double filter_ms_;
+  double filter_megapixels_;
+  double view_zoom_;
+  int view_level_;
+  size_t view_drawn_bytes_;
+  Clock::time_point workers_sampled_;
+  std::vector<double> worker_busy_ms_; /**< At the last sample */
+  std::vector<double> worker_utilization_; /**< Since the sample before */
+  int64_t tasks_run_; /**< By every worker, since the scheduler started */
+  int64_t tasks_stolen_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_PERF_HUD_H_ */
@@ -44,6 +44,14 @@ class PixelBuffer {
     void set_pixel(int x, int y, const ColorData& color);
 
     inline ColorData const *data(void) const { return pixels_; }
+
+    /**
+     * @brief The pixels of row y (0 is the top), left to right
+     */
+    inline ColorData* row(int y) { return pixels_ + width_*(height_-(y+1)); }
+    inline const ColorData* row(int y) const {
+      return pixels_ + width_*(height_-(y+1));
+    }
     inline int height(void) const { return height_; }
     inline int width(void) const { return width_; }
 
@@ -72,13 +80,26 @@ class PixelBuffer {
     void set_valid_pixel(int x, int y, const ColorData& color);
     ColorData get_valid_pixel(int x, int y) const;
 
+    /**
+     * @brief Copy out every pixel
+     * @return The copy, to be given back with PixelPool::Return()
+     */
     ColorData* GetAllPixels(void);
 
-    void SetAllPixels(ColorData* pixels_copy);
+    void SetAllPixels(const ColorData* pixels_copy);
 
+    /**
+     * @brief Make a new buffer with the same pixels. The pixels come from
+     * PixelPool, so copying scratch buffers at a repeated size is cheap.
+     */
     PixelBuffer* Copy();
 
  private:
+    /**
+     * @brief Copy constructor for Copy(); skips filling with the background
+     */
+    explicit PixelBuffer(const PixelBuffer* source);
+
     const int width_; /**< X dimension--cannot be changed  */
     const int height_; /**< Y dimension--cannot be changed  */
 
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * Name            : pixel_pool.h
+ * Project         : FlashPhoto
+ * Module          : pixel_pool
+ * Description     : Header for the PixelPool class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_PIXEL_POOL_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_PIXEL_POOL_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include "./color_data.h"
+#include "./memory_accounting.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief How the pool gets memory for new slabs.
+ */
+enum PixelAllocationPolicy {
+  /** Cache line aligned; pages are faulted in by whoever writes first */
+  PIXEL_ALLOC_STANDARD,
+  /**
+   * Slabs of 2 MB or more are 2 MB aligned and advised for transparent huge
+   * pages, then first touched in contiguous bands by the scheduler's threads
+   * that the filters run on, so each band lands on a NUMA node near them
+   */
+  PIXEL_ALLOC_HUGE_PAGES
+};
+
+/**
+ * @brief The pool's own counters.
+ */
+struct PixelPoolStats {
+  PixelPoolStats(void) : reserved_bytes(0), idle_bytes(0), slab_allocations(0),
+                         borrows(0), huge_page_bytes(0) {}
+  int64_t reserved_bytes;    /**< Held from the system, borrowed or not */
+  int64_t idle_bytes;        /**< Held but not borrowed */
+  int64_t slab_allocations;  /**< System allocations made so far */
+  int64_t borrows;           /**< Buffers handed out so far */
+  int64_t huge_page_bytes;   /**< Reserved bytes advised for huge pages */
+};
+
+/**
+ * @brief A size-class pool of uninitialized, cache line aligned pixel
+ * arrays. Every canvas, image, filter scratch copy and undo snapshot is
+ * borrowed from it.
+ *
+ * Requests are rounded up to a size class (at most 1/8 larger), and the
+ * buffers of a class are allocated together in slabs. Returned buffers stay
+ * in their class for the next borrower, so repeating an operation at the
+ * same canvas size makes no system allocations and touches no new pages.
+ * Idle memory is capped per class and in all: a returned buffer that leaves
+ * its slab unused past either cap releases the slab, and Trim() releases
+ * every unused slab when a size is done with (a batch image, a replaced
+ * canvas, an evicted undo state).
+ *
+ * Each buffer is preceded by a header naming its size class and the
+ * subsystem it is counted against, so Return() needs only the pointer.
+ * The pool is shared by all threads.
+ */
+class PixelPool {
+ public:
+  /**
+   * @brief Borrow an array of at least count pixels. The contents are
+   * undefined: no pixel is initialized.
+   *
+   * @param[in] count The number of pixels
+   * @param[in] subsystem Who the memory is counted against
+   *
+   * @return The pixels, to be given back with Return()
+   */
+  static ColorData* Borrow(size_t count, MemorySubsystem subsystem);
+
+  /**
+   * @brief Give back pixels from Borrow(), releasing their slab if the pool
+   * is over its idle caps. nullptr is ignored.
+   */
+  static void Return(ColorData* pixels);
+
+  /**
+   * @brief Count borrowed pixels against another subsystem, when their
+   * ownership moves (e.g. a canvas snapshot given to the undo history)
+   */
+  static void Reassign(ColorData* pixels, MemorySubsystem subsystem);
+
+  /**
+   * @brief The number of pixels asked for when the array was borrowed
+   */
+  static size_t PixelCount(const ColorData* pixels);
+
+  /**
+   * @brief Release every slab that has no borrowed buffers
+   */
+  static void Trim(void);
+
+  static PixelPoolStats stats(void);
+
+  /**
+   * @brief Set how new slabs are allocated; existing slabs are kept until
+   * Trim(). The default is PIXEL_ALLOC_HUGE_PAGES.
+   */
+  static void set_policy(PixelAllocationPolicy policy);
+  static PixelAllocationPolicy policy(void);
+  static const char* PolicyName(PixelAllocationPolicy policy);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_PIXEL_POOL_H_ */
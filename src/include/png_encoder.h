@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Name            : png_encoder.h
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Header for the PngEncoder class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_PNG_ENCODER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_PNG_ENCODER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "./pixel_buffer.h"
+#include "./io_progress.h"
+#include "./encode_settings.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Writes a PixelBuffer as an 8-bit RGBA PNG, filtering and deflating
+ * horizontal strips of the image on multiple threads.
+ *
+ * Each strip is compressed as an independent raw deflate stream that ends on a
+ * byte boundary (a sync flush), primed with the last 32K of the previous
+ * strip's data so little compression is lost at the seams. The strips are
+ * written to the file in order as IDAT chunks as soon as each is compressed,
+ * behind a single zlib header, with the per-strip Adler-32 sums combined into
+ * the stream trailer as they go, giving one valid IDAT stream.
+ */
+class PngEncoder {
+ public:
+  /**
+   * @brief Encode the pixel buffer and write it to a file
+   *
+   * @param[in] pixel_buffer The image to save
+   * @param[in] file_name The file to write
+   * @param[in] settings Compression level, filtering and deflate strategy
+   * @param[in] progress Progress/cancellation state, or nullptr
+   *
+   * @return TRUE if the file was written, FALSE on error or cancellation (in
+   * which case the partly written file is removed)
+   */
+  static bool Encode(const PixelBuffer& pixel_buffer,
+                     const std::string& file_name,
+                     const PngEncodeSettings& settings,
+                     IOProgress* progress);
+
+ private:
+  /**
+   * @brief The compressed form of one horizontal strip of the image.
+   */
+  struct Strip {
+    Strip(void) : first_row(0), row_count(0), filtered(), deflated(),
+                  adler(1), deflate_done(false) {}
+    int first_row;
+    int row_count;
+    std::vector<unsigned char> filtered; /**< Filter byte + row, per row */
+    std::vector<unsigned char> deflated; /**< Raw deflate data */
+    unsigned long adler; /**< Adler-32 of filtered */
+    bool deflate_done; /**< Set under the write lock once deflated */
+  };
+
+  /**
+   * @brief Filter one scanline. The adaptive heuristic chooses the PNG filter
+   * type that minimizes the sum of absolute differences (the libpng default);
+   * the others always use the one filter type.
+   *
+   * @param[in] row The raw scanline
+   * @param[in] prior_row The raw scanline above, or nullptr for the first row
+   * @param[in] row_bytes Bytes in a scanline
+   * @param[in] heuristic How to choose the filter type
+   * @param[in] scratch Working space of row_bytes
+   * @param[out] out Receives the filter type byte followed by row_bytes
+   */
+  static void FilterRow(const unsigned char* row,
+                        const unsigned char* prior_row,
+                        int row_bytes,
+                        PngFilterHeuristic heuristic,
+                        unsigned char* scratch,
+                        unsigned char* out);
+
+  /**
+   * @brief Raw-deflate a strip, ending on a byte boundary unless it is the
+   * last strip of the image.
+   *
+   * @return TRUE on success
+   */
+  static bool DeflateStrip(Strip* strip, const Strip* previous_strip,
+                           bool last_strip,
+                           const PngEncodeSettings& settings);
+
+  /**
+   * @brief Write one PNG chunk: length, type, data and CRC.
+   *
+   * @return TRUE if every byte was written
+   */
+  static bool WriteChunk(FILE* fp,
+                         const char* type,
+                         const unsigned char* data,
+                         size_t length);
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_PNG_ENCODER_H_ */
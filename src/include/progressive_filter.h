@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * Name            : progressive_filter.h
+ * Project         : FlashPhoto
+ * Module          : progressive_filter
+ * Description     : Header for the ProgressiveFilter class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_PROGRESSIVE_FILTER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_PROGRESSIVE_FILTER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "./batch_processor.h"
+#include "./pixel_buffer.h"
+#include "./task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Applies a filter to an image as a background task, coarse to fine:
+ * to copies reduced by 8, 4 and 2 and then at full size, each a tile at a
+ * time starting from a point of interest, so a caller drawing the finished
+ * tiles shows the result taking shape straight away. Previews and strokes,
+ * being interactive, run ahead of it.
+ *
+ * The image is only read, and must not change until the filter has finished
+ * or been cancelled; the full-size result is handed over with TakeResult().
+ * Cancel() stops the task after the tile in progress and discards
+ * everything, leaving the image as it was.
+ */
+class ProgressiveFilter {
+ public:
+  /** Side of the square tiles each pass is filtered in */
+  static const int kTileSize = 256;
+
+  /** How many times smaller the first pass's image is */
+  static const int kCoarsestScale = 8;
+
+  /**
+   * @brief A tile of one pass, in that pass's pixels
+   */
+  struct Tile {
+    int pass;
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  ProgressiveFilter(void);
+  ~ProgressiveFilter(void);
+
+  /**
+   * @brief Cancel any filter in progress and start another
+   *
+   * @param[in] image The image to filter, unchanged until finished
+   * @param[in] operation The filter
+   * @param[in] center_x The point each pass starts from
+   * @param[in] center_y The point each pass starts from
+   */
+  void Start(const PixelBuffer* image, const FilterOperation& operation,
+             int center_x, int center_y);
+
+  /**
+   * @brief Stop the filter in progress, if any, and discard its results
+   */
+  void Cancel(void);
+
+  /**
+   * @return Whether a filter is in progress or finished but not yet taken
+   */
+  bool running(void) const { return started_; }
+
+  /**
+   * @return The tiles of every pass, in the order they are filtered
+   */
+  int tile_count(void) const { return static_cast<int>(tiles_.size()); }
+  const Tile& tile(int index) const { return tiles_[index]; }
+
+  /**
+   * @return How many tiles, from the start of the order, are finished
+   */
+  int tiles_done(void) const {
+    return tiles_done_.load(std::memory_order_acquire);
+  }
+
+  bool finished(void) const {
+    return running() && tiles_done() == tile_count();
+  }
+
+  /**
+   * @return How many times smaller than the image a pass is
+   */
+  int pass_scale(int pass) const { return passes_[pass].scale; }
+
+  /**
+   * @return A pass's result; only the finished tiles may be read
+   */
+  const PixelBuffer* pass_result(int pass) const {
+    return passes_[pass].result;
+  }
+
+  /**
+   * @brief Hand over the full-size result once finished()
+   *
+   * @return The result, owned by the caller
+   */
+  PixelBuffer* TakeResult(void);
+
+  /**
+   * @return How long the filter took, once finished()
+   */
+  double elapsed_ms(void) const { return elapsed_ms_; }
+
+ private:
+  /* Copy/move assignment/construction disallowed */
+  ProgressiveFilter(const ProgressiveFilter& rhs) = delete;
+  ProgressiveFilter& operator=(const ProgressiveFilter& rhs) = delete;
+
+  struct Pass {
+    int scale;
+    const PixelBuffer* source; /**< The image itself at full size */
+    PixelBuffer* result;
+    FilterOperation operation; /**< Scaled to the pass */
+  };
+
+  /**
+   * @brief The task: reduce the image for each pass, then filter the tiles
+   */
+  void Run(void);
+  void FilterTile(const Tile& tile);
+
+  const PixelBuffer* image_;
+  std::vector<Pass> passes_;
+  std::vector<Tile> tiles_;
+  TaskGroup task_;
+  bool started_; /**< Started and not yet taken or cancelled */
+  std::atomic<int> tiles_done_;
+  std::atomic<bool> cancel_;
+  double elapsed_ms_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_PROGRESSIVE_FILTER_H_ */
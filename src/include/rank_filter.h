@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Name            : rank_filter.h
+ * Project         : FlashPhoto
+ * Module          : rank_filter
+ * Description     : Header for the RankFilter class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_RANK_FILTER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_RANK_FILTER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Replaces each pixel's red, green and blue with a percentile (the
+ * median at 0.5) of those in the square of side 2 * radius + 1 around it,
+ * using Perreault and Hebert's constant-time median filter.
+ *
+ * Each channel is binned to 8 bits. Every image column keeps a histogram of
+ * the 2 * radius + 1 pixels around the current row, updated with one pixel
+ * in and one out per row; the window's histogram is updated with one column
+ * histogram in and one out per pixel. Histograms have 16 coarse bins over
+ * 256 fine ones: the window's coarse bins are kept current and find which
+ * coarse bin the percentile falls in, and only that bin's fine counts are
+ * brought up to date, from where it was last used. The cost per pixel is
+ * therefore independent of the radius.
+ *
+ * Counts are 16 bits packed four to a 64-bit word, so whole histograms are
+ * added and subtracted a word, four bins, at a time. No count can exceed the
+ * window's 255 x 255 pixels, so bins never carry into each other.
+ *
+ * Pixels outside the image are left out of the window, as FilterKernel
+ * leaves out taps that fall outside it. Tiles are independent, each
+ * building its own column histograms, so FilterTile() can be split across
+ * threads.
+ */
+class RankFilter {
+ public:
+  /** The largest radius whose windows fit 16-bit counts */
+  static const int kMaxRadius = 127;
+
+  /** Tiles are at least this size, and 8 radii, to amortize their setup */
+  static const int kMinTileSize = 128;
+
+  /**
+   * @param[in] radius Pixels each way the window reaches, clamped to
+   * [0, kMaxRadius]
+   * @param[in] percentile Which value to take, 0 (minimum) to 1 (maximum)
+   */
+  RankFilter(int radius, float percentile);
+
+  /**
+   * @return Whether the filter would leave the image unchanged
+   */
+  bool identity(void) const { return radius_ < 1; }
+
+  /**
+   * @return The side of the tiles FilterTile() should be given
+   */
+  int tile_size(void) const;
+
+  /**
+   * @brief Filter pixels [x_begin, x_end) x [y_begin, y_end) of source into
+   * the same pixels of target
+   */
+  void FilterTile(const PixelBuffer& source, PixelBuffer* target,
+                  int x_begin, int y_begin, int x_end, int y_end) const;
+
+ private:
+  int radius_;
+  float percentile_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_RANK_FILTER_H_ */
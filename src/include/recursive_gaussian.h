@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * Name            : recursive_gaussian.h
+ * Project         : FlashPhoto
+ * Module          : recursive_gaussian
+ * Description     : Header for the RecursiveGaussian class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_RECURSIVE_GAUSSIAN_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_RECURSIVE_GAUSSIAN_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief A Gaussian blur approximated by a third-order recursive (IIR)
+ * filter, run forward then backward along each row and then each column.
+ * The poles are van Vliet, Young and Verbeek's, scaled so the impulse
+ * response has exactly the requested variance; it stays within about 1% of
+ * the Gaussian's peak for sigmas of 5 and more, 4% at sigma 1.
+ *
+ * Each pass costs the same few multiplies per pixel whatever the sigma, so
+ * a blur of hundreds of pixels takes as long as one of two. The image edges
+ * are extended with their own colors, using the Triggs-Sdika initial
+ * conditions for the backward pass. The recursions run in double precision:
+ * with large sigmas their poles approach 1, where float would drift.
+ *
+ * Rows, and strips of columns, are independent, so FilterRows() and
+ * FilterColumns() can each be split across threads; every row must be
+ * filtered before any column.
+ */
+class RecursiveGaussian {
+ public:
+  /** Sigmas below this leave the image unchanged */
+  static const float kMinSigma;
+
+  /** Columns filtered together, so each row of them is read at once */
+  static const int kStripColumns = 16;
+
+  /** Sigmas of the Gaussian reaching past a pixel's halo() */
+  static const int kHaloSigmas = 3;
+
+  explicit RecursiveGaussian(float sigma);
+
+  /**
+   * @return Whether the blur would leave the image unchanged
+   */
+  bool identity(void) const { return sigma_ < kMinSigma; }
+
+  /**
+   * @return How many pixels away a pixel still has a visible effect: the
+   * Gaussian holds under 0.3% of its weight beyond it
+   */
+  static int halo(float sigma);
+
+  /**
+   * @brief Blur rows [y_begin, y_end) of the image horizontally, in place
+   */
+  void FilterRows(PixelBuffer* image, int y_begin, int y_end) const;
+
+  /**
+   * @brief Blur columns [x_begin, x_end) of the image vertically, in place,
+   * clamping the result
+   */
+  void FilterColumns(PixelBuffer* image, int x_begin, int x_end) const;
+
+  /**
+   * @brief Blur columns [x_begin, x_end) of blurred, whose rows are already
+   * blurred, vertically, and unsharp mask the same columns of image with the
+   * result as they come: every channel differing from the blur by at least
+   * threshold gains amount times the difference, clamped. blurred is only
+   * read, so no further pass over the image is needed.
+   */
+  void SharpenColumns(const PixelBuffer& blurred, PixelBuffer* image,
+                      int x_begin, int x_end, float amount,
+                      float threshold) const;
+
+ private:
+  /**
+   * @brief Read columns [x, x + columns) of image into strip and blur them
+   * vertically; row y is left (y + 3) * columns samples into it
+   */
+  void FilterStrip(const PixelBuffer& image, int x, int columns,
+                   double* strip) const;
+
+  /**
+   * @brief Filter, forward then backward, a line of length samples of
+   * channels interleaved doubles each. The line is stored starting three
+   * samples into data, which has room for three more after it.
+   */
+  void FilterLine(double* data, int length, int channels) const;
+
+  float sigma_;
+  double b_;      /**< Gain applied to each new sample */
+  double a_[3];   /**< Feedback from the previous three outputs */
+  double m_[3][3]; /**< Triggs-Sdika matrix for the backward pass */
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_RECURSIVE_GAUSSIAN_H_ */
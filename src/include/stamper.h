@@ -63,13 +63,7 @@ class Stamper : public Brush {
 
     void set_buffer_stamp_mask(PixelBuffer* pixel_buffer);
 
-    virtual ~Stamper(void) {
-      if (stamp_mask_) {
-        for (int mask_row = 0; mask_row < mask_size_; mask_row++) {
-          delete stamp_mask_[mask_row];
-        }
-      }
-    }
+    virtual ~Stamper(void) { clear_stamp_mask(); }
 
  private:
     void set_ppm_stamp_mask(int width, int height, double alpha,
@@ -16,11 +16,10 @@
  * Includes
  ******************************************************************************/
 #include <string>
-#include <stack>
 #include "GL/glui.h"
 #include "./ui_ctrl.h"
-#include "./state_manager.h"
 #include "./color_data.h"
+#include "./canvas_history.h"
 
 /*******************************************************************************
  * Namespaces
@@ -41,6 +40,9 @@ namespace image_tools {
  * A sequence of undos followed by some edits, followed by more undos will
  * FIRST undo the new edits, until you get back to the state before you made the
  * edits. You will not be able to go back any further.
+ *
+ * The stacks themselves are a CanvasHistory; this class keeps the undo/redo
+ * buttons in step with it.
  */
 class StateManager {
  public:
@@ -78,6 +80,19 @@ class StateManager {
    */
   void ClearUndoAndRedoStacks(void);
 
+  /**
+   * @brief The number of saved canvas states that can be undone/redone to,
+   * counting the current one as undoable
+   */
+  size_t undo_depth(void) const { return history_.undo_depth(); }
+  size_t redo_depth(void) const { return history_.redo_depth(); }
+
+  /**
+   * @brief The number of old states dropped to keep the history within its
+   * byte budget
+   */
+  size_t evicted_states(void) const { return history_.evicted_states(); }
+
  private:
   void redo_toggle(bool select) {
     UICtrl::button_toggle(redo_btn_, select);
@@ -89,9 +104,6 @@ class StateManager {
 
   void ToggleStateButtons(void);
 
-  void ClearRedoStack(void);
-  void ClearUndoStack(void);
-
   /* Copy/move assignment/construction disallowed */
   StateManager(const StateManager &rhs) = delete;
   StateManager& operator=(const StateManager &rhs) = delete;
@@ -100,8 +112,7 @@ class StateManager {
   GLUI_Button *undo_btn_;
   GLUI_Button *redo_btn_;
 
-  std::stack<ColorData *> undo_stack_;
-  std::stack<ColorData *> redo_stack_;
+  CanvasHistory history_;
 };
 
 }  /* namespace image_tools */
@@ -0,0 +1,303 @@
+/*******************************************************************************
+ * Name            : task_scheduler.h
+ * Project         : FlashPhoto
+ * Module          : task_scheduler
+ * Description     : Header for the TaskScheduler and TaskGroup classes
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_TASK_SCHEDULER_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_TASK_SCHEDULER_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Which lane a task is queued in. Workers take every queued
+ * interactive task, their own or stolen, before any background task.
+ */
+enum TaskPriority {
+  /** Work someone is watching: previews, strokes, filters being applied */
+  TASK_PRIORITY_INTERACTIVE,
+  /** Work that can wait: loads, saves, batch images, progressive filters */
+  TASK_PRIORITY_BACKGROUND,
+  TASK_PRIORITY_COUNT
+};
+
+/**
+ * @brief One worker's counters since the scheduler was created or its
+ * stats were last reset.
+ */
+struct WorkerStats {
+  WorkerStats(void) : tasks_run(0), tasks_stolen(0), busy_ms(0.0),
+                      utilization(0.0) {}
+  int64_t tasks_run;
+  int64_t tasks_stolen;  /**< Of tasks_run, taken from another's deque */
+  double busy_ms;        /**< Spent running tasks */
+  double utilization;    /**< busy_ms as a fraction of the time elapsed */
+};
+
+class TaskScheduler;
+
+/**
+ * @brief A set of tasks that can be waited for together, e.g. one image of
+ * a batch or one background load.
+ *
+ * Run() and Wait() are called by the group's owner; the destructor waits for
+ * any tasks still outstanding. Waiting runs the group's tasks that no worker
+ * has started yet on the waiting thread, so waiting never depends on a
+ * worker being free.
+ */
+class TaskGroup {
+ public:
+  TaskGroup(void);
+  ~TaskGroup(void);
+
+  /**
+   * @brief Queue a task on the current scheduler
+   */
+  void Run(std::function<void(void)> function, TaskPriority priority);
+
+  /**
+   * @brief Block until every task run so far has finished
+   */
+  void Wait(void);
+
+  /**
+   * @return Whether every task run so far has finished
+   */
+  bool idle(void) const;
+
+ private:
+  friend class TaskScheduler;
+
+  /* Copy/move assignment/construction disallowed */
+  TaskGroup(const TaskGroup& rhs) = delete;
+  TaskGroup& operator=(const TaskGroup& rhs) = delete;
+
+  /**
+   * @brief Called by the scheduler as each task finishes
+   */
+  void Finish(void);
+
+  TaskScheduler* scheduler_; /**< The one the tasks were queued on */
+  int pending_;
+  mutable std::mutex mutex_;
+  std::condition_variable finished_;
+};
+
+/**
+ * @brief A pool of worker threads, each with a deque of tasks per priority,
+ * that every parallel part of the core runs on: the filters, the pyramid,
+ * the codecs, batch processing, previews and background loads and saves.
+ *
+ * A worker pushes and pops tasks at the back of its own deques and, when
+ * they are empty, steals from the front of the others', so a filter started
+ * from within a batch image spreads over whichever workers are idle.
+ *
+ * The app owns a scheduler and installs it with set_instance(); headless
+ * front ends get one created on first use, sized to the machine.
+ */
+class TaskScheduler {
+ public:
+  /**
+   * @param[in] worker_count Threads to start; the thread calling
+   * ParallelFor() works alongside them
+   */
+  explicit TaskScheduler(int worker_count = DefaultWorkerCount());
+
+  /**
+   * @brief Run every task still queued, including those pinned to a worker,
+   * then stop the workers
+   */
+  ~TaskScheduler(void);
+
+  /**
+   * @return The installed scheduler or else the default one
+   */
+  static TaskScheduler& Instance(void);
+
+  /**
+   * @brief Install a scheduler for Instance() to return, or uninstall it
+   * with nullptr. It must outlive every task queued on it.
+   */
+  static void set_instance(TaskScheduler* scheduler);
+
+  /**
+   * @return One worker per core besides the calling thread, but at least
+   * two, so a long background task never holds up an interactive one
+   */
+  static int DefaultWorkerCount(void);
+
+  /**
+   * @return The priority of the task the calling thread is running;
+   * threads that are not workers count as interactive
+   */
+  static TaskPriority current_priority(void);
+
+  int worker_count(void) const { return static_cast<int>(workers_.size()); }
+
+  /**
+   * @return How many threads a ParallelFor() can spread over
+   */
+  int concurrency(void) const { return worker_count() + 1; }
+
+  /**
+   * @brief Queue a task; on a worker it goes on that worker's own deque
+   *
+   * @param[in] function The task
+   * @param[in] priority Its lane
+   * @param[in] group The group to report to when finished, or nullptr
+   */
+  void Submit(std::function<void(void)> function, TaskPriority priority,
+              TaskGroup* group);
+
+  /**
+   * @brief Call body over [begin, end) in chunks of grain indices, on the
+   * calling thread and any idle workers, and return once all are done.
+   *
+   * Helpers are queued at the caller's current priority, and nested calls
+   * are fine: the caller always works through the chunks itself.
+   *
+   * @param[in] begin The first index
+   * @param[in] end One past the last index
+   * @param[in] grain Indices per chunk; 0 splits the range into a few
+   * chunks per thread
+   * @param[in] body Called with each chunk's [begin, end)
+   */
+  void ParallelFor(int begin, int end, int grain,
+                   const std::function<void(int, int)>& body);
+
+  /**
+   * @brief Split [begin, end) into one contiguous band per thread, band 0
+   * for the calling thread and band i + 1 for worker i, call body with each
+   * and return once all are done.
+   *
+   * Bands are never stolen: a worker runs only its own, and the caller runs
+   * any a busy worker has not started once its own is done. Memory a band
+   * first touches is therefore faulted in by the thread the band is meant
+   * for whenever that thread is free.
+   *
+   * @param[in] begin The first index
+   * @param[in] end One past the last index
+   * @param[in] body Called with each band's [begin, end)
+   */
+  void ParallelForBands(int begin, int end,
+                        const std::function<void(int, int)>& body);
+
+  /**
+   * @brief Call body once per tile of a width x height grid, in parallel
+   *
+   * @param[in] width The grid
+   * @param[in] height The grid
+   * @param[in] tile_size The side of each tile, smaller at the right and
+   * bottom edges
+   * @param[in] body Called with each tile's x_begin, y_begin, x_end, y_end
+   */
+  void ParallelForTiles(int width, int height, int tile_size,
+                        const std::function<void(int, int, int, int)>& body);
+
+  /**
+   * @return A worker's counters
+   */
+  WorkerStats worker_stats(int worker) const;
+
+  /**
+   * @brief Zero every worker's counters and restart the clock
+   */
+  void ResetStats(void);
+
+ private:
+  friend class TaskGroup;
+
+  /* Copy/move assignment/construction disallowed */
+  TaskScheduler(const TaskScheduler& rhs) = delete;
+  TaskScheduler& operator=(const TaskScheduler& rhs) = delete;
+
+  struct Task {
+    Task(void) : function(), priority(TASK_PRIORITY_INTERACTIVE),
+                 group(nullptr) {}
+    Task(std::function<void(void)> task_function, TaskPriority task_priority,
+         TaskGroup* task_group) : function(task_function),
+                                  priority(task_priority), group(task_group) {}
+    Task(const Task& rhs) = default;
+    Task& operator=(const Task& rhs) = default;
+    std::function<void(void)> function;
+    TaskPriority priority;
+    TaskGroup* group;
+  };
+
+  struct Worker {
+    Worker(void) : mutex(), lanes(), pinned(), pinned_count(0), thread(),
+                   tasks_run(0), tasks_stolen(0), busy_ns(0) {}
+    std::mutex mutex; /**< Guards the lanes and pinned */
+    std::deque<Task> lanes[TASK_PRIORITY_COUNT];
+    /** Tasks only this worker may take, ahead of the lanes */
+    std::deque<Task> pinned;
+    std::atomic<int> pinned_count;
+    std::thread thread;
+    std::atomic<int64_t> tasks_run;
+    std::atomic<int64_t> tasks_stolen;
+    std::atomic<int64_t> busy_ns;
+  };
+
+  /**
+   * @brief Queue a task that only the given worker may take
+   */
+  void SubmitPinned(int worker, std::function<void(void)> function,
+                    TaskPriority priority);
+
+  void WorkerLoop(int index);
+
+  /**
+   * @brief Take the next task for a worker, or for a thread that is not
+   * one when index is -1: its pinned tasks first, then the highest
+   * priority first, own deque first
+   *
+   * @return FALSE if every deque is empty
+   */
+  bool TakeTask(int index, Task* task, bool* stolen);
+
+  /**
+   * @brief Take a queued task of the given group from any deque
+   */
+  bool TakeGroupTask(const TaskGroup* group, Task* task);
+
+  /**
+   * @brief Run a taken task at its priority and report it to its group
+   */
+  static void Execute(Task* task);
+
+  std::vector<std::unique_ptr<Worker> > workers_;
+  std::atomic<int> queued_;
+  std::atomic<unsigned> next_worker_; /**< For tasks from other threads */
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stopping_;
+  std::atomic<int64_t> stats_start_ns_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_TASK_SCHEDULER_H_ */
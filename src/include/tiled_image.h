@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * Name            : tiled_image.h
+ * Project         : FlashPhoto
+ * Module          : tiled_image
+ * Description     : Header for the TiledImage class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_TILED_IMAGE_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_TILED_IMAGE_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "./color_data.h"
+#include "./pixel_buffer.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief An image too large for memory, stored in a memory-mapped file as
+ * square tiles.
+ *
+ * Each tile's pixels are contiguous (rows top to bottom), so working on one
+ * tile, or one row of tiles, touches only those pages of the file. Callers
+ * walk the image in tile order and call ReleaseTileRows() behind them, which
+ * keeps only a working set of tiles resident however large the image is.
+ *
+ * (0,0) is the top left corner, as for PixelBuffer. Tiles on the right and
+ * bottom edges are padded to the full tile size.
+ */
+class TiledImage {
+ public:
+  /**
+   * @brief The width and height of a tile in pixels (1 MB of pixels)
+   */
+  static const int kTileSize = 256;
+
+  /**
+   * @brief Create an image backed by an unlinked temporary file
+   *
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] background_color The image's background color
+   * @param[in] fill Fill every pixel with the background color; otherwise
+   * they start out zero, for images about to be overwritten
+   * @param[in] directory Where to put the file; empty for $TMPDIR or /tmp
+   *
+   * @return The image, owned by the caller, or nullptr if the file could not
+   * be created or mapped
+   */
+  static TiledImage* Create(int width, int height,
+                            const ColorData& background_color, bool fill,
+                            const std::string& directory);
+
+  ~TiledImage(void);
+
+  int width(void) const { return width_; }
+  int height(void) const { return height_; }
+  int tiles_x(void) const { return tiles_x_; }
+  int tiles_y(void) const { return tiles_y_; }
+  ColorData background_color(void) const { return background_color_; }
+
+  /**
+   * @brief The directory the tile file was created in
+   */
+  const std::string& directory(void) const { return directory_; }
+
+  /**
+   * @brief The kTileSize * kTileSize pixels of a tile
+   */
+  ColorData* tile(int tile_x, int tile_y);
+  const ColorData* tile(int tile_x, int tile_y) const;
+
+  ColorData get_pixel(int x, int y) const;
+  void set_pixel(int x, int y, const ColorData& color);
+
+  /**
+   * @brief Copy a row of pixels out of/into the image
+   *
+   * @param[in] y The row
+   * @param[in] x The first column
+   * @param[in] count The number of pixels
+   */
+  void ReadRow(int y, int x, int count, ColorData* pixels) const;
+  void WriteRow(int y, int x, int count, const ColorData* pixels);
+
+  /**
+   * @brief Copy the region of the image with its top left corner at (x, y)
+   * and the size of the buffer into the buffer
+   */
+  void ReadRegion(int x, int y, PixelBuffer* region) const;
+
+  /**
+   * @brief Copy a w x h part of a buffer, starting at (region_x, region_y)
+   * in it, into the image at (x, y)
+   */
+  void WriteRegion(int x, int y, const PixelBuffer& region, int region_x,
+                   int region_y, int w, int h);
+
+  /**
+   * @brief Write rows of tiles back to the file and drop them from memory.
+   * They are read back in if used again.
+   *
+   * @param[in] first_tile_y The first row of tiles
+   * @param[in] end_tile_y One past the last row of tiles
+   */
+  void ReleaseTileRows(int first_tile_y, int end_tile_y);
+
+  /**
+   * @brief Make a reduced copy of the image, averaging each square block of
+   * pixels, that fits within the given size
+   *
+   * @return The copy, owned by the caller
+   */
+  PixelBuffer* Downsample(int max_width, int max_height);
+
+  /**
+   * @brief Exchange contents with another image of the same size, e.g. after
+   * filtering into it
+   */
+  void Swap(TiledImage* other);
+
+ private:
+  TiledImage(int width, int height, const ColorData& background_color);
+  TiledImage(const TiledImage& rhs) = delete;
+  TiledImage& operator=(const TiledImage& rhs) = delete;
+
+  /* The offset of a pixel from the start of the mapping, in pixels */
+  int64_t PixelOffset(int x, int y) const;
+
+  int width_;
+  int height_;
+  int tiles_x_;
+  int tiles_y_;
+  ColorData background_color_;
+  std::string directory_;
+  int fd_;
+  size_t bytes_;
+  ColorData* pixels_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_TILED_IMAGE_H_ */
@@ -48,6 +48,12 @@ class Tool {
      */
     virtual void ApplyDragged(int x1, int y1, int x2, int y2) = 0;
 
+    /**
+     * @brief The side of the square, centered on the click, that ApplyClick()
+     * may change.
+     */
+    virtual int mask_size(void) const = 0;
+
  protected:
     /**
      * A pointer to a container of instances of every selectable tool on the
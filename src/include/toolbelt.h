@@ -39,7 +39,12 @@ class ToolBelt {
             PixelBuffer* display_buffer,
             int active_tool,
             ColorData active_color);
-    virtual ~ToolBelt(void) { tools_.clear(); }
+    virtual ~ToolBelt(void) {
+      for (Tool* tool : tools_) {
+        delete tool;
+      }
+      tools_.clear();
+    }
   
     /**
      * @brief Sets the active tool of the toolbelt
@@ -59,7 +64,7 @@ class ToolBelt {
     inline Tool* get_active_tool() { return tools_[active_tool_]; }
     inline ColorData get_active_color() { return active_color_; }
     inline PixelBuffer* get_pixel_buffer() { return my_pixel_buffer_; }
-    inline PixelBuffer* set_pixel_buffer(PixelBuffer* new_pixel_buffer) {
+    inline void set_pixel_buffer(PixelBuffer* new_pixel_buffer) {
       my_pixel_buffer_ = new_pixel_buffer;
     }
     inline Tool* get_buffer_stamper() { return tools_[5]; }
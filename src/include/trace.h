@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Name            : trace.h
+ * Project         : FlashPhoto
+ * Module          : trace
+ * Description     : Header for the Tracer and TraceScope classes
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+#ifndef PROJECT_ITERATION2_SRC_INCLUDE_TRACE_H_
+#define PROJECT_ITERATION2_SRC_INCLUDE_TRACE_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Record the time from here to the end of the enclosing block as one
+ * trace event. name and category must be string literals.
+ */
+#define TRACE_SCOPE(name, category) \
+  ::image_tools::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)( \
+    name, category)
+
+/**
+ * @brief As TRACE_SCOPE, with one integer argument shown with the event.
+ */
+#define TRACE_SCOPE_ARG(name, category, arg_name, arg) \
+  ::image_tools::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)( \
+    name, category, arg_name, arg)
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * @brief Collects timed events from every thread and exports them in the
+ * Chrome trace event format, for chrome://tracing or ui.perfetto.dev.
+ *
+ * Each thread records into its own fixed-size ring buffer, so recording never
+ * takes a lock and never allocates after a thread's first event; when a ring
+ * is full the oldest events are overwritten. While tracing is disabled a
+ * TraceScope costs a single relaxed atomic load.
+ */
+class Tracer {
+ public:
+  static void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  static bool enabled(void) {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Nanoseconds on a monotonic clock, the timebase of all events
+   */
+  static int64_t NowNs(void);
+
+  /**
+   * @brief Add a complete event to the calling thread's ring buffer
+   */
+  static void Record(const char* name, const char* category,
+                     const char* arg_name, int64_t arg,
+                     int64_t start_ns, int64_t end_ns);
+
+  /**
+   * @brief Write the events currently held by every thread's ring buffer as
+   * Chrome trace JSON. Safe to call while other threads are recording.
+   *
+   * @return TRUE if the file was written
+   */
+  static bool WriteChromeTrace(const std::string& file_name);
+
+  /**
+   * @brief Forget all recorded events
+   */
+  static void Clear(void);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * @brief Times its own lifetime as a trace event. Use via TRACE_SCOPE.
+ */
+class TraceScope {
+ public:
+  TraceScope(const char* name, const char* category)
+      : name_(name), category_(category), arg_name_(nullptr), arg_(0),
+        start_ns_(Tracer::enabled() ? Tracer::NowNs() : -1) {}
+  TraceScope(const char* name, const char* category, const char* arg_name,
+             int64_t arg)
+      : name_(name), category_(category), arg_name_(arg_name), arg_(arg),
+        start_ns_(Tracer::enabled() ? Tracer::NowNs() : -1) {}
+  ~TraceScope(void) {
+    if (start_ns_ >= 0) {
+      Tracer::Record(name_, category_, arg_name_, arg_, start_ns_,
+                     Tracer::NowNs());
+    }
+  }
+
+ private:
+  TraceScope(const TraceScope &rhs) = delete;
+  TraceScope& operator=(const TraceScope &rhs) = delete;
+
+  const char* name_;
+  const char* category_;
+  const char* arg_name_;
+  int64_t arg_;
+  int64_t start_ns_;
+};
+
+}  /* namespace image_tools */
+
+#endif  /* PROJECT_ITERATION2_SRC_INCLUDE_TRACE_H_ */
@@ -48,8 +48,10 @@ class UICtrl {
     UI_LOAD_CANVAS_BUTTON,
     UI_LOAD_STAMP_BUTTON,
     UI_SAVE_CANVAS_BUTTON,
+    UI_CANCEL_IO_BUTTON,
     UI_FILE_NAME,
     UI_APPLY_BLUR,
+    UI_APPLY_GAUSSIAN_BLUR,
     UI_APPLY_SHARP,
     UI_APPLY_EDGE,
     UI_APPLY_THRESHOLD,
@@ -58,7 +60,23 @@ class UICtrl {
     UI_APPLY_CHANNEL,
     UI_APPLY_QUANTIZE,
     UI_APPLY_MOTION_BLUR,
+    UI_APPLY_MEDIAN,
+    UI_APPLY_MORPHOLOGY,
+    UI_APPLY_BILATERAL,
     UI_APPLY_SPECIAL_FILTER,
+    UI_PREVIEW_TOGGLE,
+    UI_PREVIEW_BLUR,
+    UI_PREVIEW_GAUSSIAN_BLUR,
+    UI_PREVIEW_MOTION_BLUR,
+    UI_PREVIEW_SHARP,
+    UI_PREVIEW_THRESHOLD,
+    UI_PREVIEW_SATURATE,
+    UI_PREVIEW_CHANNEL,
+    UI_PREVIEW_QUANTIZE,
+    UI_PREVIEW_DITHER,
+    UI_PREVIEW_MEDIAN,
+    UI_PREVIEW_MORPHOLOGY,
+    UI_PREVIEW_BILATERAL,
     UI_UNDO,
     UI_REDO,
     UI_QUIT
@@ -72,6 +90,24 @@ class UICtrl {
     UI_DIR_NE_SW,
     UI_DIR_NW_SE
   };
+  /**
+   * @brief The available dithering methods.
+   */
+  enum DitherMethod {
+    UI_DITHER_BAYER,
+    UI_DITHER_BLUE_NOISE,
+    UI_DITHER_FLOYD_STEINBERG,
+    UI_DITHER_ATKINSON
+  };
+  /**
+   * @brief The available morphological operations.
+   */
+  enum MorphologyOperation {
+    UI_MORPHOLOGY_ERODE,
+    UI_MORPHOLOGY_DILATE,
+    UI_MORPHOLOGY_OPEN,
+    UI_MORPHOLOGY_CLOSE
+  };
 };
 
 }  /* namespace image_tools */
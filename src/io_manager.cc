@@ -13,22 +13,33 @@
  * Includes
  ******************************************************************************/
 #include "include/io_manager.h"
-#include <setjmp.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <string>
 #include "include/ui_ctrl.h"
-#include "include/state_manager.h"
-#include "include/filter_manager.h"
-#include "../ext/libpng-1.6.16/png.h"
-#include "../ext/jpeg-9a/jpeglib.h"
-#include "../ext/jpeg-9a/jerror.h"
+#include "include/image_codec.h"
 #include "include/tool.h"
 #include "include/stamper.h"
+#include "include/tiled_image.h"
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/**
+ * Images with more pixels than this are streamed through a tile file and the
+ * canvas is given a downsampled view no larger than kMaxViewDimension.
+ */
+static const int64_t kMaxCanvasPixels = 64LL << 20;
+static const int kMaxViewDimension = 4096;
+
 /*******************************************************************************
  * Constructors/Destructor
  ******************************************************************************/
@@ -40,7 +51,25 @@ IOManager::IOManager(void) :
     current_file_label_(nullptr),
     file_name_box_(nullptr),
     save_file_label_(nullptr),
-    file_name_() {}
+    progress_label_(nullptr),
+    cancel_io_btn_(nullptr),
+    file_name_(),
+    parallel_jpeg_encode_(1),
+    encode_profile_(ENCODE_PROFILE_BALANCED),
+    jpeg_quality_(75),
+    async_task_(),
+    async_operation_(ASYNC_OP_NONE),
+    async_progress_(),
+    async_done_(false),
+    async_result_(),
+    async_saved_(false) {}
+
+IOManager::~IOManager(void) {
+  async_progress_.RequestCancel();
+  JoinAsyncOperation();
+  delete async_result_.pixel_buffer;
+  delete loaded_pixel_buffer_;
+}
 
 /*******************************************************************************
  * Member Functions
@@ -88,16 +117,43 @@ void IOManager::InitGlui(const GLUI *const glui,
                                     UICtrl::UI_SAVE_CANVAS_BUTTON,
                                     s_gluicallback);
 
+  GLUI_Panel *encode_panel = new GLUI_Panel(image_panel, "Encode Profile");
+  {
+    GLUI_RadioGroup *profile = new GLUI_RadioGroup(encode_panel,
+                                                   &encode_profile_);
+    new GLUI_RadioButton(profile, "Store (no compression)");
+    new GLUI_RadioButton(profile, "Fastest");
+    new GLUI_RadioButton(profile, "Balanced");
+    new GLUI_RadioButton(profile, "Smallest");
+
+    GLUI_Spinner *jpeg_quality = new GLUI_Spinner(encode_panel,
+                                                  "JPEG quality:",
+                                                  &jpeg_quality_);
+    jpeg_quality->set_int_limits(1, 100);
+
+    new GLUI_Checkbox(encode_panel, "Parallel JPEG encode",
+                      &parallel_jpeg_encode_);
+  }
+
+  new GLUI_Separator(image_panel);
+
+  progress_label_ = new GLUI_StaticText(image_panel, "Progress: idle");
+  cancel_io_btn_ = new GLUI_Button(image_panel,
+                                   "Cancel",
+                                   UICtrl::UI_CANCEL_IO_BUTTON,
+                                   s_gluicallback);
+
   load_canvas_toggle(false);
   load_stamp_toggle(false);
   save_canvas_toggle(false);
+  cancel_io_toggle(false);
 }
 
 
 bool IOManager::is_valid_image_file(const std::string & name) {
   FILE *f;
   bool is_valid = false;
-  if (is_valid_image_file_name(name)) {
+  if (ImageCodec::is_valid_image_file_name(name)) {
     if ((f = fopen(name.c_str(), "r"))) {
       is_valid = true;
       fclose(f);
@@ -111,23 +167,27 @@ void IOManager::set_image_file(const std::string & file_name) {
   // instead of a file, use the
   // latest file typed or selected.
   std::string image_file = file_name;
-  if (!is_valid_image_file_name(image_file)) {
+  if (!ImageCodec::is_valid_image_file_name(image_file)) {
     image_file = file_name_;
   }
 
+  // While a background load/save is running, the load and save
+  // buttons stay disabled; they are re-evaluated once it finishes.
+  bool busy = (async_operation_ != ASYNC_OP_NONE);
+
   // TOGGLE SAVE FEATURE
   // If no file is selected or typed,
   // don't allow file to be saved. If
   // there is a file name, then allow
   // file to be saved to that name.
 
-  if (!is_valid_image_file_name(image_file)) {
+  if (!ImageCodec::is_valid_image_file_name(image_file)) {
     save_file_label_->set_text("Will save image: none");
     save_canvas_toggle(false);
   } else {
     save_file_label_->set_text((std::string("Will save image: ") +
                                 image_file).c_str());
-    save_canvas_toggle(true);
+    save_canvas_toggle(!busy);
   }
 
   // TOGGLE LOAD FEATURE
@@ -135,8 +195,8 @@ void IOManager::set_image_file(const std::string & file_name) {
   // If the file specified cannot be opened,
   // then disable stamp and canvas loading.
   if (is_valid_image_file(image_file)) {
-    load_stamp_toggle(true);
-    load_canvas_toggle(true);
+    load_stamp_toggle(!busy);
+    load_canvas_toggle(!busy);
 
     current_file_label_->set_text((std::string("Will load: ") +
                                    image_file).c_str());
@@ -151,13 +211,12 @@ void IOManager::set_image_file(const std::string & file_name) {
 bool IOManager::LoadImageToCanvas(void) {
   std::cout << "Load Canvas has been clicked for file " <<
       file_name_ << std::endl;
-  ValidatedPixelBuffer loaded_image = LoadImageDataFromFile(true);
-
-  if (loaded_pixel_buffer_) {
-    delete loaded_pixel_buffer_;
-  }
+  ValidatedPixelBuffer loaded_image = LoadImageDataFromFile(file_name_, true,
+                                                            nullptr);
 
   if (loaded_image.valid_image) {
+    // Drop any image that was loaded but never handed over.
+    delete loaded_pixel_buffer_;
     loaded_pixel_buffer_ = loaded_image.pixel_buffer;
   } else {
     std::cout << "Image was not valid." << std::endl;
@@ -169,7 +228,8 @@ bool IOManager::LoadImageToCanvas(void) {
 void IOManager::LoadImageToStamp(Tool* stamper) {
   std::cout << "Load Stamp has been clicked for file " <<
       file_name_ << std::endl;
-  ValidatedPixelBuffer loaded_image = LoadImageDataFromFile(false);
+  ValidatedPixelBuffer loaded_image = LoadImageDataFromFile(file_name_, false,
+                                                            nullptr);
 
   if (loaded_image.valid_image) {
     reinterpret_cast<Stamper *>(stamper)->
@@ -177,369 +237,215 @@ void IOManager::LoadImageToStamp(Tool* stamper) {
   } else {
     std::cout << "Image was not valid." << std::endl;
   }
+  // The stamper keeps its own copy of the pixels
+  delete loaded_image.pixel_buffer;
 }
 
 void IOManager::SaveCanvasToFile(PixelBuffer* pixel_buffer) {
   std::cout << "Save Canvas been clicked for file " <<
       file_name_ << std::endl;
-
-  if (has_suffix(file_name_ , ".png")) {
-    SaveCanvasToPNGFile(pixel_buffer);
-  } else if (has_suffix(file_name_, ".jpg") ||
-             has_suffix(file_name_, ".jpeg")) {
-    SaveCanvasToJPEGFile(pixel_buffer);
-  } else {
-    std::cout << "Could not determine image type for save operation." <<
-              std::endl;
-  }
+  SaveBufferToFile(pixel_buffer, file_name_, nullptr);
 }
 
-PixelBuffer* IOManager::GetLoadedPixelBuffer(void) {
-  return loaded_pixel_buffer_;
-}
-
-IOManager::ValidatedPixelBuffer IOManager::LoadImageDataFromFile(
-    bool composite_color_values) {
-  ValidatedPixelBuffer loaded_image;
-  if (has_suffix(file_name_ , ".png")) {
-    loaded_image = LoadImageDataFromPNGFile(composite_color_values);
-  } else if (has_suffix(file_name_, ".jpg") ||
-             has_suffix(file_name_, ".jpeg")) {
-    loaded_image = LoadImageDataFromJPEGFile();
-  } else {
-    std::cout << "Could not determine image type for load operation." <<
-              std::endl;
+bool IOManager::LoadImageToCanvasAsync(void) {
+  if (async_operation_ != ASYNC_OP_NONE) {
+    return false;
   }
-
-  return loaded_image;
+  std::cout << "Load Canvas has been clicked for file " <<
+      file_name_ << std::endl;
+  StartAsyncOperation(ASYNC_OP_LOAD, nullptr);
+  return true;
 }
 
-IOManager::ValidatedPixelBuffer IOManager::LoadImageDataFromJPEGFile(void) {
-  std::cout << "Load JPEG." << std::endl;
-  ValidatedPixelBuffer loaded_image;
-
-  unsigned char *jpeg_image = nullptr;
-
-  struct jpeg_decompress_struct info;
-  struct jpeg_error_mgr jpeg_error;
-  JSAMPROW image_row[1];
-
-  info.err = jpeg_std_error(&jpeg_error);
-
-  FILE *fp = fopen(file_name_.c_str(), "rb");
-
-  if (!fp) {
-    std::cout << "ERROR: Could not open file to load JPEG." << std::endl;
-    return loaded_image;
-  }
-
-  jpeg_create_decompress(&info);
-  jpeg_stdio_src(&info, fp);
-
-  (void) jpeg_read_header(&info, TRUE);
-  (void) jpeg_start_decompress(&info);
-
-  jpeg_image = (unsigned char*)malloc(info.output_width
-                                      * info.output_height
-                                      * info.num_components);
-  image_row[0] = (unsigned char *)malloc(info.output_width*info.num_components);
-
-  int jpeg_index = 0;
-
-  while (info.output_scanline < info.output_height) {
-    (void) jpeg_read_scanlines(&info, image_row, 1);
-    for (int i = 0; i < info.image_width * info.num_components; i++)
-      jpeg_image[jpeg_index++] = image_row[0][i];
-  }
-
-  (void) jpeg_finish_decompress(&info);
-
-  loaded_image.valid_image = true;
-  loaded_image.pixel_buffer = new PixelBuffer(
-    info.image_width,
-    info.image_height,
-    ColorData(1, 1, static_cast<float>(0.95)));
-
-  for (int x = 0; x < info.image_width; x++) {
-    for (int y = 0; y < info.image_height; y++) {
-      float red = static_cast<float>(
-        jpeg_image[(y*info.image_width*3)+(x*3)+0]/255.);
-      float green = static_cast<float>(
-        jpeg_image[(y*info.image_width*3)+(x*3)+1]/255.);
-      float blue = static_cast<float>(
-        jpeg_image[(y*info.image_width*3)+(x*3)+2]/255.);
-      loaded_image.pixel_buffer->set_pixel(x, y, ColorData(red, green, blue));
-    }
+bool IOManager::SaveCanvasToFileAsync(PixelBuffer* pixel_buffer) {
+  if (async_operation_ != ASYNC_OP_NONE) {
+    return false;
   }
+  std::cout << "Save Canvas been clicked for file " <<
+      file_name_ << std::endl;
 
-  jpeg_destroy_decompress(&info);
-  fclose(fp);
-
-  return loaded_image;
+  // The encoder works from a private copy, so the canvas may be painted on
+  // while the file is being written.
+  StartAsyncOperation(ASYNC_OP_SAVE, pixel_buffer->Copy());
+  return true;
 }
 
-IOManager::ValidatedPixelBuffer IOManager::LoadImageDataFromPNGFile(
-    bool composite_color_values) {
-  ValidatedPixelBuffer loaded_image;
-  int width, height;
-  png_byte color_type;
-  png_byte bit_depth;
-  png_bytep* image_rows;
-
-  FILE *fp = fopen(file_name_.c_str(), "rb");
-
-  if (!fp) {
-    std::cout << "ERROR: Could not open file to load PNG." << std::endl;
-    return loaded_image;
-  }
-
-  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING,
-                                           NULL, NULL, NULL);
-  if (!png) {
-    std::cout << "ERROR: Could not create read struct for PNG." << std::endl;
-    fclose(fp);
-    return loaded_image;
-  }
-
-  png_infop info = png_create_info_struct(png);
-  if (!info) {
-    std::cout << "ERROR: Could not create info struct for PNG." << std::endl;
-    fclose(fp);
-    png = nullptr;
-    return loaded_image;
+void IOManager::CancelAsyncOperation(void) {
+  if (async_operation_ != ASYNC_OP_NONE) {
+    std::cout << "Cancelling image I/O..." << std::endl;
+    async_progress_.RequestCancel();
+    UpdateProgressLabel("Progress: cancelling");
   }
+}
 
-  if (setjmp(png_jmpbuf(png)))  {
-    std::cout << "ERROR: Could not initialize read buffer for PNG."
-              << std::endl;
-    fclose(fp);
-    png = nullptr;
-    info = nullptr;
-    return loaded_image;
+IOManager::AsyncStatus IOManager::PollAsyncOperation(void) {
+  if (async_operation_ == ASYNC_OP_NONE) {
+    return ASYNC_IDLE;
   }
-  png_init_io(png, fp);
-
-  png_read_info(png, info);
-
-  width      = png_get_image_width(png, info);
-  height     = png_get_image_height(png, info);
-  color_type = png_get_color_type(png, info);
-  bit_depth  = png_get_bit_depth(png, info);
-
-  if (bit_depth == 16)
-    png_set_strip_16(png);
 
-  if (color_type == PNG_COLOR_TYPE_PALETTE)
-    png_set_palette_to_rgb(png);
-
-  if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
-    png_set_expand_gray_1_2_4_to_8(png);
-
-  if (color_type == PNG_COLOR_TYPE_GRAY ||
-    color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
-      png_set_gray_to_rgb(png);
+  if (!async_done_.load()) {
+    int percent = static_cast<int>(async_progress_.fraction_done() * 100);
+    UpdateProgressLabel(
+      std::string((async_operation_ == ASYNC_OP_LOAD) ? "Loading: " :
+                  "Saving: ") + std::to_string(percent) + "%");
+    return ASYNC_RUNNING;
   }
 
-  if (png_get_valid(png, info, PNG_INFO_tRNS))
-    png_set_tRNS_to_alpha(png);
-
-  // Fill in the alpha values if the color type does not contain an alpha value.
-  if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY ||
-    color_type == PNG_COLOR_TYPE_PALETTE) {
-    png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
-  }
+  JoinAsyncOperation();
+  AsyncOperation finished_operation = async_operation_;
+  async_operation_ = ASYNC_OP_NONE;
+  cancel_io_toggle(false);
+  set_image_file(file_name_);
 
-  png_read_update_info(png, info);
+  ValidatedPixelBuffer result = async_result_;
+  async_result_ = ValidatedPixelBuffer();
 
-  image_rows = reinterpret_cast<png_bytep*>(malloc(sizeof(png_bytep) * height));
-  for (int y = 0; y < height; y++) {
-    image_rows[y] = reinterpret_cast<png_byte*>(
-      malloc(png_get_rowbytes(png, info)));
+  if (async_progress_.cancel_requested()) {
+    delete result.pixel_buffer;
+    UpdateProgressLabel("Progress: cancelled");
+    return ASYNC_CANCELLED;
   }
 
-  png_read_image(png, image_rows);
-
-  fclose(fp);
-  png = nullptr;
-  info = nullptr;
-
-  ColorData background_color = ColorData(1, 1, static_cast<float>(0.95));
-  loaded_image.valid_image = true;
-  loaded_image.pixel_buffer = new PixelBuffer(width, height, background_color);
-
-  for (int y = 0; y < height; y++) {
-    png_bytep row = image_rows[y];
-    for (int x = 0; x < width; x++) {
-      // Get the RGBA values from the PNG.
-      float red = static_cast<float>(image_rows[y][(x * 4) + 0 ] / 255.);
-      float green = static_cast<float>(image_rows[y][(x * 4) + 1] / 255.);
-      float blue = static_cast<float>(image_rows[y][(x * 4) + 2] / 255.);
-      float alpha = static_cast<float>(image_rows[y][(x * 4) + 3] / 255.);
-
-      if (composite_color_values) {
-        // Composite the values with the background.
-        red = (red * alpha) + (background_color.clamped_color().red()
-                               * (1 - alpha));
-        green = (green * alpha) + (background_color.clamped_color().red()
-                                   * (1 - alpha));
-        blue = (blue * alpha) + (background_color.clamped_color().blue()
-                                 * (1 - alpha));
-        alpha = alpha + (background_color.clamped_color().alpha()
-                         * (1 - alpha));
-      }
-
-      // Apply new color to the pixel buffer.
-      loaded_image.pixel_buffer->set_pixel(
-        x, y, ColorData(red, green, blue, alpha));
+  if (finished_operation == ASYNC_OP_LOAD) {
+    if (!result.valid_image) {
+      std::cout << "Image was not valid." << std::endl;
+      UpdateProgressLabel("Progress: load failed");
+      return ASYNC_FAILED;
     }
+    delete loaded_pixel_buffer_;
+    loaded_pixel_buffer_ = result.pixel_buffer;
+    UpdateProgressLabel("Progress: loaded");
+    return ASYNC_LOAD_FINISHED;
   }
 
-  for (int y = 0; y < height; y++) {
-    free(image_rows[y]);
+  if (!async_saved_) {
+    UpdateProgressLabel("Progress: save failed");
+    return ASYNC_FAILED;
   }
-  free(image_rows);
-
-  std::cout << "Loaded PNG." << std::endl;
-  return loaded_image;
+  UpdateProgressLabel("Progress: saved");
+  return ASYNC_SAVE_FINISHED;
 }
 
-void IOManager::SaveCanvasToPNGFile(PixelBuffer* pixel_buffer) {
-  int input_components = 4;
-  png_bytep* image_rows = reinterpret_cast<png_bytep*>(
-    malloc(sizeof(png_bytep) * pixel_buffer->height()));
-
-  for (int y = 0; y < pixel_buffer->height(); y++) {
-    image_rows[y] = reinterpret_cast<png_byte*>(
-      malloc(pixel_buffer->width() * input_components * sizeof(png_byte)));
-  }
-
-  for (int y = 0; y < pixel_buffer->height(); y++) {
-    for (int x = 0; x < pixel_buffer->width(); x++) {
-      ColorData color_data = pixel_buffer->get_pixel(x, y);
-      color_data = color_data.clamped_color();
-
-      int pixel_index = (x * input_components);
-      image_rows[y][pixel_index] = (png_byte)(color_data.red() * 255.);
-      image_rows[y][pixel_index + 1] = (png_byte)(color_data.green() * 255.);
-      image_rows[y][pixel_index + 2] = (png_byte)(color_data.blue() * 255.);
-      image_rows[y][pixel_index + 3] = (png_byte)(color_data.alpha() * 255.);
-    }
-  }
+PixelBuffer* IOManager::GetLoadedPixelBuffer(void) {
+  PixelBuffer* loaded_pixel_buffer = loaded_pixel_buffer_;
+  loaded_pixel_buffer_ = nullptr;
+  return loaded_pixel_buffer;
+}
 
-  FILE *fp = fopen(file_name_.c_str(), "wb");
+void IOManager::StartAsyncOperation(AsyncOperation operation,
+                                    PixelBuffer* snapshot) {
+  async_operation_ = operation;
+  async_progress_.Reset(0);
+  async_done_.store(false);
+  async_result_ = ValidatedPixelBuffer();
+  async_saved_ = false;
 
-  if (!fp) {
-    std::cout << "ERROR: Could not open file to write PNG." << std::endl;
-    return;
-  }
+  load_canvas_toggle(false);
+  load_stamp_toggle(false);
+  save_canvas_toggle(false);
+  cancel_io_toggle(true);
+  UpdateProgressLabel((operation == ASYNC_OP_LOAD) ? "Loading: 0%" :
+                      "Saving: 0%");
+
+  std::string file_name = file_name_;
+  async_task_.Run([this, operation, file_name, snapshot]() {
+    RunAsyncOperation(operation, file_name, snapshot);
+  }, TASK_PRIORITY_BACKGROUND);
+}
 
-  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING,
-                                            NULL, NULL, NULL);
-  if (!png) {
-    std::cout << "ERROR: Could not create write struct for PNG." << std::endl;
-    return;
+void IOManager::RunAsyncOperation(AsyncOperation operation,
+                                  std::string file_name,
+                                  PixelBuffer* snapshot) {
+  TRACE_SCOPE("IOManager::RunAsyncOperation", "io");
+  if (operation == ASYNC_OP_LOAD) {
+    async_result_ = LoadImageDataFromFile(file_name, true, &async_progress_);
+  } else {
+    async_saved_ = SaveBufferToFile(snapshot, file_name, &async_progress_);
+    delete snapshot;
   }
+  async_done_.store(true);
+}
 
-  png_infop info = png_create_info_struct(png);
-  if (!info) {
-    std::cout << "ERROR: Could not create info struct to write PNG."
-              << std::endl;
-    return;
-  }
+void IOManager::JoinAsyncOperation(void) {
+  async_task_.Wait();
+}
 
-  if (setjmp(png_jmpbuf(png))) {
-    std::cout << "ERROR: Could not initialize write buffer for PNG."
-              << std::endl;
-    return;
+void IOManager::UpdateProgressLabel(const std::string& text) {
+  if (progress_label_) {
+    progress_label_->set_text(text.c_str());
   }
+}
 
-  png_init_io(png, fp);
-
-  png_set_IHDR(png,
-               info,
-               pixel_buffer->width(),
-               pixel_buffer->height(),
-               8,
-               PNG_COLOR_TYPE_RGBA,
-               PNG_INTERLACE_NONE,
-               PNG_COMPRESSION_TYPE_DEFAULT,
-               PNG_FILTER_TYPE_DEFAULT);
-
-  png_write_info(png, info);
-
-  png_write_image(png, image_rows);
-  png_write_end(png, nullptr);
-
-  fclose(fp);
-
-  png_destroy_write_struct(&png, &info);
-
-  for (int y = 0; y < pixel_buffer->height(); y++) {
-    free(image_rows[y]);
+IOManager::ValidatedPixelBuffer IOManager::LoadImageDataFromFile(
+    const std::string& file_name,
+    bool composite_color_values,
+    IOProgress* progress) {
+  ValidatedPixelBuffer loaded_image;
+  int width = 0;
+  int height = 0;
+  if (ImageCodec::ReadDimensions(file_name, &width, &height) &&
+      static_cast<int64_t>(width) * height > kMaxCanvasPixels) {
+    TiledImage* tiled = ImageCodec::LoadTiled(file_name,
+                                              composite_color_values, "",
+                                              progress);
+    loaded_image.pixel_buffer = nullptr;
+    if (tiled) {
+      loaded_image.pixel_buffer = tiled->Downsample(kMaxViewDimension,
+                                                    kMaxViewDimension);
+      std::cout << file_name << " is " << width << "x" << height
+                << "; showing a " << loaded_image.pixel_buffer->width() << "x"
+                << loaded_image.pixel_buffer->height()
+                << " downsampled view. Use FlashPhotoCLI to filter it at"
+                << " full size." << std::endl;
+      delete tiled;
+    }
+  } else {
+    loaded_image.pixel_buffer = ImageCodec::Load(file_name,
+                                                 composite_color_values,
+                                                 progress);
   }
-  free(image_rows);
-
-  std::cout << "Saved PNG." << std::endl;
+  loaded_image.valid_image = (loaded_image.pixel_buffer != nullptr);
+  return loaded_image;
 }
 
-void IOManager::SaveCanvasToJPEGFile(PixelBuffer* pixel_buffer) {
-  // We have 3 image components (RGB), JPEGs do not support transparency/alpha.
-  int input_components = 3;
-
-  unsigned char *jpeg_image = nullptr;
-
-  struct jpeg_compress_struct info;
-  struct jpeg_error_mgr jpeg_error;
-  JSAMPROW image_rows[1];
-
-  info.err = jpeg_std_error(&jpeg_error);
-  jpeg_create_compress(&info);
-
-  FILE *fp = fopen(file_name_.c_str(), "wb");
-
-  if (!fp) {
-    std::cout << "ERROR: Could not open file to write JPEG." << std::endl;
-    return;
+bool IOManager::SaveBufferToFile(PixelBuffer* pixel_buffer,
+                                 const std::string& file_name,
+                                 IOProgress* progress) {
+  EncodeProfile profile = encode_profile();
+  JpegEncodeSettings jpeg_settings = JpegEncodeSettings::ForProfile(
+    profile, jpeg_quality_);
+  jpeg_settings.parallel_strips = (parallel_jpeg_encode_ != 0);
+
+  auto start = std::chrono::steady_clock::now();
+  if (!ImageCodec::Save(*pixel_buffer, file_name,
+                        PngEncodeSettings::ForProfile(profile),
+                        jpeg_settings, progress)) {
+    return false;
   }
 
-  jpeg_stdio_dest(&info, fp);
-
-  info.image_height = pixel_buffer->height();
-  info.image_width = pixel_buffer->width();
-  info.input_components = input_components;
-  info.in_color_space = JCS_RGB;
-
-  jpeg_set_defaults(&info);
-
-  jpeg_start_compress(&info, TRUE);
-
-  jpeg_image = (unsigned char *)malloc(
-    info.image_width * info.image_height * input_components);
-
-  for (int y = 0; y < info.image_height; y++) {
-    for (int x = 0; x < info.image_width; x++) {
-      ColorData color_data = pixel_buffer->get_pixel(x, y);
-      color_data = color_data.clamped_color();
-
-      int pixel_index = (y * info.image_width * input_components)
-                        + (x * input_components);
-      jpeg_image[pixel_index] = (color_data.red() * 255.);
-      jpeg_image[pixel_index + 1] = (color_data.green() * 255.);
-      jpeg_image[pixel_index + 2] = (color_data.blue() * 255.);
-    }
-  }
+  std::cout << (ImageCodec::is_png_file_name(file_name) ? "Saved PNG" :
+                "Saved JPEG");
+  PrintEncodeStats(file_name, profile, start);
+  return true;
+}
 
-  while (info.next_scanline < info.image_height) {
-    image_rows[0] = &jpeg_image[
-      info.next_scanline * info.image_width * input_components];
-    (void) jpeg_write_scanlines(&info, image_rows, 1);
+void IOManager::PrintEncodeStats(
+    const std::string& file_name,
+    EncodeProfile profile,
+    std::chrono::steady_clock::time_point start) {
+  double elapsed_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+
+  long file_size = -1;
+  FILE *fp = fopen(file_name.c_str(), "rb");
+  if (fp) {
+    fseek(fp, 0, SEEK_END);
+    file_size = ftell(fp);
+    fclose(fp);
   }
 
-  jpeg_finish_compress(&info);
-  fclose(fp);
-  jpeg_destroy_compress(&info);
-
-  std::cout << "Saved JPEG." << std::endl;
+  std::cout << " (" << EncodeProfileName(profile) << " profile): "
+            << file_size << " bytes in " << elapsed_ms << " ms." << std::endl;
 }
 
 }  /* namespace image_tools */
@@ -0,0 +1,354 @@
+/*******************************************************************************
+ * Name            : jpeg_encoder.cc
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Implementation of the JpegEncoder class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/jpeg_encoder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "include/trace.h"
+#include "../ext/jpeg-9a/jpeglib.h"
+#include "include/color_data.h"
+#include "include/task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** Rows/columns of pixels in an MCU with 2x2 chroma subsampling */
+const int kMCUSize = 16;
+
+/** The largest restart interval a DRI marker can hold */
+const unsigned int kMaxRestartInterval = 65535;
+
+/*
+ * libjpeg's fixed-point RGB -> YCbCr constants (see jccolor.c), so the planes
+ * match what libjpeg would have produced itself.
+ */
+const int kScaleBits = 16;
+const int kOneHalf = 1 << (kScaleBits - 1);
+const int kCbCrOffset = 128 << kScaleBits;
+#define FIX(x) (static_cast<int>((x) * (1L << kScaleBits) + 0.5))
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static inline unsigned char ToSample(float value) {
+  return static_cast<unsigned char>(value * 255.);
+}
+
+static inline int ReadUint16(const std::vector<unsigned char>& data,
+                             size_t offset) {
+  return (data[offset] << 8) | data[offset + 1];
+}
+
+/**
+ * @brief Find the end of the SOS marker segment, i.e. the start of the entropy
+ * coded data.
+ *
+ * @return The offset, or 0 if the headers could not be parsed
+ */
+static size_t FindScanData(const std::vector<unsigned char>& jpeg,
+                           size_t* frame_height_offset) {
+  size_t pos = 2;  // Skip SOI
+  while (pos + 4 <= jpeg.size()) {
+    if (jpeg[pos] != 0xFF) {
+      return 0;
+    }
+    int marker = jpeg[pos + 1];
+    size_t length = ReadUint16(jpeg, pos + 2);
+    if (marker == 0xDA) {
+      return pos + 2 + length;
+    }
+    bool is_frame_marker = (marker >= 0xC0 && marker <= 0xCF &&
+                            marker != 0xC4 && marker != 0xC8 &&
+                            marker != 0xCC);
+    if (is_frame_marker && frame_height_offset) {
+      // Segment length (2), sample precision (1), then the height.
+      *frame_height_offset = pos + 5;
+    }
+    pos += 2 + length;
+  }
+  return 0;
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+bool JpegEncoder::Encode(const PixelBuffer& pixel_buffer,
+                         const std::string& file_name,
+                         const JpegEncodeSettings& settings,
+                         IOProgress* progress) {
+  TRACE_SCOPE("JpegEncoder::Encode", "io");
+  const int width = pixel_buffer.width();
+  const int height = pixel_buffer.height();
+
+  if (progress) {
+    // One step per row for conversion, one for compression.
+    progress->set_rows_total(2 * height);
+  }
+
+  YCbCrPlanes planes;
+  if (!ConvertToYCbCr(pixel_buffer, &planes, progress)) {
+    return false;
+  }
+
+  int mcu_rows = planes.height / kMCUSize;
+  unsigned int mcus_per_row = planes.width / kMCUSize;
+
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+  int thread_count = scheduler.concurrency();
+  int mcu_rows_per_strip = (mcu_rows + thread_count - 1) / thread_count;
+  while (mcu_rows_per_strip > 1 &&
+         mcu_rows_per_strip * mcus_per_row > kMaxRestartInterval) {
+    mcu_rows_per_strip--;
+  }
+  int strip_count = (mcu_rows + mcu_rows_per_strip - 1) / mcu_rows_per_strip;
+
+  std::vector<unsigned char> jpeg;
+  // Strips can only be spliced if they share one scan and one set of tables.
+  bool parallel_strips = (settings.parallel_strips && !settings.progressive &&
+                          !settings.optimize_coding);
+  if (!parallel_strips || strip_count < 2 ||
+      mcu_rows_per_strip * mcus_per_row > kMaxRestartInterval) {
+    if (!CompressRows(planes, width, 0, height, settings, 0, &jpeg,
+                      progress)) {
+      return false;
+    }
+  } else {
+    const int rows_per_strip = mcu_rows_per_strip * kMCUSize;
+    const unsigned int restart_interval = mcu_rows_per_strip * mcus_per_row;
+    std::vector<std::vector<unsigned char> > strip_jpegs(strip_count);
+    std::atomic<bool> cancelled(false);
+
+    scheduler.ParallelFor(0, strip_count, 1, [&](int s_begin, int s_end) {
+      for (int s = s_begin; s < s_end; s++) {
+        if (cancelled) {
+          continue;
+        }
+        int first_row = s * rows_per_strip;
+        if (!CompressRows(planes, width, first_row,
+                          std::min(rows_per_strip, height - first_row),
+                          settings, restart_interval, &strip_jpegs[s],
+                          progress)) {
+          cancelled = true;
+        }
+      }
+    });
+
+    if (cancelled) {
+      return false;
+    }
+    if (!SpliceStrips(strip_jpegs, height, &jpeg)) {
+      std::cout << "ERROR: Could not assemble JPEG strips." << std::endl;
+      return false;
+    }
+  }
+
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to write JPEG." << std::endl;
+    return false;
+  }
+  bool written = (fwrite(jpeg.data(), 1, jpeg.size(), fp) == jpeg.size());
+  fclose(fp);
+
+  if (!written) {
+    std::cout << "ERROR: Could not write JPEG." << std::endl;
+    std::remove(file_name.c_str());
+  }
+  return written;
+}
+
+bool JpegEncoder::ConvertToYCbCr(const PixelBuffer& pixel_buffer,
+                                 YCbCrPlanes* planes,
+                                 IOProgress* progress) {
+  TRACE_SCOPE("JpegEncoder::ConvertToYCbCr", "io");
+  const int width = pixel_buffer.width();
+  const int height = pixel_buffer.height();
+  const int padded_width = (width + kMCUSize - 1) / kMCUSize * kMCUSize;
+  const int padded_height = (height + kMCUSize - 1) / kMCUSize * kMCUSize;
+  const size_t plane_size = static_cast<size_t>(padded_width) * padded_height;
+
+  planes->width = padded_width;
+  planes->height = padded_height;
+  planes->y.resize(plane_size);
+  planes->cb.resize(plane_size);
+  planes->cr.resize(plane_size);
+
+  std::atomic<bool> cancelled(false);
+
+  TaskScheduler::Instance().ParallelFor(0, padded_height, 0,
+                                        [&](int row_begin, int row_end) {
+    for (int row = row_begin; row < row_end; row++) {
+      if (cancelled || (progress && progress->cancel_requested())) {
+        cancelled = true;
+        return;
+      }
+
+      // Padding rows and columns repeat the last row/column of the image, as
+      // libjpeg's own edge expansion does.
+      int y = std::min(row, height - 1);
+      const ColorData* src = pixel_buffer.data() + width * (height - (y + 1));
+      size_t offset = static_cast<size_t>(row) * padded_width;
+      unsigned char* luma = &planes->y[offset];
+      unsigned char* cb = &planes->cb[offset];
+      unsigned char* cr = &planes->cr[offset];
+      for (int column = 0; column < padded_width; column++) {
+        ColorData color_data = src[std::min(column, width - 1)].clamped_color();
+        int r = ToSample(color_data.red());
+        int g = ToSample(color_data.green());
+        int b = ToSample(color_data.blue());
+
+        luma[column] = static_cast<unsigned char>(
+          (FIX(0.299) * r + FIX(0.587) * g + FIX(0.114) * b + kOneHalf) >>
+          kScaleBits);
+        cb[column] = static_cast<unsigned char>(
+          (-FIX(0.168735892) * r - FIX(0.331264108) * g + FIX(0.5) * b +
+           kCbCrOffset + kOneHalf - 1) >> kScaleBits);
+        cr[column] = static_cast<unsigned char>(
+          (FIX(0.5) * r - FIX(0.418687589) * g - FIX(0.081312411) * b +
+           kCbCrOffset + kOneHalf - 1) >> kScaleBits);
+      }
+
+      if (progress && row < height) {
+        progress->AdvanceRow();
+      }
+    }
+  });
+
+  return !cancelled;
+}
+
+bool JpegEncoder::CompressRows(const YCbCrPlanes& planes,
+                               int image_width,
+                               int first_row,
+                               int row_count,
+                               const JpegEncodeSettings& settings,
+                               unsigned int restart_interval,
+                               std::vector<unsigned char>* jpeg,
+                               IOProgress* progress) {
+  TRACE_SCOPE("JpegEncoder::CompressRows", "io");
+  struct jpeg_compress_struct info;
+  struct jpeg_error_mgr jpeg_error;
+  unsigned char* out_buffer = nullptr;
+  unsigned long out_size = 0;
+
+  info.err = jpeg_std_error(&jpeg_error);
+  jpeg_create_compress(&info);
+  jpeg_mem_dest(&info, &out_buffer, &out_size);
+
+  info.image_width = image_width;
+  info.image_height = row_count;
+  info.input_components = 3;
+  info.in_color_space = JCS_YCbCr;
+
+  jpeg_set_defaults(&info);
+  jpeg_set_quality(&info, settings.quality, TRUE);
+  if (settings.progressive) {
+    jpeg_simple_progression(&info);
+  }
+  info.optimize_coding = settings.optimize_coding ? TRUE : FALSE;
+  info.dct_method = settings.fast_dct ? JDCT_IFAST : JDCT_ISLOW;
+  info.raw_data_in = TRUE;
+  info.restart_interval = restart_interval;
+
+  jpeg_start_compress(&info, TRUE);
+
+  JSAMPROW y_rows[kMCUSize];
+  JSAMPROW cb_rows[kMCUSize];
+  JSAMPROW cr_rows[kMCUSize];
+  JSAMPARRAY component_rows[3] = {y_rows, cb_rows, cr_rows};
+
+  bool cancelled = false;
+  for (int row = 0; row < row_count; row += kMCUSize) {
+    if (progress && progress->cancel_requested()) {
+      cancelled = true;
+      break;
+    }
+
+    for (int i = 0; i < kMCUSize; i++) {
+      size_t offset = static_cast<size_t>(first_row + row + i) * planes.width;
+      y_rows[i] = const_cast<JSAMPROW>(&planes.y[offset]);
+      cb_rows[i] = const_cast<JSAMPROW>(&planes.cb[offset]);
+      cr_rows[i] = const_cast<JSAMPROW>(&planes.cr[offset]);
+    }
+    (void) jpeg_write_raw_data(&info, component_rows, kMCUSize);
+
+    if (progress) {
+      for (int i = row; i < std::min(row + kMCUSize, row_count); i++) {
+        progress->AdvanceRow();
+      }
+    }
+  }
+
+  if (cancelled) {
+    jpeg_abort_compress(&info);
+  } else {
+    jpeg_finish_compress(&info);
+    jpeg->assign(out_buffer, out_buffer + out_size);
+  }
+  jpeg_destroy_compress(&info);
+  free(out_buffer);
+
+  return !cancelled;
+}
+
+bool JpegEncoder::SpliceStrips(
+    const std::vector<std::vector<unsigned char> >& strip_jpegs,
+    int image_height,
+    std::vector<unsigned char>* jpeg) {
+  size_t frame_height_offset = 0;
+  size_t scan_start = FindScanData(strip_jpegs[0], &frame_height_offset);
+  if (scan_start == 0 || frame_height_offset == 0) {
+    return false;
+  }
+
+  // The first strip's headers (tables, restart interval and scan header)
+  // serve the whole image once the frame height is corrected.
+  jpeg->assign(strip_jpegs[0].begin(), strip_jpegs[0].begin() + scan_start);
+  (*jpeg)[frame_height_offset] =
+    static_cast<unsigned char>((image_height >> 8) & 0xFF);
+  (*jpeg)[frame_height_offset + 1] =
+    static_cast<unsigned char>(image_height & 0xFF);
+
+  for (size_t s = 0; s < strip_jpegs.size(); s++) {
+    const std::vector<unsigned char>& strip = strip_jpegs[s];
+    size_t data_start = (s == 0) ? scan_start : FindScanData(strip, nullptr);
+    size_t size = strip.size();
+    if (data_start == 0 || size < data_start + 2 ||
+        strip[size - 2] != 0xFF || strip[size - 1] != 0xD9) {
+      return false;
+    }
+    if (s > 0) {
+      jpeg->push_back(0xFF);
+      jpeg->push_back(static_cast<unsigned char>(0xD0 + ((s - 1) & 7)));
+    }
+    jpeg->insert(jpeg->end(), strip.begin() + data_start,
+                 strip.begin() + (size - 2));
+  }
+
+  jpeg->push_back(0xFF);
+  jpeg->push_back(0xD9);
+  return true;
+}
+
+}  /* namespace image_tools */
@@ -12,8 +12,10 @@
 /*******************************************************************************
  * Includes
  ******************************************************************************/
+#include <iostream>
 #include "include/flashphoto_app.h"
 #include "include/color_data.h"
+#include "include/memory_accounting.h"
 
 /*******************************************************************************
  * Functions
@@ -26,5 +28,6 @@ int main(int argc, char* argv[]) {
   // runMainLoop returns when the user closes the graphics window.
   app->RunMainLoop();
   delete app;
+  image_tools::MemoryAccounting::ReportLeaks(std::cerr);
   exit(0);
 }
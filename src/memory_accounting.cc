@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Name            : memory_accounting.cc
+ * Project         : FlashPhoto
+ * Module          : memory_accounting
+ * Description     : Implementation of the MemoryAccounting class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/memory_accounting.h"
+#include <atomic>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+static const char* kSubsystemNames[MEMORY_SUBSYSTEM_COUNT] = {
+  "pixel buffers", "undo history", "tool masks", "filter kernels"
+};
+
+/** The undo history's budget until set_budget() is called: 1 GiB */
+static const int64_t kDefaultUndoBudget = int64_t(1) << 30;
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+struct SubsystemCounters {
+  std::atomic<int64_t> live_bytes;
+  std::atomic<int64_t> peak_bytes;
+  std::atomic<int64_t> live_allocations;
+  std::atomic<int64_t> total_allocations;
+};
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static SubsystemCounters s_counters[MEMORY_SUBSYSTEM_COUNT];
+static std::atomic<int64_t> s_budgets[MEMORY_SUBSYSTEM_COUNT] = {
+  {0}, {kDefaultUndoBudget}, {0}, {0}
+};
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void MemoryAccounting::RecordAllocation(MemorySubsystem subsystem,
+                                        size_t bytes) {
+  SubsystemCounters& counters = s_counters[subsystem];
+  int64_t live = counters.live_bytes.fetch_add(bytes) + bytes;
+  int64_t peak = counters.peak_bytes.load();
+  while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak,
+                                                                   live)) {
+  }
+  counters.live_allocations++;
+  counters.total_allocations++;
+}
+
+void MemoryAccounting::RecordFree(MemorySubsystem subsystem, size_t bytes) {
+  SubsystemCounters& counters = s_counters[subsystem];
+  counters.live_bytes -= bytes;
+  counters.live_allocations--;
+}
+
+MemoryUsage MemoryAccounting::usage(MemorySubsystem subsystem) {
+  MemoryUsage usage;
+  usage.live_bytes = s_counters[subsystem].live_bytes.load();
+  usage.peak_bytes = s_counters[subsystem].peak_bytes.load();
+  usage.live_allocations = s_counters[subsystem].live_allocations.load();
+  usage.total_allocations = s_counters[subsystem].total_allocations.load();
+  return usage;
+}
+
+int64_t MemoryAccounting::budget(MemorySubsystem subsystem) {
+  return s_budgets[subsystem].load();
+}
+
+void MemoryAccounting::set_budget(MemorySubsystem subsystem, int64_t bytes) {
+  s_budgets[subsystem] = (bytes > 0) ? bytes : 0;
+}
+
+bool MemoryAccounting::over_budget(MemorySubsystem subsystem) {
+  int64_t limit = s_budgets[subsystem].load();
+  return limit > 0 && s_counters[subsystem].live_bytes.load() > limit;
+}
+
+const char* MemoryAccounting::SubsystemName(MemorySubsystem subsystem) {
+  return kSubsystemNames[subsystem];
+}
+
+void MemoryAccounting::PrintReport(std::ostream& out) {
+  for (int s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+    MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+    MemoryUsage counts = usage(subsystem);
+    out << SubsystemName(subsystem) << ": " << counts.live_bytes
+        << " bytes in " << counts.live_allocations << " allocations (peak "
+        << counts.peak_bytes << " bytes, " << counts.total_allocations
+        << " allocations in total)" << std::endl;
+  }
+}
+
+bool MemoryAccounting::ReportLeaks(std::ostream& out) {
+  bool clean = true;
+  for (int s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+    MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+    MemoryUsage counts = usage(subsystem);
+    if (counts.live_allocations != 0 || counts.live_bytes != 0) {
+      if (clean) {
+        out << "Memory still allocated at exit:" << std::endl;
+        clean = false;
+      }
+      out << "  " << SubsystemName(subsystem) << ": " << counts.live_bytes
+          << " bytes in " << counts.live_allocations << " allocations"
+          << std::endl;
+    }
+  }
+  return clean;
+}
+
+}  /* namespace image_tools */
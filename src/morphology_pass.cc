@@ -0,0 +1,244 @@
+/*******************************************************************************
+ * Name            : morphology_pass.cc
+ * Project         : FlashPhoto
+ * Module          : morphology_pass
+ * Description     : Implementation of the MorphologyPass class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/morphology_pass.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int MorphologyPass::kStripColumns;
+
+/** Floats per pixel: red, green and blue */
+const int kChannels = 3;
+
+/** Floats per pixel in grayscale: the luminance, then red, green and blue */
+const int kKeyedChannels = 4;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+struct Minimum {
+  static float Of(float a, float b) { return std::min(a, b); }
+  static bool Prefers(float a, float b) { return a <= b; }
+  static float identity(void) {
+    return std::numeric_limits<float>::infinity();
+  }
+};
+
+struct Maximum {
+  static float Of(float a, float b) { return std::max(a, b); }
+  static bool Prefers(float a, float b) { return a >= b; }
+  static float identity(void) {
+    return -std::numeric_limits<float>::infinity();
+  }
+};
+
+/**
+ * @brief van Herk/Gil-Werman over a padded line of channels interleaved
+ * floats: running extremes forward from the start of each block of window
+ * samples into prefix and backward from its end into suffix, then the
+ * extreme of window samples starting at each i is that of suffix[i] and
+ * prefix[i + window - 1]
+ */
+template <class Pick>
+static void VanHerkGilWerman(float* data, float* prefix, float* suffix,
+                             int length, int padded, int window,
+                             int channels) {
+  for (int block = 0; block < padded; block += window) {
+    const float* in = data + block * channels;
+    float* forward = prefix + block * channels;
+    float* backward = suffix + block * channels;
+    std::copy(in, in + channels, forward);
+    for (int i = channels; i < window * channels; i++) {
+      forward[i] = Pick::Of(forward[i - channels], in[i]);
+    }
+    int last = (window - 1) * channels;
+    std::copy(in + last, in + last + channels, backward + last);
+    for (int i = last - 1; i >= 0; i--) {
+      backward[i] = Pick::Of(backward[i + channels], in[i]);
+    }
+  }
+
+  const float* ahead = prefix + (window - 1) * channels;
+  for (int i = 0; i < length * channels; i++) {
+    data[i] = Pick::Of(suffix[i], ahead[i]);
+  }
+}
+
+/**
+ * @brief Whichever of pixels a and b Pick chooses by their luminance (their
+ * first float), copied whole to to
+ */
+template <class Pick>
+static inline void PickKeyed(const float* a, const float* b, float* to) {
+  const float* from = Pick::Prefers(a[0], b[0]) ? a : b;
+  std::copy(from, from + kKeyedChannels, to);
+}
+
+/**
+ * @brief VanHerkGilWerman() over pixels of kKeyedChannels floats, channels
+ * floats per sample, ordered by luminance alone, so each result is one of the
+ * pixels in its window, with its own color
+ */
+template <class Pick>
+static void VanHerkGilWermanKeyed(float* data, float* prefix, float* suffix,
+                                  int length, int padded, int window,
+                                  int channels) {
+  for (int block = 0; block < padded; block += window) {
+    const float* in = data + block * channels;
+    float* forward = prefix + block * channels;
+    float* backward = suffix + block * channels;
+    std::copy(in, in + channels, forward);
+    for (int i = channels; i < window * channels; i += kKeyedChannels) {
+      PickKeyed<Pick>(forward + i - channels, in + i, forward + i);
+    }
+    int last = (window - 1) * channels;
+    std::copy(in + last, in + last + channels, backward + last);
+    for (int i = last - kKeyedChannels; i >= 0; i -= kKeyedChannels) {
+      PickKeyed<Pick>(backward + i + channels, in + i, backward + i);
+    }
+  }
+
+  const float* ahead = prefix + (window - 1) * channels;
+  for (int i = 0; i < length * channels; i += kKeyedChannels) {
+    PickKeyed<Pick>(suffix + i, ahead + i, data + i);
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+MorphologyPass::MorphologyPass(bool dilate, int radius_x, int radius_y,
+                               bool grayscale)
+    : dilate_(dilate), radius_x_(std::max(0, radius_x)),
+      radius_y_(std::max(0, radius_y)), grayscale_(grayscale) {}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int MorphologyPass::padded(int length, int radius) {
+  int window = 2 * radius + 1;
+  return (length + 2 * radius + window - 1) / window * window;
+}
+
+void MorphologyPass::FilterLine(float* data, float* scratch, int length,
+                            int radius, int channels) const {
+  int padded_length = padded(length, radius);
+  float* prefix = scratch;
+  float* suffix = scratch + padded_length * channels;
+  float* end = data + padded_length * channels;
+  float identity = dilate_ ? Maximum::identity() : Minimum::identity();
+  std::fill(data, data + radius * channels, identity);
+  std::fill(data + (radius + length) * channels, end, identity);
+  if (grayscale_ && dilate_) {
+    VanHerkGilWermanKeyed<Maximum>(data, prefix, suffix, length,
+                                   padded_length, 2 * radius + 1, channels);
+  } else if (grayscale_) {
+    VanHerkGilWermanKeyed<Minimum>(data, prefix, suffix, length,
+                                   padded_length, 2 * radius + 1, channels);
+  } else if (dilate_) {
+    VanHerkGilWerman<Maximum>(data, prefix, suffix, length, padded_length,
+                              2 * radius + 1, channels);
+  } else {
+    VanHerkGilWerman<Minimum>(data, prefix, suffix, length, padded_length,
+                              2 * radius + 1, channels);
+  }
+}
+
+void MorphologyPass::ReadPixel(const ColorData& color, float* sample) const {
+  float* rgb = sample;
+  if (grayscale_) {
+    sample[0] = color.luminance();
+    rgb++;
+  }
+  rgb[0] = color.red();
+  rgb[1] = color.green();
+  rgb[2] = color.blue();
+}
+
+void MorphologyPass::WritePixel(const float* sample, ColorData* color) const {
+  const float* rgb = grayscale_ ? sample + 1 : sample;
+  *color = ColorData(rgb[0], rgb[1], rgb[2], color->alpha());
+}
+
+void MorphologyPass::FilterRows(PixelBuffer* image, int y_begin,
+                            int y_end) const {
+  if (radius_x_ < 1) {
+    return;
+  }
+  const int width = image->width();
+  const int channels = grayscale_ ? kKeyedChannels : kChannels;
+  const int padded_length = padded(width, radius_x_);
+  std::vector<float> line(padded_length * channels);
+  std::vector<float> scratch(2 * padded_length * channels);
+
+  for (int y = y_begin; y < y_end; y++) {
+    ColorData* row = image->row(y);
+    float* sample = &line[radius_x_ * channels];
+    for (int x = 0; x < width; x++, sample += channels) {
+      ReadPixel(row[x], sample);
+    }
+
+    FilterLine(line.data(), scratch.data(), width, radius_x_, channels);
+
+    sample = line.data();
+    for (int x = 0; x < width; x++, sample += channels) {
+      WritePixel(sample, &row[x]);
+    }
+  }
+}
+
+void MorphologyPass::FilterColumns(PixelBuffer* image, int x_begin,
+                               int x_end) const {
+  if (radius_y_ < 1) {
+    return;
+  }
+  const int height = image->height();
+  const int padded_length = padded(height, radius_y_);
+  const int pixel_channels = grayscale_ ? kKeyedChannels : kChannels;
+  std::vector<float> strip(padded_length * pixel_channels * kStripColumns);
+  std::vector<float> scratch(2 * strip.size());
+
+  for (int x = x_begin; x < x_end; x += kStripColumns) {
+    int columns = std::min(kStripColumns, x_end - x);
+    int channels = columns * pixel_channels;
+    for (int y = 0; y < height; y++) {
+      const ColorData* from = image->row(y) + x;
+      float* sample = &strip[(y + radius_y_) * channels];
+      for (int i = 0; i < columns; i++, sample += pixel_channels) {
+        ReadPixel(from[i], sample);
+      }
+    }
+
+    FilterLine(strip.data(), scratch.data(), height, radius_y_, channels);
+
+    for (int y = 0; y < height; y++) {
+      ColorData* to = image->row(y) + x;
+      const float* sample = &strip[y * channels];
+      for (int i = 0; i < columns; i++, sample += pixel_channels) {
+        WritePixel(sample, &to[i]);
+      }
+    }
+  }
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * Name            : perf_hud.cc
+ * Project         : FlashPhoto
+ * Module          : perf_hud
+ * Description     : Implementation of the PerfHud class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/perf_hud.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "include/memory_accounting.h"
+#include "include/pixel_pool.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** Weight of the newest frame in the smoothed frame time */
+const double kFrameSmoothing = 0.2;
+const int kHudLineHeight = 15;
+const int kHudMargin = 6;
+const int kHudWidth = 330;
+
+/** How often the workers' utilization is sampled */
+const double kWorkerSampleMs = 1000.0;
+
+/** Workers whose utilization is listed; the rest are summed up */
+const int kHudMaxWorkers = 8;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static std::string FormatBytes(double bytes) {
+  char text[32];
+  if (bytes >= 1024. * 1024 * 1024) {
+    snprintf(text, sizeof(text), "%.2f GB", bytes / (1024. * 1024 * 1024));
+  } else {
+    snprintf(text, sizeof(text), "%.1f MB", bytes / (1024. * 1024));
+  }
+  return text;
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+PerfHud::PerfHud(void) : visible_(false), frame_start_(), input_time_(),
+                         input_pending_(false), frames_(0), frame_ms_(0.0),
+                         frame_max_ms_(0.0), latency_ms_(0.0),
+                         latency_max_ms_(0.0), filter_name_(),
+                         filter_ms_(0.0), filter_megapixels_(0.0),
+                         view_zoom_(1.0), view_level_(0),
+                         view_drawn_bytes_(0), workers_sampled_(),
+                         worker_busy_ms_(), worker_utilization_(),
+                         tasks_run_(0), tasks_stolen_(0) {}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+double PerfHud::MillisecondsBetween(Clock::time_point start,
+                                    Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void PerfHud::MarkInput(void) {
+  if (!input_pending_) {
+    input_time_ = Clock::now();
+    input_pending_ = true;
+  }
+}
+
+void PerfHud::BeginFrame(void) {
+  frame_start_ = Clock::now();
+}
+
+void PerfHud::EndFrame(void) {
+  Clock::time_point now = Clock::now();
+  double frame_ms = MillisecondsBetween(frame_start_, now);
+  frame_ms_ = (frames_++ == 0) ? frame_ms :
+              (1 - kFrameSmoothing) * frame_ms_ + kFrameSmoothing * frame_ms;
+  frame_max_ms_ = std::max(frame_max_ms_, frame_ms);
+
+  if (input_pending_) {
+    latency_ms_ = MillisecondsBetween(input_time_, now);
+    latency_max_ms_ = std::max(latency_max_ms_, latency_ms_);
+    input_pending_ = false;
+  }
+}
+
+void PerfHud::RecordFilter(const std::string& name, double milliseconds,
+                           double megapixels) {
+  filter_name_ = name;
+  filter_ms_ = milliseconds;
+  filter_megapixels_ = megapixels;
+}
+
+void PerfHud::RecordView(double zoom, int level, size_t drawn_bytes) {
+  view_zoom_ = zoom;
+  view_level_ = level;
+  view_drawn_bytes_ = drawn_bytes;
+}
+
+void PerfHud::RecordWorkers(const TaskScheduler& scheduler) {
+  Clock::time_point now = Clock::now();
+  double elapsed_ms = MillisecondsBetween(workers_sampled_, now);
+  int workers = scheduler.worker_count();
+  if (static_cast<int>(worker_busy_ms_.size()) == workers &&
+      elapsed_ms < kWorkerSampleMs) {
+    return;
+  }
+
+  bool first_sample = (static_cast<int>(worker_busy_ms_.size()) != workers);
+  worker_busy_ms_.resize(workers, 0.0);
+  worker_utilization_.resize(workers, 0.0);
+  tasks_run_ = 0;
+  tasks_stolen_ = 0;
+  for (int worker = 0; worker < workers; worker++) {
+    WorkerStats stats = scheduler.worker_stats(worker);
+    worker_utilization_[worker] = first_sample ? stats.utilization :
+      std::min(1.0, (stats.busy_ms - worker_busy_ms_[worker]) / elapsed_ms);
+    worker_busy_ms_[worker] = stats.busy_ms;
+    tasks_run_ += stats.tasks_run;
+    tasks_stolen_ += stats.tasks_stolen;
+  }
+  workers_sampled_ = now;
+}
+
+void PerfHud::Draw(int window_height, size_t display_bytes,
+                   size_t undo_depth, size_t redo_depth,
+                   size_t evicted_states) const {
+  std::vector<std::string> lines;
+  char line[128];
+  snprintf(line, sizeof(line), "Frame: %.1f ms (max %.1f ms)", frame_ms_,
+           frame_max_ms_);
+  lines.push_back(line);
+  snprintf(line, sizeof(line), "Stroke latency: %.1f ms (max %.1f ms)",
+           latency_ms_, latency_max_ms_);
+  lines.push_back(line);
+  if (filter_name_.empty()) {
+    lines.push_back("Last filter: none");
+  } else {
+    snprintf(line, sizeof(line), "Last filter: %s %.0f ms, %.2f MP/s",
+             filter_name_.c_str(), filter_ms_,
+             (filter_ms_ > 0.0) ? filter_megapixels_ * 1000. / filter_ms_ :
+             0.0);
+    lines.push_back(line);
+  }
+  lines.push_back("Canvas: " + FormatBytes(display_bytes));
+  snprintf(line, sizeof(line), "View: %.0f%% from level %d, drawing %s",
+           view_zoom_ * 100., view_level_,
+           FormatBytes(view_drawn_bytes_).c_str());
+  lines.push_back(line);
+  snprintf(line, sizeof(line), "Undo: %zu + redo %zu states, %zu evicted",
+           undo_depth, redo_depth, evicted_states);
+  lines.push_back(line);
+  for (int s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+    MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+    MemoryUsage usage = MemoryAccounting::usage(subsystem);
+    int64_t budget = MemoryAccounting::budget(subsystem);
+    lines.push_back(std::string("Memory, ") +
+                    MemoryAccounting::SubsystemName(subsystem) + ": " +
+                    FormatBytes(usage.live_bytes) +
+                    (budget > 0 ? " of " + FormatBytes(budget) + " cap" :
+                     std::string()) +
+                    " (peak " + FormatBytes(usage.peak_bytes) + ")");
+  }
+  std::string busy;
+  int workers = static_cast<int>(worker_utilization_.size());
+  for (int worker = 0; worker < std::min(workers, kHudMaxWorkers); worker++) {
+    snprintf(line, sizeof(line), " %.0f%%",
+             worker_utilization_[worker] * 100.);
+    busy += line;
+  }
+  if (workers > kHudMaxWorkers) {
+    snprintf(line, sizeof(line), " +%d", workers - kHudMaxWorkers);
+    busy += line;
+  }
+  lines.push_back("Workers busy:" + busy);
+  snprintf(line, sizeof(line), "Tasks: %lld run, %lld stolen",
+           static_cast<long long>(tasks_run_),
+           static_cast<long long>(tasks_stolen_));
+  lines.push_back(line);
+  PixelPoolStats pool = PixelPool::stats();
+  snprintf(line, sizeof(line), "Pixel pool: %s reserved, %s idle, %lld slabs",
+           FormatBytes(pool.reserved_bytes).c_str(),
+           FormatBytes(pool.idle_bytes).c_str(),
+           static_cast<long long>(pool.slab_allocations));
+  lines.push_back(line);
+
+  int box_height = kHudLineHeight * static_cast<int>(lines.size()) +
+                   2 * kHudMargin;
+  int top = window_height;
+
+  glColor4f(0.0f, 0.0f, 0.0f, 0.65f);
+  glRecti(0, top - box_height, kHudWidth, top);
+
+  glColor4f(1.0f, 1.0f, 0.6f, 1.0f);
+  for (size_t i = 0; i < lines.size(); i++) {
+    glRasterPos2i(kHudMargin, top - kHudMargin -
+                  kHudLineHeight * static_cast<int>(i + 1) + 3);
+    for (char c : lines[i]) {
+      glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+    }
+  }
+}
+
+}  /* namespace image_tools */
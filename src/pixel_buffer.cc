@@ -15,7 +15,10 @@
 #include "./include/pixel_buffer.h"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include "./include/color_data.h"
+#include "./include/pixel_pool.h"
+#include "./include/trace.h"
 
 
 /*******************************************************************************
@@ -33,13 +36,21 @@ namespace image_tools {
                            ColorData background_color)
       : width_(w),
         height_(h),
-        pixels_(new ColorData[w*h]),
+        pixels_(PixelPool::Borrow(w*h, MEMORY_PIXEL_BUFFER)),
         background_color_(new ColorData(background_color)) {
     FillPixelBufferWithColor(background_color);
   }
 
+  PixelBuffer::PixelBuffer(const PixelBuffer* source)
+      : width_(source->width_),
+        height_(source->height_),
+        pixels_(PixelPool::Borrow(width_*height_, MEMORY_PIXEL_BUFFER)),
+        background_color_(new ColorData(*source->background_color_)) {
+    std::copy(source->pixels_, source->pixels_ + width_*height_, pixels_);
+  }
+
   PixelBuffer::~PixelBuffer(void) {
-    delete [] pixels_;
+    PixelPool::Return(pixels_);
     delete background_color_;
   }
 
@@ -93,24 +104,22 @@ namespace image_tools {
   }
 
   ColorData* PixelBuffer::GetAllPixels(void) {
-    ColorData* pixels_copy = new ColorData[width_*height_];
-    for (int i = 0; i < width_*height_; i++) {
-      pixels_copy[i] = pixels_[i];
-    }
+    TRACE_SCOPE("PixelBuffer::GetAllPixels", "pixels");
+    ColorData* pixels_copy = PixelPool::Borrow(width_*height_,
+                                               MEMORY_PIXEL_BUFFER);
+    std::copy(pixels_, pixels_ + width_*height_, pixels_copy);
     return pixels_copy;
   }
 
-  void PixelBuffer::SetAllPixels(ColorData* pixels_copy) {
-    for (int i = 0; i < width_*height_; i++) {
-      pixels_[i] = pixels_copy[i];
-    }
+  void PixelBuffer::SetAllPixels(const ColorData* pixels_copy) {
+    TRACE_SCOPE("PixelBuffer::SetAllPixels", "pixels");
+    std::copy(pixels_copy, pixels_copy + width_*height_, pixels_);
   }
 
   PixelBuffer* PixelBuffer::Copy(void) {
-    PixelBuffer* pixel_buffer_copy = new PixelBuffer(
-            width_, height_, *background_color_);
-    pixel_buffer_copy->SetAllPixels(GetAllPixels());
-    return pixel_buffer_copy;
+    TRACE_SCOPE("PixelBuffer::Copy", "pixels");
+    // The copy is written straight over pooled, uninitialized pixels
+    return new PixelBuffer(this);
   }
 
 }  /* namespace image_tools */
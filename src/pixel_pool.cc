@@ -0,0 +1,341 @@
+/*******************************************************************************
+ * Name            : pixel_pool.cc
+ * Project         : FlashPhoto
+ * Module          : pixel_pool
+ * Description     : Implementation of the PixelPool class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/pixel_pool.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "include/task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/* Pixel arrays are cache line aligned; the header fills the line before */
+static const size_t kPixelAlignment = 64;
+static const uint32_t kPixelHeaderMagic = 0x50495842;  // "PIXB"
+
+/* Size classes step by 1/8 of a power of two, from this many pixels up */
+static const size_t kMinClassPixels = 64;
+static const int kClassStepsLog2 = 3;
+
+/* Small buffers are carved several to a slab; big ones get a slab each */
+static const size_t kSlabBytes = 16 << 20;
+static const size_t kMaxBuffersPerSlab = 8;
+
+/*
+ * Idle memory kept for reuse, per size class and in all; a slab left with
+ * nothing borrowed past either is released as soon as it is returned
+ */
+static const int64_t kMaxIdleClassBytes = int64_t(256) << 20;
+static const int64_t kMaxIdleBytes = int64_t(1) << 30;
+
+/* Transparent huge pages on x86-64 and most other 64 bit Linux targets */
+static const size_t kHugePageBytes = 2 << 20;
+static const size_t kPageBytes = 4096;
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+struct PixelSlab {
+  void* block;
+  size_t bytes;
+  bool huge_pages;
+  size_t class_pixels;
+  size_t buffer_stride;
+  size_t buffer_count;
+  size_t borrowed;
+};
+
+struct PixelHeader {
+  PixelSlab* slab;
+  size_t count;
+  int subsystem;
+  uint32_t magic;
+};
+
+static_assert(sizeof(PixelHeader) <= kPixelAlignment,
+              "The pixel header must fit before the pixels");
+
+struct PixelPoolState {
+  PixelPoolState(void) : mutex(), free_lists(), slabs(), stats(),
+                         policy(PIXEL_ALLOC_HUGE_PAGES) {}
+  std::mutex mutex;
+  /* Idle buffers by size class (in pixels) */
+  std::map<size_t, std::vector<ColorData*>> free_lists;
+  std::vector<PixelSlab*> slabs;
+  PixelPoolStats stats;
+  PixelAllocationPolicy policy;
+};
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static PixelPoolState& Pool(void) {
+  // Never destroyed, so buffers may be returned during static destruction
+  static PixelPoolState* pool = new PixelPoolState();
+  return *pool;
+}
+
+static PixelHeader* HeaderOf(const ColorData* pixels) {
+  PixelHeader* header = reinterpret_cast<PixelHeader*>(
+    const_cast<char*>(reinterpret_cast<const char*>(pixels)) -
+    kPixelAlignment);
+  assert(header->magic == kPixelHeaderMagic);
+  return header;
+}
+
+static ColorData* PixelsOf(char* buffer) {
+  return reinterpret_cast<ColorData*>(buffer + kPixelAlignment);
+}
+
+static size_t ClassPixels(size_t count) {
+  if (count <= kMinClassPixels) {
+    return kMinClassPixels;
+  }
+  int log2 = 0;
+  while ((count - 1) >> (log2 + 1)) {
+    log2++;
+  }
+  int shift = log2 - kClassStepsLog2;
+  return (((count - 1) >> shift) + 1) << shift;
+}
+
+/*
+ * Fault in every page of a new block, one contiguous band per thread of the
+ * scheduler, each band on the thread it belongs to whenever that is free.
+ */
+static void FirstTouch(void* block, size_t bytes) {
+  char* bytes_begin = static_cast<char*>(block);
+  int pages = static_cast<int>(bytes / kPageBytes);
+  TaskScheduler::Instance().ParallelForBands(0, pages,
+                                             [&](int page_begin,
+                                                 int page_end) {
+    for (int page = page_begin; page < page_end; page++) {
+      bytes_begin[static_cast<size_t>(page) * kPageBytes] = 0;
+    }
+  });
+}
+
+/*
+ * Allocate and first touch a slab for a size class. Nothing is shared, so
+ * this runs without the pool's lock.
+ */
+static PixelSlab* NewSlab(size_t class_pixels,
+                          PixelAllocationPolicy policy) {
+  size_t stride = kPixelAlignment + class_pixels * sizeof(ColorData);
+  stride = (stride + kPixelAlignment - 1) / kPixelAlignment * kPixelAlignment;
+  size_t buffer_count = std::max<size_t>(
+    1, std::min(kMaxBuffersPerSlab, kSlabBytes / stride));
+
+  size_t bytes = stride * buffer_count;
+  bool huge_pages = (policy == PIXEL_ALLOC_HUGE_PAGES &&
+                     bytes >= kHugePageBytes);
+  size_t alignment = kPixelAlignment;
+  if (huge_pages) {
+    alignment = kHugePageBytes;
+    bytes = (bytes + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+  }
+
+  void* block = nullptr;
+  if (posix_memalign(&block, alignment, bytes) != 0) {
+    throw std::bad_alloc();
+  }
+  if (huge_pages) {
+#ifdef MADV_HUGEPAGE
+    // Only advice: without THP support the block simply keeps 4K pages
+    madvise(block, bytes, MADV_HUGEPAGE);
+#endif
+    FirstTouch(block, bytes);
+  }
+
+  PixelSlab* slab = new PixelSlab();
+  slab->block = block;
+  slab->bytes = bytes;
+  slab->huge_pages = huge_pages;
+  slab->class_pixels = class_pixels;
+  slab->buffer_stride = stride;
+  slab->buffer_count = buffer_count;
+  slab->borrowed = 0;
+
+  char* buffer = static_cast<char*>(block);
+  for (size_t i = 0; i < buffer_count; i++, buffer += stride) {
+    PixelHeader* header = reinterpret_cast<PixelHeader*>(buffer);
+    header->slab = slab;
+    header->count = 0;
+    header->subsystem = MEMORY_PIXEL_BUFFER;
+    header->magic = kPixelHeaderMagic;
+  }
+  return slab;
+}
+
+/* Put a new slab's buffers on its free list; the pool's lock is held */
+static void PublishSlab(PixelPoolState* pool, PixelSlab* slab) {
+  pool->slabs.push_back(slab);
+
+  std::vector<ColorData*>& free_list = pool->free_lists[slab->class_pixels];
+  char* buffer = static_cast<char*>(slab->block) +
+                 slab->buffer_stride * slab->buffer_count;
+  for (size_t i = 0; i < slab->buffer_count; i++) {
+    // Hand out the lowest addresses first
+    buffer -= slab->buffer_stride;
+    free_list.push_back(PixelsOf(buffer));
+  }
+
+  pool->stats.reserved_bytes += slab->bytes;
+  pool->stats.idle_bytes += slab->bytes;
+  pool->stats.slab_allocations++;
+  if (slab->huge_pages) {
+    pool->stats.huge_page_bytes += slab->bytes;
+  }
+}
+
+/*
+ * Take an idle slab's buffers off its free list and give its memory back to
+ * the system; the pool's lock is held and the caller drops it from slabs
+ */
+static void ReleaseSlab(PixelPoolState* pool, PixelSlab* slab) {
+  std::vector<ColorData*>& free_list = pool->free_lists[slab->class_pixels];
+  free_list.erase(
+    std::remove_if(free_list.begin(), free_list.end(),
+                   [slab](ColorData* pixels) {
+                     return HeaderOf(pixels)->slab == slab;
+                   }),
+    free_list.end());
+  pool->stats.reserved_bytes -= slab->bytes;
+  pool->stats.idle_bytes -= slab->bytes;
+  if (slab->huge_pages) {
+    pool->stats.huge_page_bytes -= slab->bytes;
+  }
+  free(slab->block);
+  delete slab;
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+ColorData* PixelPool::Borrow(size_t count, MemorySubsystem subsystem) {
+  size_t class_pixels = ClassPixels(count);
+  ColorData* pixels;
+  {
+    PixelPoolState& pool = Pool();
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    std::vector<ColorData*>& free_list = pool.free_lists[class_pixels];
+    if (free_list.empty()) {
+      // Touching a big slab's pages takes a while; let others borrow and
+      // return meanwhile
+      PixelAllocationPolicy policy = pool.policy;
+      lock.unlock();
+      PixelSlab* slab = NewSlab(class_pixels, policy);
+      lock.lock();
+      PublishSlab(&pool, slab);
+    }
+    pixels = free_list.back();
+    free_list.pop_back();
+
+    PixelHeader* header = HeaderOf(pixels);
+    header->count = count;
+    header->subsystem = subsystem;
+    header->slab->borrowed++;
+    pool.stats.idle_bytes -= header->slab->buffer_stride;
+    pool.stats.borrows++;
+  }
+  MemoryAccounting::RecordAllocation(subsystem, count * sizeof(ColorData));
+  return pixels;
+}
+
+void PixelPool::Return(ColorData* pixels) {
+  if (!pixels) {
+    return;
+  }
+  PixelHeader* header = HeaderOf(pixels);
+  MemoryAccounting::RecordFree(static_cast<MemorySubsystem>(header->subsystem),
+                               header->count * sizeof(ColorData));
+
+  PixelPoolState& pool = Pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  PixelSlab* slab = header->slab;
+  slab->borrowed--;
+  pool.stats.idle_bytes += slab->buffer_stride;
+  std::vector<ColorData*>& free_list = pool.free_lists[slab->class_pixels];
+  free_list.push_back(pixels);
+
+  int64_t class_idle_bytes = static_cast<int64_t>(free_list.size() *
+                                                  slab->buffer_stride);
+  if (slab->borrowed == 0 && (class_idle_bytes > kMaxIdleClassBytes ||
+                              pool.stats.idle_bytes > kMaxIdleBytes)) {
+    pool.slabs.erase(std::find(pool.slabs.begin(), pool.slabs.end(), slab));
+    ReleaseSlab(&pool, slab);
+  }
+}
+
+void PixelPool::Reassign(ColorData* pixels, MemorySubsystem subsystem) {
+  PixelHeader* header = HeaderOf(pixels);
+  size_t bytes = header->count * sizeof(ColorData);
+  MemoryAccounting::RecordFree(static_cast<MemorySubsystem>(header->subsystem),
+                               bytes);
+  MemoryAccounting::RecordAllocation(subsystem, bytes);
+  header->subsystem = subsystem;
+}
+
+size_t PixelPool::PixelCount(const ColorData* pixels) {
+  return HeaderOf(pixels)->count;
+}
+
+void PixelPool::Trim(void) {
+  PixelPoolState& pool = Pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  std::vector<PixelSlab*> kept;
+  for (PixelSlab* slab : pool.slabs) {
+    if (slab->borrowed != 0) {
+      kept.push_back(slab);
+    } else {
+      ReleaseSlab(&pool, slab);
+    }
+  }
+  pool.slabs.swap(kept);
+}
+
+PixelPoolStats PixelPool::stats(void) {
+  PixelPoolState& pool = Pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.stats;
+}
+
+void PixelPool::set_policy(PixelAllocationPolicy policy) {
+  PixelPoolState& pool = Pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  pool.policy = policy;
+}
+
+PixelAllocationPolicy PixelPool::policy(void) {
+  PixelPoolState& pool = Pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.policy;
+}
+
+const char* PixelPool::PolicyName(PixelAllocationPolicy policy) {
+  return (policy == PIXEL_ALLOC_HUGE_PAGES) ? "huge_pages" : "standard";
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,421 @@
+/*******************************************************************************
+ * Name            : png_encoder.cc
+ * Project         : FlashPhoto
+ * Module          : io_manager
+ * Description     : Implementation of the PngEncoder class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/png_encoder.h"
+#include <zlib.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "include/trace.h"
+#include "include/color_data.h"
+#include "include/task_scheduler.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** RGBA, one byte per channel */
+const int kPngBytesPerPixel = 4;
+
+/** The deflate window; each strip is primed with this much of the last one */
+const int kDeflateWindowSize = 32768;
+
+/** Fewest rows worth handing to a thread as a strip */
+const int kMinRowsPerStrip = 16;
+
+/** IDAT data is split into chunks no larger than this */
+const size_t kMaxIdatChunkSize = 1 << 30;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static void AppendUint32(std::vector<unsigned char>* out, unsigned long value) {
+  out->push_back(static_cast<unsigned char>((value >> 24) & 0xFF));
+  out->push_back(static_cast<unsigned char>((value >> 16) & 0xFF));
+  out->push_back(static_cast<unsigned char>((value >> 8) & 0xFF));
+  out->push_back(static_cast<unsigned char>(value & 0xFF));
+}
+
+/**
+ * @brief The FLG byte of a zlib header (no preset dictionary) whose FLEVEL
+ * field describes the compression level, as zlib itself writes it.
+ */
+static unsigned char ZlibHeaderFlags(int level) {
+  if (level < 2) return 0x01;
+  if (level < 6) return 0x5E;
+  if (level == 6) return 0x9C;
+  return 0xDA;
+}
+
+static int ZlibStrategy(PngDeflateStrategy strategy) {
+  switch (strategy) {
+    case PNG_STRATEGY_FILTERED:
+      return Z_FILTERED;
+    case PNG_STRATEGY_HUFFMAN_ONLY:
+      return Z_HUFFMAN_ONLY;
+    case PNG_STRATEGY_RLE:
+      return Z_RLE;
+    case PNG_STRATEGY_DEFAULT:
+    default:
+      return Z_DEFAULT_STRATEGY;
+  }
+}
+
+static inline int PaethPredictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if (pa <= pb && pa <= pc) return a;
+  if (pb <= pc) return b;
+  return c;
+}
+
+/**
+ * @brief Apply PNG filter type 1-4 to a scanline, giving up once the sum of
+ * magnitudes of the filtered bytes reaches the given limit.
+ *
+ * @return The sum of magnitudes (only meaningful if below the limit)
+ */
+static unsigned long ApplyFilter(unsigned char type,
+                                 const unsigned char* row,
+                                 const unsigned char* prior_row,
+                                 int row_bytes,
+                                 unsigned long limit,
+                                 unsigned char* out) {
+  const int bpp = kPngBytesPerPixel;
+  unsigned long sum = 0;
+  for (int i = 0; i < row_bytes && sum < limit; i++) {
+    int left = (i >= bpp) ? row[i - bpp] : 0;
+    int up = prior_row ? prior_row[i] : 0;
+    int up_left = (prior_row && i >= bpp) ? prior_row[i - bpp] : 0;
+    int predicted = 0;
+    switch (type) {
+      case 1:
+        predicted = left;
+        break;
+      case 2:
+        predicted = up;
+        break;
+      case 3:
+        predicted = (left + up) >> 1;
+        break;
+      default:
+        predicted = PaethPredictor(left, up, up_left);
+        break;
+    }
+    unsigned char value = static_cast<unsigned char>(row[i] - predicted);
+    out[i] = value;
+    sum += (value < 128) ? value : 256 - value;
+  }
+  return sum;
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+bool PngEncoder::Encode(const PixelBuffer& pixel_buffer,
+                        const std::string& file_name,
+                        const PngEncodeSettings& settings,
+                        IOProgress* progress) {
+  TRACE_SCOPE("PngEncoder::Encode", "io");
+  const int width = pixel_buffer.width();
+  const int height = pixel_buffer.height();
+  const int row_bytes = width * kPngBytesPerPixel;
+
+  if (progress) {
+    // One step per row for conversion and filtering, one for compression.
+    progress->set_rows_total(2 * height);
+  }
+
+  /*
+   * Convert the whole canvas to 8-bit RGBA first; filtering a row needs the
+   * raw row above it, which may belong to another thread's strip.
+   */
+  std::vector<unsigned char> raw(static_cast<size_t>(row_bytes) * height);
+  std::atomic<bool> cancelled(false);
+  TaskScheduler& scheduler = TaskScheduler::Instance();
+
+  scheduler.ParallelFor(0, height, 0, [&](int y_begin, int y_end) {
+    for (int y = y_begin; y < y_end; y++) {
+      if (cancelled || (progress && progress->cancel_requested())) {
+        cancelled = true;
+        return;
+      }
+      // PixelBuffer rows are stored bottom-up.
+      const ColorData* src = pixel_buffer.data() + width * (height - (y + 1));
+      unsigned char* dst = &raw[static_cast<size_t>(row_bytes) * y];
+      for (int x = 0; x < width; x++) {
+        ColorData color_data = src[x].clamped_color();
+        dst[x * 4] = static_cast<unsigned char>(color_data.red() * 255.);
+        dst[x * 4 + 1] = static_cast<unsigned char>(color_data.green() * 255.);
+        dst[x * 4 + 2] = static_cast<unsigned char>(color_data.blue() * 255.);
+        dst[x * 4 + 3] = static_cast<unsigned char>(color_data.alpha() * 255.);
+      }
+    }
+  });
+
+  int thread_count = scheduler.concurrency();
+  int rows_per_strip = std::max(kMinRowsPerStrip,
+                                (height + thread_count - 1) / thread_count);
+  int strip_count = std::max(1, (height + rows_per_strip - 1) /
+                             rows_per_strip);
+  std::vector<Strip> strips(strip_count);
+  for (int s = 0; s < strip_count; s++) {
+    strips[s].first_row = s * rows_per_strip;
+    strips[s].row_count = std::min(rows_per_strip,
+                                   height - strips[s].first_row);
+  }
+
+  // Filter every strip, then compress every strip primed with the data of
+  // the strip before it.
+  scheduler.ParallelFor(0, strip_count, 1, [&](int s_begin, int s_end) {
+    for (int s = s_begin; s < s_end; s++) {
+      Strip& strip = strips[s];
+      strip.filtered.resize(static_cast<size_t>(row_bytes + 1) *
+                            strip.row_count);
+      std::vector<unsigned char> scratch(row_bytes);
+      for (int r = 0; r < strip.row_count; r++) {
+        if (cancelled || (progress && progress->cancel_requested())) {
+          cancelled = true;
+          break;
+        }
+        int y = strip.first_row + r;
+        const unsigned char* row = &raw[static_cast<size_t>(row_bytes) * y];
+        const unsigned char* prior_row = (y > 0) ? row - row_bytes : nullptr;
+        FilterRow(row, prior_row, row_bytes, settings.filter, scratch.data(),
+                  &strip.filtered[static_cast<size_t>(row_bytes + 1) * r]);
+        if (progress) {
+          progress->AdvanceRow();
+        }
+      }
+      strip.adler = adler32(adler32(0L, Z_NULL, 0), strip.filtered.data(),
+                            strip.filtered.size());
+    }
+  });
+
+  // Only the filtered strips are needed from here on.
+  std::vector<unsigned char>().swap(raw);
+
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  if (!fp) {
+    std::cout << "ERROR: Could not open file to write PNG." << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned char> header;
+  AppendUint32(&header, width);
+  AppendUint32(&header, height);
+  header.push_back(8);  // bit depth
+  header.push_back(6);  // color type: RGBA
+  header.push_back(0);  // compression: deflate
+  header.push_back(0);  // filter method: adaptive
+  header.push_back(0);  // interlace: none
+  const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+  bool written = (fwrite(signature, 1, 8, fp) == 8) &&
+                 WriteChunk(fp, "IHDR", header.data(), header.size());
+
+  /*
+   * Strips finish compressing in any order; whichever thread completes the
+   * next strip due in the file writes it, and any finished ones after it, as
+   * IDAT chunks and frees them. A strip's filtered data is kept until the
+   * strip after it, which was primed with it, has been written.
+   */
+  std::atomic<bool> deflate_ok(true);
+  std::mutex write_mutex;
+  int next_strip = 0;
+  unsigned long adler = 1;
+  scheduler.ParallelFor(0, strip_count, 1, [&](int s_begin, int s_end) {
+    for (int s = s_begin; s < s_end; s++) {
+      if (cancelled || (progress && progress->cancel_requested())) {
+        cancelled = true;
+        return;
+      }
+      if (!DeflateStrip(&strips[s], (s > 0) ? &strips[s - 1] : nullptr,
+                        s == strip_count - 1, settings)) {
+        deflate_ok = false;
+        return;
+      }
+      if (progress) {
+        for (int r = 0; r < strips[s].row_count; r++) {
+          progress->AdvanceRow();
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(write_mutex);
+      strips[s].deflate_done = true;
+      while (next_strip < strip_count && strips[next_strip].deflate_done) {
+        Strip& strip = strips[next_strip];
+        adler = (next_strip == 0) ? strip.adler :
+                adler32_combine(adler, strip.adler,
+                                static_cast<size_t>(row_bytes + 1) *
+                                strip.row_count);
+        if (next_strip == strip_count - 1) {
+          AppendUint32(&strip.deflated, adler);
+        }
+        for (size_t offset = 0; written && offset < strip.deflated.size();
+             offset += kMaxIdatChunkSize) {
+          written = WriteChunk(fp, "IDAT", &strip.deflated[offset],
+                               std::min(kMaxIdatChunkSize,
+                                        strip.deflated.size() - offset));
+        }
+        std::vector<unsigned char>().swap(strip.deflated);
+        if (next_strip > 0) {
+          std::vector<unsigned char>().swap(strips[next_strip - 1].filtered);
+        }
+        next_strip++;
+      }
+    }
+  });
+
+  written = written && WriteChunk(fp, "IEND", nullptr, 0);
+  written = (fclose(fp) == 0) && written;
+
+  if (cancelled || !deflate_ok || !written) {
+    if (!cancelled) {
+      std::cout << (deflate_ok ? "ERROR: Could not write PNG." :
+                    "ERROR: Could not compress PNG image data.") << std::endl;
+    }
+    std::remove(file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+void PngEncoder::FilterRow(const unsigned char* row,
+                           const unsigned char* prior_row,
+                           int row_bytes,
+                           PngFilterHeuristic heuristic,
+                           unsigned char* scratch,
+                           unsigned char* out) {
+  if (heuristic != PNG_FILTER_HEURISTIC_ADAPTIVE) {
+    unsigned char type = static_cast<unsigned char>(
+      heuristic - PNG_FILTER_HEURISTIC_NONE);
+    out[0] = type;
+    if (type == 0) {
+      std::copy(row, row + row_bytes, out + 1);
+    } else {
+      ApplyFilter(type, row, prior_row, row_bytes, ~0UL, out + 1);
+    }
+    return;
+  }
+
+  /*
+   * Start from filter type None, then try Sub, Up, Average and Paeth into the
+   * scratch row, keeping whichever has the smallest sum of magnitudes when
+   * its bytes are taken as signed values.
+   */
+  unsigned char best_type = 0;
+  unsigned long best_sum = 0;
+  for (int i = 0; i < row_bytes; i++) {
+    out[i + 1] = row[i];
+    best_sum += (row[i] < 128) ? row[i] : 256 - row[i];
+  }
+
+  for (unsigned char type = 1; type <= 4; type++) {
+    if (!prior_row && (type == 2)) {
+      continue;  // Up is the same as None on the first row
+    }
+    unsigned long sum = ApplyFilter(type, row, prior_row, row_bytes, best_sum,
+                                    scratch);
+    if (sum < best_sum) {
+      best_sum = sum;
+      best_type = type;
+      std::copy(scratch, scratch + row_bytes, out + 1);
+    }
+  }
+
+  out[0] = best_type;
+}
+
+bool PngEncoder::DeflateStrip(Strip* strip, const Strip* previous_strip,
+                              bool last_strip,
+                              const PngEncodeSettings& settings) {
+  TRACE_SCOPE("PngEncoder::DeflateStrip", "io");
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+
+  // Negative window bits: raw deflate, the zlib wrapper is written once.
+  if (deflateInit2(&stream, settings.compression_level, Z_DEFLATED, -15, 8,
+                   ZlibStrategy(settings.strategy)) != Z_OK) {
+    return false;
+  }
+
+  if (previous_strip && !previous_strip->filtered.empty() &&
+      settings.compression_level > 0) {
+    size_t dictionary_size = std::min(
+      static_cast<size_t>(kDeflateWindowSize),
+      previous_strip->filtered.size());
+    deflateSetDictionary(
+      &stream,
+      &previous_strip->filtered[previous_strip->filtered.size() -
+                                dictionary_size],
+      dictionary_size);
+  }
+
+  // The first strip carries the zlib header; the slack leaves room for the
+  // Adler-32 trailer the last strip gets once it is known.
+  const size_t header_size = previous_strip ? 0 : 2;
+  strip->deflated.resize(header_size +
+                         deflateBound(&stream, strip->filtered.size()) + 16);
+  if (!previous_strip) {
+    strip->deflated[0] = 0x78;  // deflate, 32K window
+    strip->deflated[1] = ZlibHeaderFlags(settings.compression_level);
+  }
+  stream.next_in = strip->filtered.data();
+  stream.avail_in = strip->filtered.size();
+  stream.next_out = strip->deflated.data() + header_size;
+  stream.avail_out = strip->deflated.size() - header_size;
+
+  // Every strip but the last ends with an empty stored block so the next
+  // strip's data starts on a byte boundary.
+  int result = deflate(&stream, last_strip ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = last_strip ? (result == Z_STREAM_END) :
+            (result == Z_OK && stream.avail_in == 0);
+  strip->deflated.resize(header_size + stream.total_out);
+  deflateEnd(&stream);
+  return ok;
+}
+
+bool PngEncoder::WriteChunk(FILE* fp,
+                            const char* type,
+                            const unsigned char* data,
+                            size_t length) {
+  std::vector<unsigned char> prefix;
+  AppendUint32(&prefix, length);
+  prefix.insert(prefix.end(), type, type + 4);
+  unsigned long crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, &prefix[4], 4);
+  if (length > 0) {
+    crc = crc32(crc, data, length);
+  }
+  std::vector<unsigned char> suffix;
+  AppendUint32(&suffix, crc);
+  return fwrite(prefix.data(), 1, prefix.size(), fp) == prefix.size() &&
+         (length == 0 || fwrite(data, 1, length, fp) == length) &&
+         fwrite(suffix.data(), 1, suffix.size(), fp) == suffix.size();
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * Name            : progressive_filter.cc
+ * Project         : FlashPhoto
+ * Module          : progressive_filter
+ * Description     : Implementation of the ProgressiveFilter class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/progressive_filter.h"
+#include <algorithm>
+#include "include/image_pyramid.h"
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int ProgressiveFilter::kTileSize;
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+ProgressiveFilter::ProgressiveFilter(void) : image_(nullptr), passes_(),
+                                             tiles_(), task_(),
+                                             started_(false),
+                                             tiles_done_(0), cancel_(false),
+                                             elapsed_ms_(0.0) {}
+
+ProgressiveFilter::~ProgressiveFilter(void) {
+  Cancel();
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void ProgressiveFilter::Start(const PixelBuffer* image,
+                              const FilterOperation& operation, int center_x,
+                              int center_y) {
+  TRACE_SCOPE("ProgressiveFilter::Start", "filter");
+  Cancel();
+  image_ = image;
+
+  for (int scale = kCoarsestScale; scale >= 1; scale /= 2) {
+    Pass pass = {scale, nullptr, nullptr, operation.Scaled(scale)};
+    passes_.push_back(pass);
+
+    // Each pass starts with the tiles nearest the point of interest.
+    int width = (image->width() + scale - 1) / scale;
+    int height = (image->height() + scale - 1) / scale;
+    size_t first = tiles_.size();
+    for (int y = 0; y < height; y += kTileSize) {
+      for (int x = 0; x < width; x += kTileSize) {
+        Tile tile = {static_cast<int>(passes_.size()) - 1, x, y,
+                     std::min(kTileSize, width - x),
+                     std::min(kTileSize, height - y)};
+        tiles_.push_back(tile);
+      }
+    }
+    double pass_x = static_cast<double>(center_x) / scale;
+    double pass_y = static_cast<double>(center_y) / scale;
+    auto distance = [pass_x, pass_y](const Tile& tile) {
+      double dx = tile.x + tile.width / 2.0 - pass_x;
+      double dy = tile.y + tile.height / 2.0 - pass_y;
+      return dx * dx + dy * dy;
+    };
+    std::stable_sort(tiles_.begin() + first, tiles_.end(),
+                     [&distance](const Tile& a, const Tile& b) {
+                       return distance(a) < distance(b);
+                     });
+  }
+
+  tiles_done_.store(0);
+  cancel_.store(false);
+  started_ = true;
+  task_.Run([this]() { Run(); }, TASK_PRIORITY_BACKGROUND);
+}
+
+void ProgressiveFilter::Run(void) {
+  TRACE_SCOPE("ProgressiveFilter::Run", "filter");
+  auto start = std::chrono::steady_clock::now();
+
+  // Passes are listed coarse to fine; each reduced image halves the next.
+  const PixelBuffer* source = image_;
+  for (int pass = static_cast<int>(passes_.size()) - 1; pass >= 0; pass--) {
+    if (passes_[pass].scale > 1) {
+      PixelBuffer* reduced = new PixelBuffer((source->width() + 1) / 2,
+                                             (source->height() + 1) / 2,
+                                             ColorData());
+      TaskScheduler::Instance().ParallelForTiles(
+        reduced->width(), reduced->height(), kTileSize,
+        [source, reduced](int x_begin, int y_begin, int x_end, int y_end) {
+          ImagePyramid::Halve(*source, reduced, x_begin, y_begin, x_end,
+                              y_end);
+        });
+      source = reduced;
+    }
+    passes_[pass].source = source;
+    passes_[pass].result = new PixelBuffer(source->width(), source->height(),
+                                           ColorData());
+    if (cancel_.load()) {
+      return;
+    }
+  }
+
+  for (const Tile& tile : tiles_) {
+    if (cancel_.load()) {
+      return;
+    }
+    FilterTile(tile);
+    // Publishes the tile's pixels to the thread drawing them
+    tiles_done_.fetch_add(1, std::memory_order_release);
+  }
+
+  elapsed_ms_ = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+void ProgressiveFilter::FilterTile(const Tile& tile) {
+  const Pass& pass = passes_[tile.pass];
+  const PixelBuffer& source = *pass.source;
+  int border = pass.operation.halo();
+  int region_x = std::max(0, tile.x - border);
+  int region_y = std::max(0, tile.y - border);
+  int region_width = std::min(source.width(), tile.x + tile.width + border) -
+                     region_x;
+  int region_height = std::min(source.height(),
+                               tile.y + tile.height + border) - region_y;
+
+  // Scratch regions come from the pixel pool, so this does not allocate
+  PixelBuffer region(region_width, region_height, ColorData());
+  for (int row = 0; row < region_height; row++) {
+    const ColorData* from = source.row(region_y + row) + region_x;
+    std::copy(from, from + region_width, region.row(row));
+  }
+  pass.operation.Apply(&region, region_x, region_y);
+  for (int row = 0; row < tile.height; row++) {
+    const ColorData* from = region.row(tile.y - region_y + row) +
+                            (tile.x - region_x);
+    std::copy(from, from + tile.width,
+              pass.result->row(tile.y + row) + tile.x);
+  }
+}
+
+PixelBuffer* ProgressiveFilter::TakeResult(void) {
+  task_.Wait();
+  PixelBuffer* result = passes_.back().result;
+  passes_.back().result = nullptr;
+  Cancel();
+  return result;
+}
+
+void ProgressiveFilter::Cancel(void) {
+  if (started_) {
+    cancel_.store(true);
+    task_.Wait();
+    started_ = false;
+  }
+  for (Pass& pass : passes_) {
+    if (pass.source != image_) {
+      delete pass.source;
+    }
+    delete pass.result;
+  }
+  passes_.clear();
+  tiles_.clear();
+  tiles_done_.store(0);
+  image_ = nullptr;
+}
+
+}  /* namespace image_tools */
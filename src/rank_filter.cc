@@ -0,0 +1,235 @@
+/*******************************************************************************
+ * Name            : rank_filter.cc
+ * Project         : FlashPhoto
+ * Module          : rank_filter
+ * Description     : Implementation of the RankFilter class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/rank_filter.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const int RankFilter::kMaxRadius;
+const int RankFilter::kMinTileSize;
+
+/** Four 16-bit counts */
+typedef uint64_t Lanes;
+const int kLanes = 4;
+const int kLaneBits = 16;
+
+/** 256 fine bins, in 16 coarse bins of 16 */
+const int kFineBins = 256;
+const int kCoarseBins = 16;
+const int kBinsPerCoarse = kFineBins / kCoarseBins;
+const int kFineWords = kFineBins / kLanes;
+const int kCoarseWords = kCoarseBins / kLanes;
+const int kWordsPerCoarse = kBinsPerCoarse / kLanes;
+
+/** Red, green and blue; alpha is kept */
+const int kChannels = 3;
+
+/** When a coarse bin's fine counts were last brought up to date: never */
+const int kStale = -(1 << 30);
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static inline int BinOf(float value) {
+  return std::min(kFineBins - 1, std::max(0, static_cast<int>(
+    value * (kFineBins - 1) + 0.5f)));
+}
+
+static inline int CountOf(const Lanes* words, int bin) {
+  return static_cast<int>((words[bin / kLanes] >>
+                           (kLaneBits * (bin % kLanes))) & 0xffff);
+}
+
+static inline Lanes OneAt(int bin) {
+  return static_cast<Lanes>(1) << (kLaneBits * (bin % kLanes));
+}
+
+static inline void AddWords(Lanes* to, const Lanes* from, int words) {
+  for (int i = 0; i < words; i++) {
+    to[i] += from[i];
+  }
+}
+
+static inline void SubtractWords(Lanes* to, const Lanes* from, int words) {
+  for (int i = 0; i < words; i++) {
+    to[i] -= from[i];
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+RankFilter::RankFilter(int radius, float percentile)
+    : radius_(std::min(kMaxRadius, std::max(0, radius))),
+      percentile_(std::min(1.f, std::max(0.f, percentile))) {}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int RankFilter::tile_size(void) const {
+  return std::max(kMinTileSize, 8 * radius_);
+}
+
+void RankFilter::FilterTile(const PixelBuffer& source, PixelBuffer* target,
+                            int x_begin, int y_begin, int x_end,
+                            int y_end) const {
+  const int width = source.width();
+  const int height = source.height();
+  const int radius = radius_;
+  const int columns_begin = std::max(0, x_begin - radius);
+  const int columns_end = std::min(width, x_end + radius);
+  const int columns = columns_end - columns_begin;
+
+  // Each column's histograms, channel by channel
+  std::vector<Lanes> column_fine(columns * kChannels * kFineWords);
+  std::vector<Lanes> column_coarse(columns * kChannels * kCoarseWords);
+  auto fine_of = [&](int x, int channel) {
+    return &column_fine[((x - columns_begin) * kChannels + channel) *
+                        kFineWords];
+  };
+  auto coarse_of = [&](int x, int channel) {
+    return &column_coarse[((x - columns_begin) * kChannels + channel) *
+                          kCoarseWords];
+  };
+  auto count_row = [&](int y, bool add) {
+    const ColorData* row = source.row(y);
+    for (int x = columns_begin; x < columns_end; x++) {
+      int bins[kChannels] = {BinOf(row[x].red()), BinOf(row[x].green()),
+                             BinOf(row[x].blue())};
+      for (int channel = 0; channel < kChannels; channel++) {
+        int bin = bins[channel];
+        int coarse_bin = bin / kBinsPerCoarse;
+        Lanes* fine = &fine_of(x, channel)[bin / kLanes];
+        Lanes* coarse = &coarse_of(x, channel)[coarse_bin / kLanes];
+        if (add) {
+          *fine += OneAt(bin);
+          *coarse += OneAt(coarse_bin);
+        } else {
+          *fine -= OneAt(bin);
+          *coarse -= OneAt(coarse_bin);
+        }
+      }
+    }
+  };
+
+  // The window's histograms
+  Lanes coarse[kChannels][kCoarseWords];
+  Lanes fine[kChannels][kCoarseBins][kWordsPerCoarse];
+  int fine_x[kChannels][kCoarseBins];
+
+  // Bring one coarse bin's fine counts up to the window centered on x
+  auto refresh = [&](int channel, int coarse_bin, int x) {
+    Lanes* words = fine[channel][coarse_bin];
+    int& updated_x = fine_x[channel][coarse_bin];
+    int offset = coarse_bin * kWordsPerCoarse;
+    if (x - updated_x > 2 * radius) {
+      std::fill(words, words + kWordsPerCoarse, 0);
+      int window_end = std::min(width, x + radius + 1);
+      for (int column = std::max(0, x - radius); column < window_end;
+           column++) {
+        AddWords(words, fine_of(column, channel) + offset, kWordsPerCoarse);
+      }
+    } else {
+      for (int step = updated_x + 1; step <= x; step++) {
+        if (step + radius < width) {
+          AddWords(words, fine_of(step + radius, channel) + offset,
+                   kWordsPerCoarse);
+        }
+        if (step - radius - 1 >= 0) {
+          SubtractWords(words, fine_of(step - radius - 1, channel) + offset,
+                        kWordsPerCoarse);
+        }
+      }
+    }
+    updated_x = x;
+  };
+
+  // The column histograms start out as the window of the row above
+  for (int y = std::max(0, y_begin - radius - 1);
+       y < std::min(height, y_begin + radius); y++) {
+    count_row(y, true);
+  }
+
+  for (int y = y_begin; y < y_end; y++) {
+    if (y + radius < height) {
+      count_row(y + radius, true);
+    }
+    if (y - radius - 1 >= 0) {
+      count_row(y - radius - 1, false);
+    }
+    int rows = std::min(height - 1, y + radius) - std::max(0, y - radius) + 1;
+
+    for (int channel = 0; channel < kChannels; channel++) {
+      std::fill(coarse[channel], coarse[channel] + kCoarseWords, 0);
+      std::fill(fine_x[channel], fine_x[channel] + kCoarseBins, kStale);
+      int window_end = std::min(width, x_begin + radius + 1);
+      for (int column = std::max(0, x_begin - radius); column < window_end;
+           column++) {
+        AddWords(coarse[channel], coarse_of(column, channel), kCoarseWords);
+      }
+    }
+
+    const ColorData* from = source.row(y);
+    ColorData* to = target->row(y);
+    for (int x = x_begin; x < x_end; x++) {
+      if (x > x_begin) {
+        for (int channel = 0; channel < kChannels; channel++) {
+          if (x + radius < width) {
+            AddWords(coarse[channel], coarse_of(x + radius, channel),
+                     kCoarseWords);
+          }
+          if (x - radius - 1 >= 0) {
+            SubtractWords(coarse[channel], coarse_of(x - radius - 1, channel),
+                          kCoarseWords);
+          }
+        }
+      }
+
+      int window_columns = std::min(width - 1, x + radius) -
+                           std::max(0, x - radius) + 1;
+      int rank = static_cast<int>(percentile_ * (rows * window_columns - 1) +
+                                  0.5f);
+      float value[kChannels];
+      for (int channel = 0; channel < kChannels; channel++) {
+        int below = 0;
+        int coarse_bin = 0;
+        while (below + CountOf(coarse[channel], coarse_bin) <= rank) {
+          below += CountOf(coarse[channel], coarse_bin);
+          coarse_bin++;
+        }
+        refresh(channel, coarse_bin, x);
+        const Lanes* words = fine[channel][coarse_bin];
+        int bin = 0;
+        while (below + CountOf(words, bin) <= rank) {
+          below += CountOf(words, bin);
+          bin++;
+        }
+        value[channel] = (coarse_bin * kBinsPerCoarse + bin) /
+                         static_cast<float>(kFineBins - 1);
+      }
+      to[x] = ColorData(value[0], value[1], value[2], from[x].alpha());
+    }
+  }
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * Name            : recursive_gaussian.cc
+ * Project         : FlashPhoto
+ * Module          : recursive_gaussian
+ * Description     : Implementation of the RecursiveGaussian class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/recursive_gaussian.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+const float RecursiveGaussian::kMinSigma = 0.5f;
+const int RecursiveGaussian::kStripColumns;
+const int RecursiveGaussian::kHaloSigmas;
+
+/** Doubles per pixel: red, green, blue and alpha */
+const int kChannels = 4;
+
+/**
+ * Poles of the filter for sigma = 2, d0 and d1 +/- i d2, as reciprocals of
+ * the z-plane poles (van Vliet, Young and Verbeek's minimum L-infinity fit)
+ */
+const double kD0 = 1.86543;
+const double kD1 = 1.41650;
+const double kD2 = 1.00829;
+
+/** Bisection steps finding the scale of the poles, in log space */
+const int kScaleSearchSteps = 64;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/**
+ * @brief The variance of the forward-backward filter with its poles scaled to
+ * d^(1/q): each pole adds d / (d - 1)^2 to the variance of each pass
+ */
+static double FilterVariance(double q) {
+  const std::complex<double> poles[3] = {
+    std::complex<double>(kD0, 0.0), std::complex<double>(kD1, kD2),
+    std::complex<double>(kD1, -kD2)
+  };
+  double variance = 0.0;
+  for (const std::complex<double>& pole : poles) {
+    std::complex<double> d = std::pow(pole, 1.0 / q);
+    variance += 2.0 * (d / ((d - 1.0) * (d - 1.0))).real();
+  }
+  return variance;
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+RecursiveGaussian::RecursiveGaussian(float sigma) : sigma_(sigma), b_(1.0),
+                                                    a_(), m_() {
+  if (identity()) {
+    return;
+  }
+
+  /*
+   * Scale the poles so the impulse response has exactly variance sigma^2.
+   * The variance grows with q, so bisect for it; Young and van Vliet's
+   * linear fit of q instead blurred 6-24% wider than sigma.
+   */
+  double q_low = 0.01;
+  double q_high = 10.0 * sigma + 1.0;
+  for (int step = 0; step < kScaleSearchSteps; step++) {
+    double q_mid = std::sqrt(q_low * q_high);
+    if (FilterVariance(q_mid) < static_cast<double>(sigma) * sigma) {
+      q_low = q_mid;
+    } else {
+      q_high = q_mid;
+    }
+  }
+  double q = std::sqrt(q_low * q_high);
+
+  // Expand (1 - p0 / z)(1 - 2 r cos(theta) / z + r^2 / z^2), the z-plane
+  // poles being p0 = d0^(-1/q) and r e^(+/- i theta) = (d1 +/- i d2)^(-1/q)
+  double p0 = std::pow(kD0, -1.0 / q);
+  double r = std::pow(std::hypot(kD1, kD2), -1.0 / q);
+  double theta = std::atan2(kD2, kD1) / q;
+  a_[0] = p0 + 2.0 * r * std::cos(theta);
+  a_[1] = -(2.0 * p0 * r * std::cos(theta) + r * r);
+  a_[2] = p0 * r * r;
+  b_ = 1.0 - a_[0] - a_[1] - a_[2];
+
+  // Maps the forward pass's last three outputs, less the edge color, to the
+  // backward pass's last three as if the edge went on forever (Triggs and
+  // Sdika, with the backward pass's gain)
+  double a1 = a_[0];
+  double a2 = a_[1];
+  double a3 = a_[2];
+  double scale = 1.0 / ((1.0 + a1 - a2 + a3) * (1.0 + a2 + (a1 - a3) * a3));
+  m_[0][0] = scale * (1.0 - a3 * a1 - a3 * a3 - a2);
+  m_[0][1] = scale * (a3 + a1) * (a2 + a3 * a1);
+  m_[0][2] = scale * a3 * (a1 + a3 * a2);
+  m_[1][0] = scale * (a1 + a3 * a2);
+  m_[1][1] = scale * (1.0 - a2) * (a2 + a3 * a1);
+  m_[1][2] = scale * a3 * (1.0 - a3 * a1 - a3 * a3 - a2);
+  m_[2][0] = scale * (a3 * a1 + a2 + a1 * a1 - a2 * a2);
+  m_[2][1] = scale * (a1 * a2 + a3 * a2 * a2 - a1 * a3 * a3 -
+                      a3 * a3 * a3 - a3 * a2 + a3);
+  m_[2][2] = scale * a3 * (a1 + a3 * a2);
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int RecursiveGaussian::halo(float sigma) {
+  if (sigma < kMinSigma) {
+    return 0;
+  }
+  return static_cast<int>(std::ceil(kHaloSigmas * sigma));
+}
+
+void RecursiveGaussian::FilterLine(double* data, int length,
+                                   int channels) const {
+  double* first = data + 3 * channels;
+  double* last = first + (length - 1) * channels;
+  double* after = last + channels;
+
+  // Before the line, the forward pass has settled on the first color; the
+  // last color is kept past the end for the backward pass.
+  for (int i = 0; i < 3; i++) {
+    std::copy(first, first + channels, data + i * channels);
+  }
+  std::copy(last, last + channels, after + 2 * channels);
+
+  for (double* sample = first; sample <= last; sample += channels) {
+    for (int c = 0; c < channels; c++) {
+      sample[c] = b_ * sample[c] + a_[0] * sample[c - channels] +
+                  a_[1] * sample[c - 2 * channels] +
+                  a_[2] * sample[c - 3 * channels];
+    }
+  }
+
+  for (int c = 0; c < channels; c++) {
+    double edge = after[2 * channels + c];
+    double u0 = last[c] - edge;
+    double u1 = last[c - channels] - edge;
+    double u2 = last[c - 2 * channels] - edge;
+    last[c] = m_[0][0] * u0 + m_[0][1] * u1 + m_[0][2] * u2 + edge;
+    after[c] = m_[1][0] * u0 + m_[1][1] * u1 + m_[1][2] * u2 + edge;
+    after[channels + c] = m_[2][0] * u0 + m_[2][1] * u1 + m_[2][2] * u2 +
+                          edge;
+  }
+
+  for (double* sample = last - channels; sample >= first;
+       sample -= channels) {
+    for (int c = 0; c < channels; c++) {
+      sample[c] = b_ * sample[c] + a_[0] * sample[c + channels] +
+                  a_[1] * sample[c + 2 * channels] +
+                  a_[2] * sample[c + 3 * channels];
+    }
+  }
+}
+
+void RecursiveGaussian::FilterRows(PixelBuffer* image, int y_begin,
+                                   int y_end) const {
+  if (identity()) {
+    return;
+  }
+  int width = image->width();
+  std::vector<double> line((width + 6) * kChannels);
+
+  for (int y = y_begin; y < y_end; y++) {
+    ColorData* row = image->row(y);
+    double* sample = &line[3 * kChannels];
+    for (int x = 0; x < width; x++, sample += kChannels) {
+      sample[0] = row[x].red();
+      sample[1] = row[x].green();
+      sample[2] = row[x].blue();
+      sample[3] = row[x].alpha();
+    }
+
+    FilterLine(line.data(), width, kChannels);
+
+    sample = &line[3 * kChannels];
+    for (int x = 0; x < width; x++, sample += kChannels) {
+      row[x] = ColorData(sample[0], sample[1], sample[2], sample[3]);
+    }
+  }
+}
+
+void RecursiveGaussian::FilterStrip(const PixelBuffer& image, int x,
+                                    int columns, double* strip) const {
+  int height = image.height();
+  int channels = columns * kChannels;
+  for (int y = 0; y < height; y++) {
+    const ColorData* from = image.row(y) + x;
+    double* sample = &strip[(y + 3) * channels];
+    for (int i = 0; i < columns; i++, sample += kChannels) {
+      sample[0] = from[i].red();
+      sample[1] = from[i].green();
+      sample[2] = from[i].blue();
+      sample[3] = from[i].alpha();
+    }
+  }
+
+  FilterLine(strip, height, channels);
+}
+
+void RecursiveGaussian::FilterColumns(PixelBuffer* image, int x_begin,
+                                      int x_end) const {
+  if (identity()) {
+    return;
+  }
+  int height = image->height();
+  std::vector<double> strip((height + 6) * kChannels * kStripColumns);
+
+  for (int x = x_begin; x < x_end; x += kStripColumns) {
+    int columns = std::min(kStripColumns, x_end - x);
+    int channels = columns * kChannels;
+    FilterStrip(*image, x, columns, strip.data());
+
+    for (int y = 0; y < height; y++) {
+      ColorData* to = image->row(y) + x;
+      const double* sample = &strip[(y + 3) * channels];
+      for (int i = 0; i < columns; i++, sample += kChannels) {
+        to[i] = ColorData(sample[0], sample[1], sample[2],
+                          sample[3]).clamped_color();
+      }
+    }
+  }
+}
+
+void RecursiveGaussian::SharpenColumns(const PixelBuffer& blurred,
+                                       PixelBuffer* image, int x_begin,
+                                       int x_end, float amount,
+                                       float threshold) const {
+  if (identity()) {
+    return;
+  }
+  int height = image->height();
+  std::vector<double> strip((height + 6) * kChannels * kStripColumns);
+
+  for (int x = x_begin; x < x_end; x += kStripColumns) {
+    int columns = std::min(kStripColumns, x_end - x);
+    int channels = columns * kChannels;
+    FilterStrip(blurred, x, columns, strip.data());
+
+    for (int y = 0; y < height; y++) {
+      ColorData* to = image->row(y) + x;
+      const double* sample = &strip[(y + 3) * channels];
+      for (int i = 0; i < columns; i++, sample += kChannels) {
+        float color[3] = {to[i].red(), to[i].green(), to[i].blue()};
+        for (int channel = 0; channel < 3; channel++) {
+          // The blur is clamped, as FilterColumns() would leave it
+          float blur = std::min(1.f, std::max(0.f, static_cast<float>(
+            sample[channel])));
+          float detail = color[channel] - blur;
+          if (std::fabs(detail) >= threshold) {
+            color[channel] = std::min(1.f, std::max(0.f, color[channel] +
+                                                    amount * detail));
+          }
+        }
+        to[i] = ColorData(color[0], color[1], color[2], to[i].alpha());
+      }
+    }
+  }
+}
+
+}  /* namespace image_tools */
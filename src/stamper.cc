@@ -19,16 +19,29 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include "include/memory_accounting.h"
+#include "include/trace.h"
 
 /*******************************************************************************
  * Namespaces
  ******************************************************************************/
 namespace image_tools {
 
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static void DeleteStampMask(ColorData** mask, int mask_size) {
+  for (int y = 0; y < mask_size; y++) {
+    delete [] mask[y];
+  }
+  delete [] mask;
+}
+
 /*******************************************************************************
  * Member Functions
  ******************************************************************************/
 void Stamper::ApplyClick(int mouse_x, int mouse_y) {
+  TRACE_SCOPE("Stamper::ApplyClick", "tool");
   if (!stamp_mask_) {
     std::cout << "Stamp image has not been set." << std::endl;
     return;
@@ -113,6 +126,8 @@ void Stamper::set_buffer_stamp_mask(PixelBuffer *pixel_buffer) {
 
   stamp_mask_ = new_mask;
   mask_size_ = mask_size;
+  MemoryAccounting::RecordAllocation(
+    MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(ColorData));
 }
 
 void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
@@ -257,6 +272,8 @@ void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
 
     stamp_mask_ = new_stamp_mask;
     mask_size_ = new_mask_size;
+    MemoryAccounting::RecordAllocation(
+      MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(ColorData));
     return;
   }
 
@@ -268,6 +285,7 @@ void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
     std::cerr << "**StamperError: Base image PPM file does not have a"
       " maximum color value of " << base_colormax << std::endl;
     base_file.close();  // Close the base image file.
+    DeleteStampMask(new_stamp_mask, new_mask_size);
     return;
   } else {
     /*
@@ -281,6 +299,7 @@ void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
     std::cerr << "**StamperError: Base image PPM file does not contain"
       " valid image specifications." << std::endl;
     base_file.close();  // Close the base image file.
+    DeleteStampMask(new_stamp_mask, new_mask_size);
     return;
   }
 
@@ -320,7 +339,9 @@ void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
     base_file.close();  // Close the base image file.
   } else {
     std::cerr << "**StamperError: Could not open base image file " <<
-              base_fname << std::endl; return;
+              base_fname << std::endl;
+    DeleteStampMask(new_stamp_mask, new_mask_size);
+    return;
   }
 
 
@@ -381,17 +402,16 @@ void Stamper::set_ppm_stamp_mask(int width, int height, double alpha,
 
   stamp_mask_ = new_stamp_mask;
   mask_size_ = new_mask_size;
+  MemoryAccounting::RecordAllocation(
+    MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(ColorData));
 }
 
 void Stamper::clear_stamp_mask(void) {
   if (stamp_mask_) {
-    for (int y = 0; y < mask_size_; y++) {
-      if (stamp_mask_[y]) {
-        delete stamp_mask_[y];
-      }
-    }
-
-    delete stamp_mask_;
+    DeleteStampMask(stamp_mask_, mask_size_);
+    stamp_mask_ = nullptr;
+    MemoryAccounting::RecordFree(
+      MEMORY_TOOL_MASK, mask_size_ * mask_size_ * sizeof(ColorData));
   }
 }
 
@@ -15,8 +15,6 @@
 #include "include/state_manager.h"
 #include <iostream>
 #include "include/ui_ctrl.h"
-#include "include/filter_manager.h"
-#include "include/io_manager.h"
 
 /*******************************************************************************
  * Namespaces
@@ -28,7 +26,8 @@ namespace image_tools {
  ******************************************************************************/
 StateManager::StateManager(void) :
     undo_btn_(nullptr),
-    redo_btn_(nullptr) {}
+    redo_btn_(nullptr),
+    history_() {}
 
 /*******************************************************************************
  * Member Functions
@@ -46,53 +45,30 @@ void StateManager::InitGlui(const GLUI *const glui,
 
 ColorData* StateManager::UndoOperation(void) {
   std::cout << "Undoing..." << std::endl;
-  redo_stack_.push(undo_stack_.top());
-  undo_stack_.pop();
-
+  ColorData* pixels = history_.Undo();
   ToggleStateButtons();
-
-  return undo_stack_.top();
+  return pixels;
 }
 
 ColorData* StateManager::RedoOperation(void) {
   std::cout << "Redoing..." << std::endl;
-
-  undo_stack_.push(redo_stack_.top());
-  redo_stack_.pop();
-
+  ColorData* pixels = history_.Redo();
   ToggleStateButtons();
-
-  return undo_stack_.top();
+  return pixels;
 }
 
 void StateManager::RegisterNewCanvasState(ColorData* pixels) {
-  undo_stack_.push(pixels);
-  ClearRedoStack();
+  history_.RegisterNewState(pixels);
   ToggleStateButtons();
 }
 
 void StateManager::ClearUndoAndRedoStacks(void) {
-  ClearRedoStack();
-  ClearUndoStack();
-}
-
-void StateManager::ClearRedoStack(void) {
-  while (!redo_stack_.empty()) {
-    delete redo_stack_.top();
-    redo_stack_.pop();
-  }
-}
-
-void StateManager::ClearUndoStack(void) {
-  while (!undo_stack_.empty()) {
-    delete undo_stack_.top();
-    undo_stack_.pop();
-  }
+  history_.Clear();
 }
 
 void StateManager::ToggleStateButtons(void) {
-  redo_toggle(redo_stack_.size() > 0);
-  undo_toggle(undo_stack_.size() > 1);
+  redo_toggle(history_.can_redo());
+  undo_toggle(history_.can_undo());
 }
 
 }  /* namespace image_tools */
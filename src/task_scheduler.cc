@@ -0,0 +1,466 @@
+/*******************************************************************************
+ * Name            : task_scheduler.cc
+ * Project         : FlashPhoto
+ * Module          : task_scheduler
+ * Description     : Implementation of the TaskScheduler and TaskGroup classes
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/task_scheduler.h"
+#include <algorithm>
+#include <chrono>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** Fewest workers the default scheduler starts */
+const int kMinDefaultWorkers = 2;
+
+/** Chunks per thread when ParallelFor() picks the grain */
+const int kChunksPerThread = 4;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static std::atomic<TaskScheduler*> s_installed_scheduler(nullptr);
+
+/* The scheduler whose worker the calling thread is, and which one */
+static thread_local const TaskScheduler* s_current_scheduler = nullptr;
+static thread_local int s_current_worker = -1;
+static thread_local TaskPriority s_current_priority =
+  TASK_PRIORITY_INTERACTIVE;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static int64_t NowNanoseconds(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief The shared state of one ParallelFor(); helpers that start after
+ * every chunk was claimed only touch this, never the caller's body.
+ */
+struct ParallelLoop {
+  ParallelLoop(int loop_chunks) : chunks(loop_chunks), next_chunk(0),
+                                  chunks_done(0), mutex(), finished() {}
+  const int chunks;
+  std::atomic<int> next_chunk;
+  int chunks_done; /**< Guarded by mutex */
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+/**
+ * @brief Claim and run chunks until none are left
+ */
+static void RunChunks(ParallelLoop* loop, int begin, int end, int grain,
+                      const std::function<void(int, int)>& body) {
+  int done = 0;
+  for (int chunk = loop->next_chunk++; chunk < loop->chunks;
+       chunk = loop->next_chunk++) {
+    int chunk_begin = begin + chunk * grain;
+    body(chunk_begin, std::min(end, chunk_begin + grain));
+    done++;
+  }
+  if (done > 0) {
+    std::lock_guard<std::mutex> lock(loop->mutex);
+    loop->chunks_done += done;
+    if (loop->chunks_done == loop->chunks) {
+      loop->finished.notify_all();
+    }
+  }
+}
+
+/**
+ * @brief The shared state of one ParallelForBands(): which bands have been
+ * claimed, by their own thread or by the caller
+ */
+struct BandLoop {
+  explicit BandLoop(int loop_bands) : bands(loop_bands),
+                                      claimed(new std::atomic<bool>[
+                                        loop_bands]),
+                                      bands_done(0), mutex(), finished() {
+    for (int band = 0; band < bands; band++) {
+      claimed[band].store(false);
+    }
+  }
+  const int bands;
+  std::unique_ptr<std::atomic<bool>[]> claimed;
+  int bands_done; /**< Guarded by mutex */
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+/**
+ * @brief Run one band unless another thread already has
+ */
+static void RunBand(BandLoop* loop, int band, int begin, int end,
+                    const std::function<void(int, int)>& body) {
+  if (loop->claimed[band].exchange(true)) {
+    return;
+  }
+  int64_t length = end - begin;
+  body(begin + static_cast<int>(length * band / loop->bands),
+       begin + static_cast<int>(length * (band + 1) / loop->bands));
+  std::lock_guard<std::mutex> lock(loop->mutex);
+  if (++loop->bands_done == loop->bands) {
+    loop->finished.notify_all();
+  }
+}
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+TaskGroup::TaskGroup(void) : scheduler_(nullptr), pending_(0), mutex_(),
+                             finished_() {}
+
+TaskGroup::~TaskGroup(void) {
+  Wait();
+}
+
+TaskScheduler::TaskScheduler(int worker_count) : workers_(), queued_(0),
+                                                 next_worker_(0),
+                                                 sleep_mutex_(), wake_(),
+                                                 stopping_(false),
+                                                 stats_start_ns_(
+                                                   NowNanoseconds()) {
+  for (int i = 0; i < std::max(1, worker_count); i++) {
+    workers_.push_back(std::unique_ptr<Worker>(new Worker()));
+  }
+  for (int i = 0; i < this->worker_count(); i++) {
+    workers_[i]->thread = std::thread(&TaskScheduler::WorkerLoop, this, i);
+  }
+}
+
+TaskScheduler::~TaskScheduler(void) {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread.join();
+  }
+  TaskScheduler* self = this;
+  s_installed_scheduler.compare_exchange_strong(self, nullptr);
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void TaskGroup::Run(std::function<void(void)> function,
+                    TaskPriority priority) {
+  TaskScheduler* scheduler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_ == 0) {
+      scheduler_ = &TaskScheduler::Instance();
+    }
+    pending_++;
+    scheduler = scheduler_;
+  }
+  scheduler->Submit(function, priority, this);
+}
+
+void TaskGroup::Wait(void) {
+  TaskScheduler* scheduler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_ == 0) {
+      return;
+    }
+    scheduler = scheduler_;
+  }
+
+  // Run whatever no worker has started, then wait for the rest.
+  TaskScheduler::Task task;
+  while (scheduler->TakeGroupTask(this, &task)) {
+    TaskScheduler::Execute(&task);
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  finished_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+bool TaskGroup::idle(void) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_ == 0;
+}
+
+void TaskGroup::Finish(void) {
+  // Notified under the lock so the group is never touched after Wait()
+  // has seen the last task finish.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--pending_ == 0) {
+    finished_.notify_all();
+  }
+}
+
+TaskScheduler& TaskScheduler::Instance(void) {
+  TaskScheduler* installed = s_installed_scheduler.load();
+  if (installed) {
+    return *installed;
+  }
+  static TaskScheduler default_scheduler;
+  return default_scheduler;
+}
+
+void TaskScheduler::set_instance(TaskScheduler* scheduler) {
+  s_installed_scheduler.store(scheduler);
+}
+
+int TaskScheduler::DefaultWorkerCount(void) {
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(kMinDefaultWorkers, cores - 1);
+}
+
+TaskPriority TaskScheduler::current_priority(void) {
+  return s_current_priority;
+}
+
+void TaskScheduler::Submit(std::function<void(void)> function,
+                           TaskPriority priority, TaskGroup* group) {
+  int index = (s_current_scheduler == this) ? s_current_worker :
+              static_cast<int>(next_worker_++ % workers_.size());
+  {
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    workers_[index]->lanes[priority].push_back(
+      Task(function, priority, group));
+  }
+  queued_++;
+  {
+    // Taken so a worker between checking queued_ and sleeping is not missed
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_.notify_one();
+}
+
+void TaskScheduler::SubmitPinned(int worker, std::function<void(void)> function,
+                                 TaskPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(workers_[worker]->mutex);
+    workers_[worker]->pinned.push_back(Task(function, priority, nullptr));
+    workers_[worker]->pinned_count++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  // Only that worker can take it, so wake them all to be sure it wakes
+  wake_.notify_all();
+}
+
+void TaskScheduler::ParallelFor(int begin, int end, int grain,
+                                const std::function<void(int, int)>& body) {
+  if (end <= begin) {
+    return;
+  }
+  if (grain <= 0) {
+    grain = std::max(1, (end - begin + concurrency() * kChunksPerThread - 1) /
+                        (concurrency() * kChunksPerThread));
+  }
+  int chunks = (end - begin + grain - 1) / grain;
+  int helpers = std::min(worker_count(), chunks - 1);
+  if (helpers <= 0) {
+    body(begin, end);
+    return;
+  }
+
+  std::shared_ptr<ParallelLoop> loop = std::make_shared<ParallelLoop>(chunks);
+  const std::function<void(int, int)>* body_pointer = &body;
+  for (int i = 0; i < helpers; i++) {
+    Submit([loop, begin, end, grain, body_pointer]() {
+      RunChunks(loop.get(), begin, end, grain, *body_pointer);
+    }, current_priority(), nullptr);
+  }
+
+  RunChunks(loop.get(), begin, end, grain, body);
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished.wait(lock, [&loop]() {
+    return loop->chunks_done == loop->chunks;
+  });
+}
+
+void TaskScheduler::ParallelForBands(
+    int begin, int end, const std::function<void(int, int)>& body) {
+  int bands = std::min(concurrency(), end - begin);
+  if (bands <= 1) {
+    if (end > begin) {
+      body(begin, end);
+    }
+    return;
+  }
+
+  std::shared_ptr<BandLoop> loop = std::make_shared<BandLoop>(bands);
+  const std::function<void(int, int)>* body_pointer = &body;
+  for (int band = 1; band < bands; band++) {
+    SubmitPinned(band - 1, [loop, band, begin, end, body_pointer]() {
+      RunBand(loop.get(), band, begin, end, *body_pointer);
+    }, current_priority());
+  }
+
+  // The caller's own band, then any whose worker has not got to it
+  for (int band = 0; band < bands; band++) {
+    RunBand(loop.get(), band, begin, end, body);
+  }
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished.wait(lock, [&loop]() {
+    return loop->bands_done == loop->bands;
+  });
+}
+
+void TaskScheduler::ParallelForTiles(
+    int width, int height, int tile_size,
+    const std::function<void(int, int, int, int)>& body) {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  int tiles_x = (width + tile_size - 1) / tile_size;
+  int tiles_y = (height + tile_size - 1) / tile_size;
+  ParallelFor(0, tiles_x * tiles_y, 1, [&](int tile_begin, int tile_end) {
+    for (int tile = tile_begin; tile < tile_end; tile++) {
+      int x = (tile % tiles_x) * tile_size;
+      int y = (tile / tiles_x) * tile_size;
+      body(x, y, std::min(width, x + tile_size),
+           std::min(height, y + tile_size));
+    }
+  });
+}
+
+WorkerStats TaskScheduler::worker_stats(int worker) const {
+  const Worker& source = *workers_[worker];
+  WorkerStats stats;
+  stats.tasks_run = source.tasks_run.load();
+  stats.tasks_stolen = source.tasks_stolen.load();
+  stats.busy_ms = source.busy_ns.load() * 1e-6;
+  double elapsed_ms = (NowNanoseconds() - stats_start_ns_.load()) * 1e-6;
+  if (elapsed_ms > 0.0) {
+    stats.utilization = std::min(1.0, stats.busy_ms / elapsed_ms);
+  }
+  return stats;
+}
+
+void TaskScheduler::ResetStats(void) {
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->tasks_run.store(0);
+    worker->tasks_stolen.store(0);
+    worker->busy_ns.store(0);
+  }
+  stats_start_ns_.store(NowNanoseconds());
+}
+
+void TaskScheduler::WorkerLoop(int index) {
+  s_current_scheduler = this;
+  s_current_worker = index;
+  Worker& worker = *workers_[index];
+
+  while (true) {
+    Task task;
+    bool stolen = false;
+    if (TakeTask(index, &task, &stolen)) {
+      int64_t start = NowNanoseconds();
+      Execute(&task);
+      worker.busy_ns += NowNanoseconds() - start;
+      worker.tasks_run++;
+      if (stolen) {
+        worker.tasks_stolen++;
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    // Pinned tasks are not counted in queued_; each worker drains its own
+    if (stopping_ && queued_.load() == 0 && worker.pinned_count.load() == 0) {
+      break;
+    }
+    wake_.wait(lock, [this, &worker]() {
+      return stopping_ || queued_.load() > 0 || worker.pinned_count.load() > 0;
+    });
+  }
+}
+
+bool TaskScheduler::TakeTask(int index, Task* task, bool* stolen) {
+  int count = worker_count();
+  if (index >= 0) {
+    Worker& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.pinned.empty()) {
+      *task = own.pinned.front();
+      own.pinned.pop_front();
+      own.pinned_count--;
+      *stolen = false;
+      return true;
+    }
+  }
+  for (int lane = 0; lane < TASK_PRIORITY_COUNT; lane++) {
+    // The newest task of its own, whose data is likeliest to be in cache
+    if (index >= 0) {
+      Worker& own = *workers_[index];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.lanes[lane].empty()) {
+        *task = own.lanes[lane].back();
+        own.lanes[lane].pop_back();
+        queued_--;
+        *stolen = false;
+        return true;
+      }
+    }
+    // Else the oldest task of another, the likeliest to have been split
+    for (int offset = 1; offset <= count; offset++) {
+      int victim = (std::max(index, 0) + offset) % count;
+      if (victim == index) {
+        continue;
+      }
+      Worker& other = *workers_[victim];
+      std::lock_guard<std::mutex> lock(other.mutex);
+      if (!other.lanes[lane].empty()) {
+        *task = other.lanes[lane].front();
+        other.lanes[lane].pop_front();
+        queued_--;
+        *stolen = true;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool TaskScheduler::TakeGroupTask(const TaskGroup* group, Task* task) {
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    for (std::deque<Task>& lane : worker->lanes) {
+      for (auto it = lane.begin(); it != lane.end(); ++it) {
+        if (it->group == group) {
+          *task = *it;
+          lane.erase(it);
+          queued_--;
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::Execute(Task* task) {
+  TaskPriority outer_priority = s_current_priority;
+  s_current_priority = task->priority;
+  task->function();
+  s_current_priority = outer_priority;
+  if (task->group) {
+    task->group->Finish();
+  }
+}
+
+}  /* namespace image_tools */
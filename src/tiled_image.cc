@@ -0,0 +1,232 @@
+/*******************************************************************************
+ * Name            : tiled_image.cc
+ * Project         : FlashPhoto
+ * Module          : tiled_image
+ * Description     : Implementation of the TiledImage class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/tiled_image.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "include/trace.h"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+static const int64_t kTilePixels =
+  static_cast<int64_t>(TiledImage::kTileSize) * TiledImage::kTileSize;
+
+/*******************************************************************************
+ * Constructors/Destructor
+ ******************************************************************************/
+TiledImage::TiledImage(int width, int height,
+                       const ColorData& background_color)
+    : width_(width),
+      height_(height),
+      tiles_x_((width + kTileSize - 1) / kTileSize),
+      tiles_y_((height + kTileSize - 1) / kTileSize),
+      background_color_(background_color),
+      directory_(),
+      fd_(-1),
+      bytes_(0),
+      pixels_(nullptr) {}
+
+TiledImage::~TiledImage(void) {
+  if (pixels_) {
+    munmap(pixels_, bytes_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+TiledImage* TiledImage::Create(int width, int height,
+                               const ColorData& background_color,
+                               bool fill, const std::string& directory) {
+  TRACE_SCOPE("TiledImage::Create", "pixels");
+  TiledImage* image = new TiledImage(width, height, background_color);
+
+  std::string dir = directory;
+  if (dir.empty()) {
+    const char* tmp_root = getenv("TMPDIR");
+    dir = tmp_root ? tmp_root : "/tmp";
+  }
+  image->directory_ = dir;
+  std::string path_template = dir + "/flashphoto_tiles.XXXXXX";
+  std::vector<char> path(path_template.begin(), path_template.end());
+  path.push_back('\0');
+
+  image->fd_ = mkstemp(path.data());
+  if (image->fd_ < 0) {
+    std::cerr << "ERROR: Could not create a tile file in " << dir
+              << std::endl;
+    delete image;
+    return nullptr;
+  }
+  // The file lives only as long as the mapping
+  unlink(path.data());
+
+  image->bytes_ = static_cast<size_t>(image->tiles_x_) * image->tiles_y_ *
+                  kTilePixels * sizeof(ColorData);
+  void* mapping = MAP_FAILED;
+  if (ftruncate(image->fd_, image->bytes_) == 0) {
+    mapping = mmap(nullptr, image->bytes_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   image->fd_, 0);
+  }
+  if (mapping == MAP_FAILED) {
+    std::cerr << "ERROR: Could not map a " << (image->bytes_ >> 20)
+              << " MB tile file in " << dir << std::endl;
+    delete image;
+    return nullptr;
+  }
+  image->pixels_ = static_cast<ColorData*>(mapping);
+
+  // Fill a row of tiles at a time so that only one is ever resident
+  for (int tile_y = 0; fill && tile_y < image->tiles_y_; tile_y++) {
+    ColorData* row_begin = image->tile(0, tile_y);
+    std::fill(row_begin, row_begin + kTilePixels * image->tiles_x_,
+              background_color);
+    image->ReleaseTileRows(tile_y, tile_y + 1);
+  }
+  return image;
+}
+
+int64_t TiledImage::PixelOffset(int x, int y) const {
+  int64_t tile_index = static_cast<int64_t>(y / kTileSize) * tiles_x_ +
+                       x / kTileSize;
+  return tile_index * kTilePixels + (y % kTileSize) * kTileSize +
+         x % kTileSize;
+}
+
+ColorData* TiledImage::tile(int tile_x, int tile_y) {
+  return pixels_ + (static_cast<int64_t>(tile_y) * tiles_x_ + tile_x) *
+                   kTilePixels;
+}
+
+const ColorData* TiledImage::tile(int tile_x, int tile_y) const {
+  return pixels_ + (static_cast<int64_t>(tile_y) * tiles_x_ + tile_x) *
+                   kTilePixels;
+}
+
+ColorData TiledImage::get_pixel(int x, int y) const {
+  return pixels_[PixelOffset(x, y)];
+}
+
+void TiledImage::set_pixel(int x, int y, const ColorData& color) {
+  pixels_[PixelOffset(x, y)] = color;
+}
+
+void TiledImage::ReadRow(int y, int x, int count, ColorData* pixels) const {
+  // Copy the run of the row within each tile it crosses
+  while (count > 0) {
+    int run = std::min(count, kTileSize - x % kTileSize);
+    const ColorData* source = pixels_ + PixelOffset(x, y);
+    std::copy(source, source + run, pixels);
+    pixels += run;
+    x += run;
+    count -= run;
+  }
+}
+
+void TiledImage::WriteRow(int y, int x, int count, const ColorData* pixels) {
+  while (count > 0) {
+    int run = std::min(count, kTileSize - x % kTileSize);
+    std::copy(pixels, pixels + run, pixels_ + PixelOffset(x, y));
+    pixels += run;
+    x += run;
+    count -= run;
+  }
+}
+
+void TiledImage::ReadRegion(int x, int y, PixelBuffer* region) const {
+  for (int row = 0; row < region->height(); row++) {
+    ReadRow(y + row, x, region->width(), region->row(row));
+  }
+}
+
+void TiledImage::WriteRegion(int x, int y, const PixelBuffer& region,
+                             int region_x, int region_y, int w, int h) {
+  for (int row = 0; row < h; row++) {
+    WriteRow(y + row, x, w, region.row(region_y + row) + region_x);
+  }
+}
+
+void TiledImage::ReleaseTileRows(int first_tile_y, int end_tile_y) {
+  first_tile_y = std::max(0, first_tile_y);
+  end_tile_y = std::min(tiles_y_, end_tile_y);
+  if (first_tile_y >= end_tile_y) {
+    return;
+  }
+  // Dirty pages of a shared mapping stay in the page cache to be written
+  // back; this only drops them from the process
+  madvise(tile(0, first_tile_y),
+          static_cast<size_t>(end_tile_y - first_tile_y) * tiles_x_ *
+          kTilePixels * sizeof(ColorData), MADV_DONTNEED);
+}
+
+PixelBuffer* TiledImage::Downsample(int max_width, int max_height) {
+  TRACE_SCOPE("TiledImage::Downsample", "pixels");
+  int factor = std::max(1, std::max((width_ + max_width - 1) / max_width,
+                                    (height_ + max_height - 1) / max_height));
+  int out_width = (width_ + factor - 1) / factor;
+  int out_height = (height_ + factor - 1) / factor;
+  PixelBuffer* out = new PixelBuffer(out_width, out_height, background_color_);
+
+  std::vector<ColorData> row(width_);
+  std::vector<ColorData> sums(out_width);
+  for (int out_y = 0; out_y < out_height; out_y++) {
+    int y_begin = out_y * factor;
+    int y_end = std::min(height_, y_begin + factor);
+    std::fill(sums.begin(), sums.end(), ColorData(0, 0, 0, 0));
+    for (int y = y_begin; y < y_end; y++) {
+      ReadRow(y, 0, width_, row.data());
+      for (int x = 0; x < width_; x++) {
+        sums[x / factor] = sums[x / factor] + row[x];
+      }
+    }
+    for (int out_x = 0; out_x < out_width; out_x++) {
+      int block_width = std::min(width_, (out_x + 1) * factor) -
+                        out_x * factor;
+      out->set_pixel(out_x, out_y,
+                     sums[out_x] * (1.0f / (block_width * (y_end - y_begin))));
+    }
+    ReleaseTileRows(0, y_end / kTileSize);
+  }
+  ReleaseTileRows(0, tiles_y_);
+  return out;
+}
+
+void TiledImage::Swap(TiledImage* other) {
+  std::swap(width_, other->width_);
+  std::swap(height_, other->height_);
+  std::swap(tiles_x_, other->tiles_x_);
+  std::swap(tiles_y_, other->tiles_y_);
+  std::swap(background_color_, other->background_color_);
+  std::swap(directory_, other->directory_);
+  std::swap(fd_, other->fd_);
+  std::swap(bytes_, other->bytes_);
+  std::swap(pixels_, other->pixels_);
+}
+
+}  /* namespace image_tools */
@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * Name            : trace.cc
+ * Project         : FlashPhoto
+ * Module          : trace
+ * Description     : Implementation of the Tracer class
+ * Copyright       : 2016 CSCI3081W Group C03. All rights reserved.
+ * Creation Date   : 10/18/26
+ * Original Author : Erik Husby, J. Jason Mitchell, William Meusing
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace image_tools {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/* Events held per thread; must be a power of two */
+static const uint64_t kTraceRingSize = 1 << 15;
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+struct TraceEvent {
+  const char* name;
+  const char* category;
+  const char* arg_name;
+  int64_t arg;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+/**
+ * @brief One thread's events. Only the owning thread writes; head_ is
+ * published with release ordering so that readers see complete events.
+ */
+struct TraceRing {
+  explicit TraceRing(int id) : thread_id(id), head(0), tail(0), events() {
+    events.resize(kTraceRingSize);
+  }
+  int thread_id;
+  std::atomic<uint64_t> head; /**< Number of events ever recorded */
+  std::atomic<uint64_t> tail; /**< Events before this were cleared */
+  std::vector<TraceEvent> events;
+};
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+std::atomic<bool> Tracer::enabled_(false);
+
+/* Every thread's ring, kept for the life of the process so that events from
+ * threads that have exited can still be written. */
+static std::mutex s_rings_mutex;
+static std::vector<TraceRing*> s_rings;
+
+static const std::chrono::steady_clock::time_point s_trace_epoch =
+  std::chrono::steady_clock::now();
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static TraceRing* RegisterThread(void) {
+  std::lock_guard<std::mutex> lock(s_rings_mutex);
+  TraceRing* ring = new TraceRing(static_cast<int>(s_rings.size()) + 1);
+  s_rings.push_back(ring);
+  return ring;
+}
+
+static TraceRing* ThreadRing(void) {
+  static thread_local TraceRing* ring = RegisterThread();
+  return ring;
+}
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+int64_t Tracer::NowNs(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - s_trace_epoch).count();
+}
+
+void Tracer::Record(const char* name, const char* category,
+                    const char* arg_name, int64_t arg,
+                    int64_t start_ns, int64_t end_ns) {
+  TraceRing* ring = ThreadRing();
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  TraceEvent& event = ring->events[head & (kTraceRingSize - 1)];
+  event.name = name;
+  event.category = category;
+  event.arg_name = arg_name;
+  event.arg = arg;
+  event.start_ns = start_ns;
+  event.end_ns = end_ns;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool Tracer::WriteChromeTrace(const std::string& file_name) {
+  FILE* file = fopen(file_name.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+          "\"args\": {\"name\": \"FlashPhoto\"}}");
+
+  std::vector<TraceRing*> rings;
+  {
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    rings = s_rings;
+  }
+  std::vector<TraceEvent> events;
+  for (TraceRing* ring : rings) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t first = ring->tail.load(std::memory_order_relaxed);
+    if (head - first > kTraceRingSize) {
+      first = head - kTraceRingSize;
+    }
+    events.clear();
+    for (uint64_t i = first; i < head; i++) {
+      events.push_back(ring->events[i & (kTraceRingSize - 1)]);
+    }
+    /*
+     * Drop any event the owner overwrote while it was being copied. The
+     * owner writes slot new_head before publishing new_head + 1, so the
+     * event kTraceRingSize before it may be half overwritten too.
+     */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t new_head = ring->head.load(std::memory_order_relaxed);
+    size_t skip = 0;
+    if (new_head + 1 - first > kTraceRingSize) {
+      skip = std::min<uint64_t>(events.size(),
+                                new_head + 1 - kTraceRingSize - first);
+    }
+
+    fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+            "\"tid\": %d, \"args\": {\"name\": \"thread %d\"}}",
+            ring->thread_id, ring->thread_id);
+    for (size_t i = skip; i < events.size(); i++) {
+      const TraceEvent& event = events[i];
+      fprintf(file, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+              "\"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+              event.name, event.category, ring->thread_id,
+              event.start_ns / 1000.0,
+              (event.end_ns - event.start_ns) / 1000.0);
+      if (event.arg_name) {
+        fprintf(file, ", \"args\": {\"%s\": %lld}", event.arg_name,
+                static_cast<long long>(event.arg));  // NOLINT(runtime/int)
+      }
+      fprintf(file, "}");
+    }
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
+
+void Tracer::Clear(void) {
+  std::lock_guard<std::mutex> lock(s_rings_mutex);
+  for (TraceRing* ring : s_rings) {
+    ring->tail.store(ring->head.load(std::memory_order_acquire),
+                     std::memory_order_relaxed);
+  }
+}
+
+}  /* namespace image_tools */